@@ -1,13 +1,13 @@
 #include "Book.h"
 
-Book::Book(const std::string& title, const std::string& author, const std::string& type)
-    : title(title), author(author), type(type), isBorrowed(false) {}
+Book::Book(const std::string& title, const std::string& author, const std::string& type, BookCategory category)
+    : title(title), author(author), type(type), category(category) {}
 
 Textbook::Textbook(const std::string& title, const std::string& author)
-    : Book(title, author, "教科书") {}
+    : Book(title, author, "教科书", BookCategory::Textbook) {}
 
 Novel::Novel(const std::string& title, const std::string& author)
-    : Book(title, author, "小说") {}
+    : Book(title, author, "小说", BookCategory::Novel) {}
 
 Magazine::Magazine(const std::string& title, const std::string& author)
-    : Book(title, author, "杂志") {}
\ No newline at end of file
+    : Book(title, author, "杂志", BookCategory::Magazine) {}
\ No newline at end of file
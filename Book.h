@@ -1,38 +1,54 @@
 #pragma once
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include "CopySet.h"
+#include "Symbol.h"
+#include "FinePolicy.h"
 
+// 目录中的一种图书（一个书名），名下可有多册副本，借还都落在具体副本上
 class Book {
 public:
-    Book(const std::string& title, const std::string& author, const std::string& type = "普通图书");
+    Book(const std::string& title, const std::string& author, const std::string& type = "普通图书",
+        BookCategory category = BookCategory::General);
     virtual ~Book() = default;
     
-    // Getter方法
-    std::string getTitle() const { return title; }
-    std::string getAuthor() const { return author; }
-    std::string getType() const { return type; }
-    bool isBorrowedStatus() const { return isBorrowed; }
+    // Getter方法（返回驻留字符串的视图，不复制）
+    std::string_view getTitle() const { return title.view(); }
+    std::string_view getAuthor() const { return author.view(); }
+    std::string_view getType() const { return type.view(); }
+    Symbol getTitleSymbol() const { return title; }
+    BookCategory getCategory() const { return category; }
+    uint32_t getCopyCount() const { return copies.size(); }
+    uint32_t getAvailableCopies() const { return copies.available(); }
+    // 所有副本都已借出
+    bool isBorrowedStatus() const { return copies.available() == 0; }
+    bool isCopyAvailable(uint32_t copy) const { return copies.isAvailable(copy); }
     
     // Setter方法
-    void setTitle(const std::string& newTitle) { title = newTitle; }
-    void setAuthor(const std::string& newAuthor) { author = newAuthor; }
+    void setTitle(const std::string& newTitle) { title = Symbol(newTitle); }
+    void setAuthor(const std::string& newAuthor) { author = Symbol(newAuthor); }
     
-    // 操作方法
-    void borrow() { isBorrowed = true; }
-    void returnBook() { isBorrowed = false; }
-    virtual double getFinePerDay() const { return 1.0; }
+    // 操作方法（副本编号从 0 开始）：借出编号最小的在架副本，全部借出时返回 CopySet::kNone
+    uint32_t borrowCopy() { return copies.checkoutAny(); }
+    bool borrowCopy(uint32_t copy) { return copies.checkout(copy); }
+    bool returnCopy(uint32_t copy) { return copies.checkin(copy); }
+    void addCopies(uint32_t count) { copies.grow(count); }
+    size_t copyHeapBytes() const { return copies.heapBytes(); }
+    double getFinePerDay() const { return FinePolicy::ratePerDay(category); }
 
 private:
-    std::string title;
-    std::string author;
-    std::string type;
-    bool isBorrowed;
+    Symbol title;
+    Symbol author;
+    Symbol type;
+    BookCategory category;
+    CopySet copies;
 };
 
 // 教科书类
 class Textbook : public Book {
 public:
     Textbook(const std::string& title, const std::string& author);
-    double getFinePerDay() const override { return 2.0; }
 };
 
 // 小说类
@@ -45,5 +61,4 @@ public:
 class Magazine : public Book {
 public:
     Magazine(const std::string& title, const std::string& author);
-    double getFinePerDay() const override { return 0.5; }
 };
\ No newline at end of file
@@ -1,46 +1,57 @@
 #include "BorrowRecord.h"
 
-BorrowRecord::BorrowRecord(Book* book, Reader* reader, std::time_t borrowDate, std::time_t dueDate)
-    : book(book), reader(reader), borrowDate(borrowDate), dueDate(dueDate), returnDate(0), isReturned(false) {}
+BorrowRecord::BorrowRecord(Book* book, Reader* reader, std::time_t borrowDate, std::time_t dueDate,
+    std::time_t returnDate, bool isReturned, uint32_t copy)
+    : book(book), reader(reader), borrowDate(borrowDate), dueDate(dueDate), returnDate(returnDate), isReturned(isReturned),
+      copy(copy) {}
 
-void BorrowRecord::setReturnDate(std::time_t returnDate) {
-    this->returnDate = returnDate;
-    isReturned = true;
+int BorrowRecord::getOverdueDays() const {
+    return getOverdueDays(isReturned ? returnDate : DateUtils::getCurrentTime());
 }
 
-int BorrowRecord::getOverdueDays() const {
-    if (!isReturned) {
-        std::time_t now = DateUtils::getCurrentTime();
-        return now > dueDate ? (now - dueDate) / (24 * 60 * 60) : 0;
-    }
-    return returnDate > dueDate ? (returnDate - dueDate) / (24 * 60 * 60) : 0;
+// now 仅对未归还的记录生效，已归还的记录按归还日期计算
+int BorrowRecord::getOverdueDays(std::time_t now) const {
+    std::time_t end = isReturned ? returnDate : now;
+    return end > dueDate ? (end - dueDate) / DateUtils::kSecondsPerDay : 0;
 }
 
 double BorrowRecord::calculateFine() const {
-    int overdueDays = getOverdueDays();
-    if (overdueDays <= 0) return 0.0;
-    return overdueDays * book->getFinePerDay() * reader->getFineDiscount();
+    return calculateFine(isReturned ? returnDate : DateUtils::getCurrentTime());
+}
+
+double BorrowRecord::calculateFine(std::time_t now) const {
+    return FinePolicy::fine(getOverdueDays(now), book->getCategory(), reader->getTier());
 }
 
 void BorrowRecord::display() const {
-    std::cout << "📖 书名: " << book->getTitle() << "\n";
+    display(DateUtils::getCurrentTime());
+}
+
+void BorrowRecord::display(std::time_t now) const {
+    char date[DateUtils::kTimeTextSize];
+    std::cout << "📖 书名: " << book->getTitle();
+    // 只有一册的图书不显示副本编号
+    if (book->getCopyCount() > 1) std::cout << "（第 " << copy + 1 << " 册）";
+    std::cout << "\n";
     std::cout << "👤 读者: " << reader->getName() << " (" << reader->getTypeName() << ")\n";
-    std::cout << "📅 借阅日期: " << DateUtils::formatTime(borrowDate) << "\n";
-    std::cout << "📅 应还日期: " << DateUtils::formatTime(dueDate) << "\n";
+    DateUtils::formatTime(borrowDate, date, sizeof(date));
+    std::cout << "📅 借阅日期: " << date << "\n";
+    DateUtils::formatTime(dueDate, date, sizeof(date));
+    std::cout << "📅 应还日期: " << date << "\n";
+    int overdueDays = getOverdueDays(now);
     if (isReturned) {
-        std::cout << "📅 归还日期: " << DateUtils::formatTime(returnDate) << "\n";
-        int overdueDays = getOverdueDays();
+        DateUtils::formatTime(returnDate, date, sizeof(date));
+        std::cout << "📅 归还日期: " << date << "\n";
         if (overdueDays > 0) {
             std::cout << "⏰ 超期天数: " << overdueDays << "天\n";
-            std::cout << "💰 逾期罚款: " << calculateFine() << "元\n";
+            std::cout << "💰 逾期罚款: " << calculateFine(now) << "元\n";
         }
     } else {
-        int overdueDays = getOverdueDays();
         if (overdueDays > 0) {
             std::cout << "⚠️ 已超期: " << overdueDays << "天\n";
-            std::cout << "💰 逾期罚款: " << calculateFine() << "元\n";
+            std::cout << "💰 逾期罚款: " << calculateFine(now) << "元\n";
         } else {
-            int daysLeft = (dueDate - DateUtils::getCurrentTime()) / (24 * 60 * 60);
+            int daysLeft = (dueDate - now) / DateUtils::kSecondsPerDay;
             std::cout << "⌛ 剩余天数: " << daysLeft << "天\n";
         }
     }
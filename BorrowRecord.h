@@ -1,25 +1,32 @@
 #pragma once
+#include <cstdint>
 #include <ctime>
 #include <iostream>
 #include "Book.h"
 #include "Reader.h"
 #include "DateUtils.h"
 
+// 单条借阅记录的只读视图，由 RecordStore 按列组装
 class BorrowRecord {
 public:
-    BorrowRecord(Book* book, Reader* reader, std::time_t borrowDate, std::time_t dueDate);
+    BorrowRecord(Book* book, Reader* reader, std::time_t borrowDate, std::time_t dueDate,
+        std::time_t returnDate = 0, bool isReturned = false, uint32_t copy = 0);
     
     Book* getBook() const { return book; }
+    uint32_t getCopy() const { return copy; }  // 副本编号，从 0 开始
     Reader* getReader() const { return reader; }
     std::time_t getBorrowDate() const { return borrowDate; }
     std::time_t getDueDate() const { return dueDate; }
     std::time_t getReturnDate() const { return returnDate; }
     bool getIsReturned() const { return isReturned; }
     
-    void setReturnDate(std::time_t returnDate);
     int getOverdueDays() const;
+    int getOverdueDays(std::time_t now) const;
     double calculateFine() const;
+    double calculateFine(std::time_t now) const;
+    // 未归还记录的超期 / 剩余天数按 now 计算，列表显示时由调用方取一次当前时间传入
     void display() const;
+    void display(std::time_t now) const;
 
 private:
     Book* book;
@@ -28,4 +35,5 @@ private:
     std::time_t dueDate;
     std::time_t returnDate;
     bool isReturned;
+    uint32_t copy;
 };
\ No newline at end of file
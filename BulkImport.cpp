@@ -0,0 +1,179 @@
+#include "BulkImport.h"
+#include "TextParsing.h"
+#include <algorithm>
+#include <future>
+#include <ostream>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace {
+    struct TypeName {
+        std::string_view name;
+        uint8_t kind;
+    };
+
+    constexpr TypeName kBookTypes[] = {
+        { "教科书", static_cast<uint8_t>(BookCategory::Textbook) }, { "Textbook", static_cast<uint8_t>(BookCategory::Textbook) },
+        { "小说", static_cast<uint8_t>(BookCategory::Novel) }, { "Novel", static_cast<uint8_t>(BookCategory::Novel) },
+        { "杂志", static_cast<uint8_t>(BookCategory::Magazine) }, { "Magazine", static_cast<uint8_t>(BookCategory::Magazine) },
+        { "普通图书", static_cast<uint8_t>(BookCategory::General) }, { "Book", static_cast<uint8_t>(BookCategory::General) },
+    };
+    constexpr TypeName kReaderTypes[] = {
+        { "RegularMember", static_cast<uint8_t>(MemberTier::Regular) }, { "普通会员", static_cast<uint8_t>(MemberTier::Regular) },
+        { "VIPMember", static_cast<uint8_t>(MemberTier::VIP) }, { "VIP会员", static_cast<uint8_t>(MemberTier::VIP) },
+        { "StudentMember", static_cast<uint8_t>(MemberTier::Student) }, { "学生会员", static_cast<uint8_t>(MemberTier::Student) },
+    };
+    constexpr std::string_view kHeaderNames[] = { "type", "tier", "类型", "会员类型" };
+
+    struct ChunkResult {
+        std::vector<ImportRow> rows;
+        std::vector<ImportReject> rejects;
+        size_t rejected = 0;
+        size_t lines = 0;
+    };
+
+    // 按分隔符拆分一行，支持双引号括起的字段（"" 表示一个引号）；引号不完整时返回 false
+    bool splitFields(std::string_view line, char separator, std::vector<std::string>& fields) {
+        fields.clear();
+        while (true) {
+            std::string& field = fields.emplace_back();
+            if (!line.empty() && line.front() == '"') {
+                size_t pos = 1;
+                while (true) {
+                    size_t quote = line.find('"', pos);
+                    if (quote == std::string_view::npos) return false;
+                    field.append(line.substr(pos, quote - pos));
+                    if (quote + 1 < line.size() && line[quote + 1] == '"') {
+                        field.push_back('"');
+                        pos = quote + 2;
+                        continue;
+                    }
+                    line.remove_prefix(quote + 1);
+                    break;
+                }
+                if (line.empty()) return true;
+                if (line.front() != separator) return false;
+                line.remove_prefix(1);
+            } else {
+                size_t end = line.find(separator);
+                field.assign(line.substr(0, end));
+                if (end == std::string_view::npos) return true;
+                line.remove_prefix(end + 1);
+            }
+        }
+    }
+
+    template <size_t N>
+    const TypeName* findType(const TypeName (&types)[N], std::string_view name) {
+        for (const TypeName& type : types) {
+            if (type.name == name) return &type;
+        }
+        return nullptr;
+    }
+
+    void reject(ChunkResult& result, size_t line, std::string reason) {
+        ++result.rejected;
+        if (result.rejects.size() < ImportReport::kMaxRejects) result.rejects.push_back({ line, std::move(reason) });
+    }
+
+    // 行号先按块内计数，合并时加上前面各块的行数
+    ChunkResult parseChunk(std::string_view text, ImportTarget target, char separator, bool firstChunk) {
+        ChunkResult result;
+        bool books = target == ImportTarget::Books;
+        size_t expected = books ? 3 : 2;
+        std::vector<std::string> fields;
+        while (!text.empty()) {
+            std::string_view line = textparse::nextLine(text);
+            size_t lineNumber = ++result.lines;
+            if (line.empty()) continue;
+            if (!splitFields(line, separator, fields)) {
+                reject(result, lineNumber, "引号不完整");
+                continue;
+            }
+            if (firstChunk && lineNumber == 1
+                && std::find(std::begin(kHeaderNames), std::end(kHeaderNames), fields[0]) != std::end(kHeaderNames)) {
+                continue;
+            }
+            if (fields.size() != expected) {
+                reject(result, lineNumber, "字段数为 " + std::to_string(fields.size()) + "，应为 " + std::to_string(expected));
+                continue;
+            }
+            const TypeName* type = books ? findType(kBookTypes, fields[0]) : findType(kReaderTypes, fields[0]);
+            if (!type) {
+                reject(result, lineNumber, (books ? "未知的图书类型: " : "未知的会员类型: ") + fields[0]);
+                continue;
+            }
+            if (fields[1].empty()) {
+                reject(result, lineNumber, books ? "书名为空" : "姓名为空");
+                continue;
+            }
+            // 文本导出格式以逗号分隔且不加引号，含逗号的名称无法原样保存
+            bool hasComma = fields[1].find(',') != std::string::npos || (books && fields[2].find(',') != std::string::npos);
+            if (hasComma) {
+                reject(result, lineNumber, "名称中含有逗号");
+                continue;
+            }
+            result.rows.push_back({ lineNumber, type->kind, std::move(fields[1]), books ? std::move(fields[2]) : std::string() });
+        }
+        return result;
+    }
+}
+
+ParsedImport parseImportFile(std::string_view text, ImportTarget target, ThreadPool& pool) {
+    std::string_view firstLine = text.substr(0, text.find('\n'));
+    char separator = firstLine.find('\t') != std::string_view::npos ? '\t' : ',';
+    std::vector<std::future<ChunkResult>> parts;
+    bool first = true;
+    for (std::string_view chunk : textparse::splitLines(text, pool.size() * 4)) {
+        parts.push_back(pool.submit([chunk, target, separator, first] { return parseChunk(chunk, target, separator, first); }));
+        first = false;
+    }
+    ParsedImport parsed;
+    size_t lineBase = 0;
+    for (auto& part : parts) {
+        ChunkResult result = part.get();
+        for (ImportRow& row : result.rows) row.line += lineBase;
+        for (ImportReject& rejected : result.rejects) {
+            if (parsed.report.rejects.size() == ImportReport::kMaxRejects) break;
+            rejected.line += lineBase;
+            parsed.report.rejects.push_back(std::move(rejected));
+        }
+        parsed.report.rejected += result.rejected;
+        parsed.report.rows += result.rows.size() + result.rejected;
+        if (parsed.rows.empty()) {
+            parsed.rows = std::move(result.rows);
+        } else {
+            parsed.rows.insert(parsed.rows.end(), std::make_move_iterator(result.rows.begin()), std::make_move_iterator(result.rows.end()));
+        }
+        lineBase += result.lines;
+    }
+    return parsed;
+}
+
+long peakMemoryKb() {
+#if defined(__unix__) || defined(__APPLE__)
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#else
+    return 0;
+#endif
+}
+
+void writeImportReport(std::ostream& out, const ImportReport& report) {
+    out << "共 " << report.rows << " 行：导入 " << report.imported << "，重复跳过 " << report.duplicates << "，拒绝 "
+        << report.rejected << "\n";
+    out << "耗时 " << report.seconds << " 秒，" << static_cast<long long>(report.rowsPerSecond()) << " 行/秒，峰值内存 "
+        << report.peakMemoryKb / 1024 << " MB\n";
+    for (const ImportReject& rejected : report.rejects) {
+        out << "  第 " << rejected.line << " 行: " << rejected.reason << "\n";
+    }
+    if (report.rejected > report.rejects.size()) {
+        out << "  ……另有 " << report.rejected - report.rejects.size() << " 行被拒绝\n";
+    }
+}
\ No newline at end of file
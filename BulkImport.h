@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "FinePolicy.h"
+#include "ThreadPool.h"
+
+// 批量导入的文件格式（CSV 或 TSV，按首行是否含制表符判断，字段可用双引号括起）：
+//   图书：<类型>,<书名>,<作者>    类型为 教科书 / 小说 / 杂志 / 普通图书 或 Textbook / Novel / Magazine / Book
+//   读者：<会员类型>,<姓名>       会员类型为 RegularMember / VIPMember / StudentMember 或 普通会员 / VIP会员 / 学生会员
+// 首行第一个字段为 type / tier / 类型 / 会员类型 时视为表头跳过。
+enum class ImportTarget : uint8_t { Books, Readers };
+
+struct ImportReject {
+    size_t line;
+    std::string reason;
+};
+
+struct ImportReport {
+    static constexpr size_t kMaxRejects = 100;
+
+    size_t rows = 0;        // 数据行，不含表头和空行
+    size_t imported = 0;
+    size_t duplicates = 0;  // 与现有目录或文件中前面的行同名，跳过
+    size_t rejected = 0;
+    std::vector<ImportReject> rejects;  // 按行号排列，最多保留 kMaxRejects 条
+    double seconds = 0.0;
+    long peakMemoryKb = 0;  // 进程峰值常驻内存
+
+    double rowsPerSecond() const { return seconds > 0 ? rows / seconds : 0.0; }
+};
+
+// 解析出的一行；读者行的 author 为空
+struct ImportRow {
+    size_t line;
+    uint8_t kind;  // BookCategory 或 MemberTier
+    std::string name;
+    std::string author;
+};
+
+struct ParsedImport {
+    std::vector<ImportRow> rows;  // 按行号排列
+    ImportReport report;          // 只填写 rows / rejected / rejects
+};
+
+// 按行边界切块后在线程池上并行解析，行号在合并时统一换算
+ParsedImport parseImportFile(std::string_view text, ImportTarget target, ThreadPool& pool);
+long peakMemoryKb();
+void writeImportReport(std::ostream& out, const ImportReport& report);
\ No newline at end of file
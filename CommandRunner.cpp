@@ -0,0 +1,89 @@
+#include "CommandRunner.h"
+#include <chrono>
+#include <istream>
+#include <iterator>
+#include "MappedFile.h"
+#include "TextParsing.h"
+
+BatchReport CommandRunner::run(std::string_view commands) {
+    BatchReport report;
+    auto start = std::chrono::steady_clock::now();
+    size_t lineNumber = 0;
+    while (!commands.empty()) {
+        std::string_view line = textparse::nextLine(commands);
+        ++lineNumber;
+        if (line.empty() || line.front() == '#') continue;
+        ++report.executed;
+        try {
+            execute(line);
+        } catch (const std::exception& ex) {
+            ++report.failed;
+            if (report.errors.size() < BatchReport::kMaxErrors) {
+                report.errors.push_back("第 " + std::to_string(lineNumber) + " 行: " + ex.what());
+            }
+        }
+    }
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return report;
+}
+
+BatchReport CommandRunner::runFile(const std::string& path) {
+    MappedFile file(path);
+    if (!file.isOpen()) throw InvalidInputException("无法打开命令文件: " + path);
+    return run(file.view());
+}
+
+BatchReport CommandRunner::runStream(std::istream& in) {
+    std::string commands((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    return run(commands);
+}
+
+void CommandRunner::execute(std::string_view line) {
+    std::string_view command = textparse::nextField(line);
+    if (command == "borrow") {
+        std::string title(textparse::nextField(line));
+        library.borrowBook(title, std::string(line));
+    } else if (command == "return") {
+        std::string title(textparse::nextField(line));
+        library.returnBook(title, std::string(line));
+    } else if (command == "hold") {
+        std::string title(textparse::nextField(line));
+        library.placeHold(title, std::string(line));
+    } else if (command == "unhold") {
+        std::string title(textparse::nextField(line));
+        library.cancelHold(title, std::string(line));
+    } else if (command == "pay") {
+        std::string name(textparse::nextField(line));
+        double amount = -1;
+        if (!line.empty() && !textparse::parseNumber(line, amount)) {
+            throw InvalidInputException("无效的支付金额: " + std::string(line));
+        }
+        library.payFine(name, amount);
+    } else if (command == "addbook") {
+        std::string type(textparse::nextField(line));
+        std::string title(textparse::nextField(line));
+        std::string author(line);
+        switch (categoryFromName(type)) {
+            case BookCategory::Textbook: library.addBook(library.makeBook<Textbook>(title, author)); break;
+            case BookCategory::Novel: library.addBook(library.makeBook<Novel>(title, author)); break;
+            case BookCategory::Magazine: library.addBook(library.makeBook<Magazine>(title, author)); break;
+            default: library.addBook(library.makeBook<Book>(title, author, type)); break;
+        }
+    } else if (command == "addreader") {
+        MemberTier tier = tierFromTag(textparse::nextField(line));
+        std::string name(line);
+        switch (tier) {
+            case MemberTier::VIP: library.addReader(library.makeReader<VIPMember>(name)); break;
+            case MemberTier::Student: library.addReader(library.makeReader<StudentMember>(name)); break;
+            default: library.addReader(library.makeReader<RegularMember>(name)); break;
+        }
+    } else if (command == "removebook") {
+        library.removeBook(std::string(line));
+    } else if (command == "removereader") {
+        library.removeReader(std::string(line));
+    } else if (command == "save") {
+        library.saveData();
+    } else {
+        throw InvalidInputException("未知命令: " + std::string(command));
+    }
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Library.h"
+
+// 批量执行结果：只做汇总，逐条操作不产生控制台输出
+struct BatchReport {
+    static constexpr size_t kMaxErrors = 20;
+
+    size_t executed = 0;
+    size_t failed = 0;
+    double seconds = 0.0;
+    std::vector<std::string> errors;  // 最多保留前 kMaxErrors 条，格式为 "第 N 行: 原因"
+
+    double opsPerSecond() const { return seconds > 0 ? executed / seconds : 0.0; }
+};
+
+// 无界面的批量命令执行器。每行一条命令，字段以逗号分隔，空行和 # 开头的行忽略：
+//   borrow,<书名>,<读者>          return,<书名>,<读者>          pay,<读者>[,<金额>]
+//   hold,<书名>,<读者>            unhold,<书名>,<读者>
+//   addbook,<类型>,<书名>,<作者>   addreader,<会员类型>,<姓名>
+//   removebook,<书名>             removereader,<姓名>           save
+// 会员类型与 readers.txt 相同（RegularMember / VIPMember / StudentMember）。
+class CommandRunner {
+public:
+    explicit CommandRunner(Library& library) : library(library) {}
+
+    BatchReport run(std::string_view commands);
+    BatchReport runFile(const std::string& path);
+    BatchReport runStream(std::istream& in);
+
+private:
+    void execute(std::string_view line);
+
+    Library& library;
+};
\ No newline at end of file
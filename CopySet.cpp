@@ -0,0 +1,71 @@
+#include "CopySet.h"
+#include "Exceptions.h"
+#include <algorithm>
+#include <bit>
+#include <string>
+
+namespace {
+    size_t wordCount(uint32_t copies) {
+        return (copies + CopySet::kWordBits - 1) / CopySet::kWordBits;
+    }
+
+    uint64_t bitOf(uint32_t index) {
+        return uint64_t(1) << (index % CopySet::kWordBits);
+    }
+}
+
+bool CopySet::isAvailable(uint32_t copy) const {
+    return copy < count && (words()[copy / kWordBits] & bitOf(copy)) != 0;
+}
+
+uint32_t CopySet::checkoutAny() {
+    if (summary == 0) return kNone;
+    uint32_t word = static_cast<uint32_t>(std::countr_zero(summary));
+    uint64_t& bits = words()[word];
+    uint32_t copy = word * kWordBits + static_cast<uint32_t>(std::countr_zero(bits));
+    bits &= bits - 1;
+    if (bits == 0) summary &= ~bitOf(word);
+    onShelf.fetch_sub(1, std::memory_order_relaxed);
+    return copy;
+}
+
+bool CopySet::checkout(uint32_t copy) {
+    if (!isAvailable(copy)) return false;
+    uint64_t& bits = words()[copy / kWordBits];
+    bits &= ~bitOf(copy);
+    if (bits == 0) summary &= ~bitOf(copy / kWordBits);
+    onShelf.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool CopySet::checkin(uint32_t copy) {
+    if (copy >= count || isAvailable(copy)) return false;
+    words()[copy / kWordBits] |= bitOf(copy);
+    summary |= bitOf(copy / kWordBits);
+    onShelf.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void CopySet::grow(uint32_t added) {
+    if (added == 0) return;
+    if (added > kMaxCopies - count) throw InvalidInputException("每种图书最多 " + std::to_string(kMaxCopies) + " 册");
+    uint32_t first = count;
+    uint32_t total = count + added;
+    // 超过 64 册时位图移到堆上，之后只在需要更多字时重新分配
+    if (total > kWordBits && (count <= kWordBits || wordCount(total) > wordCount(count))) {
+        auto grown = std::make_unique<uint64_t[]>(wordCount(total));
+        std::copy_n(words(), wordCount(count), grown.get());
+        heapWords = std::move(grown);
+    }
+    count = total;
+    uint64_t* bits = words();
+    for (uint32_t copy = first; copy < total; ++copy) {
+        bits[copy / kWordBits] |= bitOf(copy);
+        summary |= bitOf(copy / kWordBits);
+    }
+    onShelf.fetch_add(added, std::memory_order_relaxed);
+}
+
+size_t CopySet::heapBytes() const {
+    return count > kWordBits ? wordCount(count) * sizeof(uint64_t) : 0;
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// 同一书名下各副本的在架状态：位图中 1 表示在架，另有在架计数。
+// 不超过 64 册时位图就是对象内的一个字；更多时按每 64 册一个字放在堆上，
+// 再用一个摘要字标出哪些字里还有在架副本。"是否有在架副本" 只读计数，
+// "借出下一本在架副本" 在摘要字和位图字上各找一次最低位，两者都是 O(1)。
+// 修改由调用方加锁（Library 中为该书所在的分片锁或目录独占锁），在架计数可不加锁读取。
+class CopySet {
+public:
+    static constexpr uint32_t kWordBits = 64;
+    static constexpr uint32_t kMaxCopies = kWordBits * kWordBits;
+    static constexpr uint32_t kNone = UINT32_MAX;
+
+    // 新建时只有 1 册，在架
+    CopySet() = default;
+    CopySet(const CopySet&) = delete;
+    CopySet& operator=(const CopySet&) = delete;
+
+    uint32_t size() const { return count; }
+    uint32_t available() const { return onShelf.load(std::memory_order_relaxed); }
+    bool isAvailable(uint32_t copy) const;
+
+    // 借出编号最小的在架副本并返回其编号，全部借出时返回 kNone
+    uint32_t checkoutAny();
+    // 借出 / 归还指定副本（加载数据和重放日志时使用），副本不存在或状态不符时返回 false
+    bool checkout(uint32_t copy);
+    bool checkin(uint32_t copy);
+    // 增加 added 册在架副本；总数超过 kMaxCopies 时抛出 InvalidInputException
+    void grow(uint32_t added);
+    // 位图占用的堆内存（64 册以内为 0）
+    size_t heapBytes() const;
+
+private:
+    uint64_t* words() { return count <= kWordBits ? &inlineWord : heapWords.get(); }
+    const uint64_t* words() const { return count <= kWordBits ? &inlineWord : heapWords.get(); }
+
+    uint32_t count = 1;
+    std::atomic<uint32_t> onShelf{ 1 };
+    uint64_t summary = 1;     // 第 i 位为 1 表示第 i 个位图字里还有在架副本
+    uint64_t inlineWord = 1;  // 不超过 64 册时的位图
+    std::unique_ptr<uint64_t[]> heapWords;
+};
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// CRC-32（IEEE 802.3 多项式），日志帧和历史文件分段共用。
+// 小端平台上按 8 字节一组查 8 张表（slice-by-8），其余情况逐字节查表
+inline uint32_t crc32(uint32_t crc, const void* data, size_t length) {
+    using Tables = std::array<std::array<uint32_t, 256>, 8>;
+    static const Tables tables = [] {
+        Tables t{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[0][i] = c;
+        }
+        for (size_t k = 1; k < 8; ++k) {
+            for (size_t i = 0; i < 256; ++i) t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xFF];
+        }
+        return t;
+    }();
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+    if constexpr (std::endian::native == std::endian::little) {
+        for (; length >= 8; p += 8, length -= 8) {
+            uint32_t low, high;
+            std::memcpy(&low, p, sizeof(low));
+            std::memcpy(&high, p + 4, sizeof(high));
+            low ^= crc;
+            crc = tables[7][low & 0xFF] ^ tables[6][(low >> 8) & 0xFF] ^ tables[5][(low >> 16) & 0xFF] ^ tables[4][low >> 24]
+                ^ tables[3][high & 0xFF] ^ tables[2][(high >> 8) & 0xFF] ^ tables[1][(high >> 16) & 0xFF] ^ tables[0][high >> 24];
+        }
+    }
+    for (; length > 0; ++p, --length) crc = tables[0][(crc ^ *p) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
\ No newline at end of file
@@ -1,19 +1,140 @@
 #include "DateUtils.h"
+#include <cstdint>
+
+namespace {
+    std::atomic<const Clock*> installedClock{ nullptr };
+
+    // 公历日期与 1970-01-01 起的天数互相换算（纯整数运算）
+    int64_t daysFromCivil(int64_t year, unsigned month, unsigned day) {
+        year -= month <= 2;
+        int64_t era = (year >= 0 ? year : year - 399) / 400;
+        unsigned yearOfEra = static_cast<unsigned>(year - era * 400);
+        unsigned dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+        unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        return era * 146097 + static_cast<int64_t>(dayOfEra) - 719468;
+    }
+
+    void civilFromDays(int64_t days, int64_t& year, unsigned& month, unsigned& day) {
+        days += 719468;
+        int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+        unsigned dayOfEra = static_cast<unsigned>(days - era * 146097);
+        unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        unsigned shiftedMonth = (5 * dayOfYear + 2) / 153;
+        day = dayOfYear - (153 * shiftedMonth + 2) / 5 + 1;
+        month = shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9;
+        year = static_cast<int64_t>(yearOfEra) + era * 400 + (month <= 2);
+    }
+
+    bool toLocalTime(std::time_t time, std::tm& local) {
+#ifdef _WIN32
+        return localtime_s(&local, &time) == 0;
+#else
+        return localtime_r(&time, &local) != nullptr;
+#endif
+    }
+
+    bool localOffset(std::time_t time, int32_t& offset) {
+        std::tm local{};
+        if (!toLocalTime(time, local)) return false;
+        int64_t localSeconds = daysFromCivil(local.tm_year + 1900, local.tm_mon + 1, local.tm_mday) * DateUtils::kSecondsPerDay
+            + local.tm_hour * 3600 + local.tm_min * 60 + local.tm_sec;
+        offset = static_cast<int32_t>(localSeconds - time);
+        return true;
+    }
+
+    // 本地时间相对 UTC 的偏移按 UTC 日缓存：一天首尾的偏移相同时，当天没有夏令时切换，整天共用一个偏移；
+    // 有切换的那一天不缓存，逐次调用 localtime。命中时格式化只做整数运算
+    struct OffsetCache {
+        static constexpr size_t kSlots = 1024;
+        int64_t days[kSlots];
+        int32_t offsets[kSlots];
+
+        OffsetCache() {
+            for (int64_t& day : days) day = INT64_MIN;
+        }
+
+        bool lookup(std::time_t time, int32_t& offset) {
+            int64_t day = (time >= 0 ? time : time - (DateUtils::kSecondsPerDay - 1)) / DateUtils::kSecondsPerDay;
+            size_t slot = static_cast<size_t>(day) % kSlots;
+            if (days[slot] == day) {
+                offset = offsets[slot];
+                return true;
+            }
+            std::time_t dayStart = static_cast<std::time_t>(day * DateUtils::kSecondsPerDay);
+            int32_t first, last;
+            if (!localOffset(dayStart, first) || !localOffset(dayStart + DateUtils::kSecondsPerDay - 1, last)) return false;
+            if (first != last) return localOffset(time, offset);
+            days[slot] = day;
+            offsets[slot] = first;
+            offset = first;
+            return true;
+        }
+    };
+
+    void putTwoDigits(char* out, unsigned value) {
+        out[0] = static_cast<char>('0' + value / 10);
+        out[1] = static_cast<char>('0' + value % 10);
+    }
+}
 
 std::string DateUtils::formatTime(std::time_t time) {
-    char buffer[26];
-    ctime_s(buffer, sizeof(buffer), &time);
-    std::string result(buffer);
-    if (!result.empty() && result[result.length() - 1] == '\n') {
-        result.erase(result.length() - 1);
+    char buffer[kTimeTextSize];
+    size_t length = formatTime(time, buffer, sizeof(buffer));
+    return std::string(buffer, length);
+}
+
+// 输出与 ctime 相同（不含换行），如 "Thu Jan  1 08:00:00 1970"
+size_t DateUtils::formatTime(std::time_t time, char* buffer, size_t size) {
+    static const char kWeekdays[] = "SunMonTueWedThuFriSat";
+    static const char kMonths[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+    thread_local OffsetCache cache;
+    int32_t offset;
+    if (size < kTimeTextSize || !cache.lookup(time, offset)) {
+        if (size > 0) buffer[0] = '\0';
+        return 0;
+    }
+    int64_t local = static_cast<int64_t>(time) + offset;
+    int64_t days = (local >= 0 ? local : local - (kSecondsPerDay - 1)) / kSecondsPerDay;
+    int64_t seconds = local - days * kSecondsPerDay;
+    int64_t year;
+    unsigned month, day;
+    civilFromDays(days, year, month, day);
+    if (year < 1000 || year > 9999) {
+        buffer[0] = '\0';
+        return 0;
     }
-    return result;
+    unsigned weekday = static_cast<unsigned>(((days % 7) + 11) % 7);  // 1970-01-01 是星期四
+    char* out = buffer;
+    for (int i = 0; i < 3; ++i) *out++ = kWeekdays[weekday * 3 + i];
+    *out++ = ' ';
+    for (int i = 0; i < 3; ++i) *out++ = kMonths[(month - 1) * 3 + i];
+    *out++ = ' ';
+    *out++ = day >= 10 ? static_cast<char>('0' + day / 10) : ' ';
+    *out++ = static_cast<char>('0' + day % 10);
+    *out++ = ' ';
+    putTwoDigits(out, static_cast<unsigned>(seconds / 3600));
+    out[2] = ':';
+    putTwoDigits(out + 3, static_cast<unsigned>(seconds / 60 % 60));
+    out[5] = ':';
+    putTwoDigits(out + 6, static_cast<unsigned>(seconds % 60));
+    out[8] = ' ';
+    out += 9;
+    putTwoDigits(out, static_cast<unsigned>(year / 100));
+    putTwoDigits(out + 2, static_cast<unsigned>(year % 100));
+    out[4] = '\0';
+    return static_cast<size_t>(out + 4 - buffer);
 }
 
 int DateUtils::daysBetween(std::time_t start, std::time_t end) {
-    return static_cast<int>((end - start) / (24 * 60 * 60));
+    return static_cast<int>((end - start) / kSecondsPerDay);
 }
 
 std::time_t DateUtils::getCurrentTime() {
-    return std::time(nullptr);
+    const Clock* clock = installedClock.load(std::memory_order_acquire);
+    return clock ? clock->now() : std::time(nullptr);
+}
+
+void DateUtils::setClock(const Clock* clock) {
+    installedClock.store(clock, std::memory_order_release);
 }
\ No newline at end of file
@@ -1,10 +1,41 @@
 #pragma once
+#include <atomic>
+#include <cstddef>
 #include <ctime>
 #include <string>
 
+// 时钟源。默认读系统时钟；基准和测试可以安装 FakeClock，借阅、超期和报表都按模拟时间计算
+class Clock {
+public:
+    virtual ~Clock() = default;
+    virtual std::time_t now() const = 0;
+};
+
+class FakeClock : public Clock {
+public:
+    explicit FakeClock(std::time_t start) : current(start) {}
+    std::time_t now() const override { return current.load(std::memory_order_relaxed); }
+    void set(std::time_t time) { current.store(time, std::memory_order_relaxed); }
+    void advance(std::time_t seconds) { current.fetch_add(seconds, std::memory_order_relaxed); }
+    void advanceDays(int days) { advance(static_cast<std::time_t>(days) * 24 * 60 * 60); }
+
+private:
+    std::atomic<std::time_t> current;
+};
+
 class DateUtils {
 public:
+    static constexpr std::time_t kSecondsPerDay = 24 * 60 * 60;
+    // ctime 格式 "Www Mmm dd hh:mm:ss yyyy" 的长度加结尾的 '\0'
+    static constexpr size_t kTimeTextSize = 25;
+
     static std::string formatTime(std::time_t time);
+    // 写入调用方的缓冲区（至少 kTimeTextSize 字节），不分配内存；返回写入的字符数，缓冲区不足时返回 0
+    static size_t formatTime(std::time_t time, char* buffer, size_t size);
     static int daysBetween(std::time_t start, std::time_t end);
+
+    // 一次操作或一张报表只取一次当前时间，之后的计算都使用这个值
     static std::time_t getCurrentTime();
+    // 安装时钟源，nullptr 恢复系统时钟；调用方保证时钟对象在使用期间有效
+    static void setClock(const Clock* clock);
 };
\ No newline at end of file
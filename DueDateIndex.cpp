@@ -0,0 +1,26 @@
+#include "DueDateIndex.h"
+
+void DueDateIndex::add(size_t pos, std::time_t dueDate) {
+    entries.emplace(dueDate, pos);
+}
+
+void DueDateIndex::remove(size_t pos, std::time_t dueDate) {
+    auto range = entries.equal_range(dueDate);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == pos) {
+            entries.erase(it);
+            return;
+        }
+    }
+}
+
+std::pair<DueDateIndex::const_iterator, DueDateIndex::const_iterator>
+DueDateIndex::dueBetween(std::time_t from, std::time_t to) const {
+    if (to <= from) return { entries.end(), entries.end() };
+    return { entries.lower_bound(from), entries.lower_bound(to) };
+}
+
+std::pair<DueDateIndex::const_iterator, DueDateIndex::const_iterator>
+DueDateIndex::dueBefore(std::time_t before) const {
+    return { entries.begin(), entries.lower_bound(before) };
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#pragma once
+#include <ctime>
+#include <map>
+#include <utility>
+#include <cstddef>
+
+// 未归还借阅按应还日期排序的索引（值为 borrowRecords 中的下标）。
+// 超期、即将到期查询都是区间扫描，开销只与结果数量相关。
+class DueDateIndex {
+public:
+    using const_iterator = std::multimap<std::time_t, size_t>::const_iterator;
+
+    void add(size_t pos, std::time_t dueDate);
+    void remove(size_t pos, std::time_t dueDate);
+    void clear() { entries.clear(); }
+    size_t size() const { return entries.size(); }
+
+    // 应还日期位于 [from, to) 的未还借阅
+    std::pair<const_iterator, const_iterator> dueBetween(std::time_t from, std::time_t to) const;
+    // 应还日期早于 before 的未还借阅
+    std::pair<const_iterator, const_iterator> dueBefore(std::time_t before) const;
+
+private:
+    std::multimap<std::time_t, size_t> entries;
+};
\ No newline at end of file
@@ -19,7 +19,15 @@ class BookNotBorrowedException : public std::runtime_error {
 public:
     BookNotBorrowedException(const std::string& message) : std::runtime_error(message) {}
 };
+class LoanLimitException : public std::runtime_error {
+public:
+    LoanLimitException(const std::string& message) : std::runtime_error(message) {}
+};
 class InvalidInputException : public std::runtime_error {
 public:
     InvalidInputException(const std::string& message) : std::runtime_error(message) {}
+};
+class DataFormatException : public std::runtime_error {
+public:
+    DataFormatException(const std::string& message) : std::runtime_error(message) {}
 };
\ No newline at end of file
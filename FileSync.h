@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <cstdio>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// 把文件描述符上已写入的数据刷到磁盘
+inline bool syncDescriptor(int fd) {
+#ifdef _WIN32
+    return _commit(fd) == 0;
+#else
+    return ::fsync(fd) == 0;
+#endif
+}
+
+inline bool syncFile(std::FILE* file) {
+    if (std::fflush(file) != 0) return false;
+#ifdef _WIN32
+    return syncDescriptor(_fileno(file));
+#else
+    return syncDescriptor(::fileno(file));
+#endif
+}
+
+// 写完整个缓冲区，中途出错返回 false
+inline bool writeAll(int fd, const char* data, size_t length) {
+    while (length > 0) {
+#ifdef _WIN32
+        int n = _write(fd, data, static_cast<unsigned int>(length));
+#else
+        ssize_t n = ::write(fd, data, length);
+#endif
+        if (n <= 0) return false;
+        data += n;
+        length -= static_cast<size_t>(n);
+    }
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,119 @@
+#include "FineAccrual.h"
+#include "DateUtils.h"
+#include <algorithm>
+#include <future>
+#include <iomanip>
+#include <ostream>
+#include <unordered_map>
+
+namespace {
+    constexpr size_t kCategories = static_cast<size_t>(BookCategory::Count);
+    constexpr size_t kMinChunk = 4096;
+
+    struct PartialAccrual {
+        FineExposure byCategory[kCategories];
+        std::unordered_map<Symbol, FineExposure> byReader;
+    };
+
+    void addExposure(FineExposure& into, const FineExposure& from) {
+        into.loans += from.loans;
+        into.overdueLoans += from.overdueLoans;
+        into.fine += from.fine;
+    }
+
+    PartialAccrual accrueRange(const OpenLoans& loans, size_t first, size_t last, std::time_t now) {
+        PartialAccrual partial;
+        size_t count = last - first;
+        std::vector<int32_t> overdueDays(count);
+        std::vector<double> fines(count);
+        // 超期口径与 BorrowRecord::getOverdueDays 一致：满一整天才算一天
+        for (size_t i = 0; i < count; ++i) {
+            int64_t late = now - loans.dueDates[first + i];
+            overdueDays[i] = late > 0 ? static_cast<int32_t>(late / DateUtils::kSecondsPerDay) : 0;
+        }
+        FinePolicy::computeFines(count, overdueDays.data(), loans.categories.data() + first, loans.tiers.data() + first, fines.data());
+        for (size_t i = 0; i < count; ++i) {
+            bool overdue = overdueDays[i] > 0;
+            FineExposure& category = partial.byCategory[static_cast<size_t>(loans.categories[first + i])];
+            ++category.loans;
+            category.overdueLoans += overdue;
+            category.fine += fines[i];
+            if (!overdue) continue;
+            FineExposure& reader = partial.byReader[loans.readers[first + i]];
+            ++reader.loans;
+            ++reader.overdueLoans;
+            reader.fine += fines[i];
+        }
+        return partial;
+    }
+}
+
+void OpenLoans::reserve(size_t count) {
+    readers.reserve(count);
+    dueDates.reserve(count);
+    categories.reserve(count);
+    tiers.reserve(count);
+}
+
+void OpenLoans::add(Symbol reader, int64_t dueDate, BookCategory category, MemberTier tier) {
+    readers.push_back(reader);
+    dueDates.push_back(dueDate);
+    categories.push_back(category);
+    tiers.push_back(tier);
+}
+
+FineAccrualReport computeFineAccrual(const OpenLoans& loans, std::time_t now, ThreadPool& pool) {
+    FineAccrualReport report;
+    report.asOf = now;
+    report.threads = pool.size();
+    size_t chunk = std::max(kMinChunk, (loans.size() + pool.size() * 4 - 1) / (pool.size() * 4));
+    std::vector<std::future<PartialAccrual>> parts;
+    for (size_t first = 0; first < loans.size(); first += chunk) {
+        size_t last = std::min(loans.size(), first + chunk);
+        parts.push_back(pool.submit([&loans, first, last, now] { return accrueRange(loans, first, last, now); }));
+    }
+    std::unordered_map<Symbol, FineExposure> byReader;
+    for (auto& part : parts) {
+        PartialAccrual partial = part.get();
+        for (size_t i = 0; i < kCategories; ++i) {
+            addExposure(report.byCategory[i], partial.byCategory[i]);
+            addExposure(report.total, partial.byCategory[i]);
+        }
+        if (byReader.empty()) {
+            byReader = std::move(partial.byReader);
+        } else {
+            for (const auto& [reader, exposure] : partial.byReader) addExposure(byReader[reader], exposure);
+        }
+    }
+    report.byReader.assign(byReader.begin(), byReader.end());
+    std::sort(report.byReader.begin(), report.byReader.end(), [](const auto& a, const auto& b) {
+        return a.second.fine != b.second.fine ? a.second.fine > b.second.fine : a.first.view() < b.first.view();
+    });
+    return report;
+}
+
+void writeFineAccrualReport(std::ostream& out, const FineAccrualReport& report, size_t topReaders) {
+    char asOf[DateUtils::kTimeTextSize];
+    DateUtils::formatTime(report.asOf, asOf, sizeof(asOf));
+    out << "罚款预估（截至 " << asOf << "）\n";
+    out << "未还借阅 " << report.total.loans << " 笔，其中超期 " << report.total.overdueLoans << " 笔，预估罚款合计 "
+        << std::fixed << std::setprecision(2) << report.total.fine << " 元\n";
+    out << "计算耗时 " << std::setprecision(3) << report.seconds * 1000 << " ms，" << report.threads << " 个线程，"
+        << std::setprecision(0) << report.loansPerSecond() << " 笔/秒\n";
+    out << std::setprecision(2);
+    out << "\n按图书类别：\n";
+    for (size_t i = 0; i < kCategories; ++i) {
+        const FineExposure& exposure = report.byCategory[i];
+        out << "  " << categoryName(static_cast<BookCategory>(i)) << ": 未还 " << exposure.loans << " 笔, 超期 "
+            << exposure.overdueLoans << " 笔, 罚款 " << exposure.fine << " 元\n";
+    }
+    size_t shown = std::min(topReaders, report.byReader.size());
+    out << "\n按读者（有超期借阅的 " << report.byReader.size() << " 位";
+    if (shown < report.byReader.size()) out << "，列出前 " << shown << " 位";
+    out << "）：\n";
+    for (size_t i = 0; i < shown; ++i) {
+        const auto& [reader, exposure] = report.byReader[i];
+        out << "  " << reader.view() << ": 超期 " << exposure.overdueLoans << " 笔, 罚款 " << exposure.fine << " 元\n";
+    }
+    out << std::defaultfloat << std::setprecision(6);
+}
\ No newline at end of file
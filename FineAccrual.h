@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <iosfwd>
+#include <vector>
+#include "FinePolicy.h"
+#include "Symbol.h"
+#include "ThreadPool.h"
+
+// 未还借阅的列式副本：由 Library 在持锁期间复制出来，之后的计算不再访问图书 / 读者对象
+struct OpenLoans {
+    std::vector<Symbol> readers;
+    std::vector<int64_t> dueDates;
+    std::vector<BookCategory> categories;
+    std::vector<MemberTier> tiers;
+
+    size_t size() const { return dueDates.size(); }
+    void reserve(size_t count);
+    void add(Symbol reader, int64_t dueDate, BookCategory category, MemberTier tier);
+};
+
+struct FineExposure {
+    size_t loans = 0;
+    size_t overdueLoans = 0;
+    double fine = 0.0;
+};
+
+// 罚款预估批处理的结果：每笔未还借阅若此刻归还应缴的罚款，按读者和图书类别汇总
+struct FineAccrualReport {
+    std::time_t asOf = 0;
+    FineExposure total;
+    FineExposure byCategory[static_cast<size_t>(BookCategory::Count)];
+    std::vector<std::pair<Symbol, FineExposure>> byReader;  // 只含有超期借阅的读者，按罚款降序
+    size_t threads = 0;
+    double seconds = 0.0;  // 含复制未还借阅的时间
+
+    double loansPerSecond() const { return seconds > 0 ? total.loans / seconds : 0.0; }
+};
+
+// 按块分给线程池：每块算出超期天数后用 FinePolicy::computeFines 批量计费，块内汇总后再合并
+FineAccrualReport computeFineAccrual(const OpenLoans& loans, std::time_t now, ThreadPool& pool);
+// 文本报表；topReaders 限制列出的读者数
+void writeFineAccrualReport(std::ostream& out, const FineAccrualReport& report, size_t topReaders = SIZE_MAX);
\ No newline at end of file
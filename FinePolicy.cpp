@@ -0,0 +1,85 @@
+#include "FinePolicy.h"
+#include "Exceptions.h"
+#include "MappedFile.h"
+#include "TextParsing.h"
+#include <algorithm>
+
+FineTable FinePolicy::active;
+
+namespace {
+    constexpr std::string_view kCategoryNames[] = { "普通图书", "教科书", "小说", "杂志" };
+    constexpr std::string_view kTierNames[] = { "普通会员", "VIP会员", "学生会员" };
+    constexpr std::string_view kTierTags[] = { "RegularMember", "VIPMember", "StudentMember" };
+}
+
+std::string_view categoryName(BookCategory category) {
+    return kCategoryNames[static_cast<size_t>(category)];
+}
+
+BookCategory categoryFromName(std::string_view name) {
+    for (size_t i = 1; i < static_cast<size_t>(BookCategory::Count); ++i) {
+        if (kCategoryNames[i] == name) return static_cast<BookCategory>(i);
+    }
+    return BookCategory::General;
+}
+
+std::string_view tierName(MemberTier tier) {
+    return kTierNames[static_cast<size_t>(tier)];
+}
+
+std::string_view tierTag(MemberTier tier) {
+    return kTierTags[static_cast<size_t>(tier)];
+}
+
+MemberTier tierFromTag(std::string_view tag) {
+    for (size_t i = 1; i < static_cast<size_t>(MemberTier::Count); ++i) {
+        if (kTierTags[i] == tag) return static_cast<MemberTier>(i);
+    }
+    return MemberTier::Regular;
+}
+
+bool FinePolicy::loadFile(const std::string& path) {
+    MappedFile file(path);
+    if (!file.isOpen()) return false;
+    FineTable table;
+    std::string_view text = file.view();
+    int lineNumber = 0;
+    while (!text.empty()) {
+        std::string_view line = textparse::nextLine(text);
+        ++lineNumber;
+        if (line.empty() || line.front() == '#') continue;
+        std::string_view kind = textparse::nextField(line);
+        std::string_view name = textparse::nextField(line);
+        double value = 0.0;
+        if (!textparse::parseNumber(line, value) || value < 0) {
+            throw InvalidInputException(path + " 第 " + std::to_string(lineNumber) + " 行: 数值无效");
+        }
+        if (kind == "category") {
+            auto it = std::find(std::begin(kCategoryNames), std::end(kCategoryNames), name);
+            if (it == std::end(kCategoryNames)) throw InvalidInputException(path + " 第 " + std::to_string(lineNumber) + " 行: 未知图书类别");
+            table.ratePerDay[it - std::begin(kCategoryNames)] = value;
+        } else if (kind == "tier" || kind == "limit") {
+            auto it = std::find(std::begin(kTierTags), std::end(kTierTags), name);
+            if (it == std::end(kTierTags)) throw InvalidInputException(path + " 第 " + std::to_string(lineNumber) + " 行: 未知会员类型");
+            if (kind == "tier") {
+                table.discount[it - std::begin(kTierTags)] = value;
+            } else {
+                table.loanLimit[it - std::begin(kTierTags)] = static_cast<int>(value);
+            }
+        } else {
+            throw InvalidInputException(path + " 第 " + std::to_string(lineNumber) + " 行: 未知配置项");
+        }
+    }
+    configure(table);
+    return true;
+}
+
+void FinePolicy::computeFines(size_t count, const int32_t* overdueDays, const BookCategory* categories,
+    const MemberTier* tiers, double* fines) {
+    const double* rates = active.ratePerDay;
+    const double* discounts = active.discount;
+    for (size_t i = 0; i < count; ++i) {
+        int32_t days = std::max(overdueDays[i], 0);
+        fines[i] = days * rates[static_cast<size_t>(categories[i])] * discounts[static_cast<size_t>(tiers[i])];
+    }
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// 图书类别与会员等级，作为罚款费率表 / 折扣表的下标
+enum class BookCategory : uint8_t { General, Textbook, Novel, Magazine, Count };
+enum class MemberTier : uint8_t { Regular, VIP, Student, Count };
+
+// 类别 / 等级与名称之间的转换
+std::string_view categoryName(BookCategory category);
+BookCategory categoryFromName(std::string_view name);
+std::string_view tierName(MemberTier tier);         // 显示名称，如 "VIP会员"
+std::string_view tierTag(MemberTier tier);          // 文件中的类型标记，如 "VIPMember"
+MemberTier tierFromTag(std::string_view tag);
+
+struct FineTable {
+    // 按 BookCategory 排列的每日罚款（元/天）
+    double ratePerDay[static_cast<size_t>(BookCategory::Count)] = { 1.0, 2.0, 1.0, 0.5 };
+    // 按 MemberTier 排列的罚款折扣
+    double discount[static_cast<size_t>(MemberTier::Count)] = { 1.0, 0.9, 0.8 };
+    // 按 MemberTier 排列的最大在借数量，0 表示不限
+    int loanLimit[static_cast<size_t>(MemberTier::Count)] = { 10, 20, 15 };
+};
+
+// 表驱动的罚款策略。默认表与 Textbook / Novel / Magazine 和 VIPMember / StudentMember 原有的费率一致，
+// 可在启动时从配置文件替换；运行期间只读。
+class FinePolicy {
+public:
+    static const FineTable& table() { return active; }
+    static void configure(const FineTable& table) { active = table; }
+    // 读取 "category,<类别名>,<元/天>"、"tier,<会员类型>,<折扣>" 与 "limit,<会员类型>,<本数>" 格式的配置文件，
+    // 文件不存在返回 false，格式错误抛出 InvalidInputException
+    static bool loadFile(const std::string& path);
+
+    static double ratePerDay(BookCategory category) { return active.ratePerDay[static_cast<size_t>(category)]; }
+    static double discount(MemberTier tier) { return active.discount[static_cast<size_t>(tier)]; }
+    static int loanLimit(MemberTier tier) { return active.loanLimit[static_cast<size_t>(tier)]; }
+    static double fine(int overdueDays, BookCategory category, MemberTier tier) {
+        return overdueDays > 0 ? overdueDays * ratePerDay(category) * discount(tier) : 0.0;
+    }
+
+    // 批量计算：只做查表和乘法，没有虚函数调用和分支
+    static void computeFines(size_t count, const int32_t* overdueDays, const BookCategory* categories,
+        const MemberTier* tiers, double* fines);
+
+private:
+    static FineTable active;
+};
\ No newline at end of file
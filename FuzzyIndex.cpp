@@ -0,0 +1,134 @@
+#include "FuzzyIndex.h"
+#include <algorithm>
+#include <cstdlib>
+#include "Utf8.h"
+
+namespace {
+    // 单行动态规划；名称一般很短，行缓冲优先放在栈上
+    int editDistance(const std::u32string& a, const std::u32string& b) {
+        int stackRow[64];
+        std::vector<int> heapRow;
+        int* row = stackRow;
+        if (b.size() >= 64) {
+            heapRow.resize(b.size() + 1);
+            row = heapRow.data();
+        }
+        for (size_t j = 0; j <= b.size(); ++j) row[j] = static_cast<int>(j);
+        for (size_t i = 1; i <= a.size(); ++i) {
+            int diagonal = row[0];
+            row[0] = static_cast<int>(i);
+            for (size_t j = 1; j <= b.size(); ++j) {
+                int above = row[j];
+                row[j] = std::min({ above + 1, row[j - 1] + 1, diagonal + (a[i - 1] == b[j - 1] ? 0 : 1) });
+                diagonal = above;
+            }
+        }
+        return row[b.size()];
+    }
+
+    // 默认容错：短名称只容 1 个错字，越长容得越多
+    int defaultMaxDistance(size_t length) {
+        return length <= 4 ? 1 : length <= 10 ? 2 : 3;
+    }
+}
+
+void FuzzyIndex::insert(Symbol key) {
+    Node node;
+    node.text = utf8::decodeFolded(key.view());
+    node.key = key;
+    node.count = 1;
+    uint32_t id = static_cast<uint32_t>(nodes.size());
+    if (!nodes.empty()) {
+        uint32_t current = 0;
+        while (true) {
+            uint32_t distance = static_cast<uint32_t>(editDistance(node.text, nodes[current].text));
+            auto& children = nodes[current].children;
+            auto it = std::find_if(children.begin(), children.end(), [&](const auto& child) { return child.first == distance; });
+            if (it == children.end()) {
+                children.emplace_back(distance, id);
+                break;
+            }
+            current = it->second;
+        }
+    }
+    nodes.push_back(std::move(node));
+    nodeOf.emplace(key, id);
+}
+
+void FuzzyIndex::add(Symbol key) {
+    auto it = nodeOf.find(key);
+    if (it == nodeOf.end()) {
+        insert(key);
+    } else {
+        ++nodes[it->second].count;
+    }
+    ++liveCount;
+}
+
+void FuzzyIndex::remove(Symbol key) {
+    auto it = nodeOf.find(key);
+    if (it == nodeOf.end() || nodes[it->second].count == 0) return;
+    --nodes[it->second].count;
+    --liveCount;
+    if (nodes.size() > 1024 && liveCount * 2 < nodes.size()) rebuild();
+}
+
+void FuzzyIndex::clear() {
+    nodes.clear();
+    nodeOf.clear();
+    liveCount = 0;
+}
+
+void FuzzyIndex::rebuild() {
+    std::vector<std::pair<Symbol, uint32_t>> live;
+    for (const Node& node : nodes) {
+        if (node.count > 0) live.emplace_back(node.key, node.count);
+    }
+    clear();
+    for (const auto& [key, count] : live) {
+        insert(key);
+        nodes.back().count = count;
+        liveCount += count;
+    }
+}
+
+std::vector<FuzzyMatch> FuzzyIndex::closest(std::string_view query, size_t k, int maxDistance) const {
+    std::vector<FuzzyMatch> matches;
+    if (nodes.empty() || k == 0) return matches;
+    std::u32string text = utf8::decodeFolded(query);
+    int radius = maxDistance >= 0 ? maxDistance : defaultMaxDistance(text.size());
+
+    // 子树内所有名称与父节点的距离都等于挂接边的距离，由三角不等式得到子树的距离下界 |d - 边|。
+    // 按下界从小到大展开，先找到最接近的名称；凑满 k 个后半径收缩到其中最大的距离。
+    using Pending = std::pair<int, uint32_t>;  // (下界, 节点)
+    std::vector<Pending> pending{ { 0, 0 } };
+    auto farther = [](const Pending& a, const Pending& b) { return a.first > b.first; };
+    auto worse = [](const FuzzyMatch& a, const FuzzyMatch& b) { return a.distance < b.distance; };
+    size_t visits = 0;
+    while (!pending.empty() && visits < kMaxVisits) {
+        std::pop_heap(pending.begin(), pending.end(), farther);
+        auto [bound, id] = pending.back();
+        pending.pop_back();
+        if (bound > radius) break;
+        const Node& node = nodes[id];
+        ++visits;
+        int distance = editDistance(text, node.text);
+        if (node.count > 0 && distance <= radius) {
+            matches.push_back({ node.key, distance });
+            std::push_heap(matches.begin(), matches.end(), worse);
+            if (matches.size() > k) {
+                std::pop_heap(matches.begin(), matches.end(), worse);
+                matches.pop_back();
+            }
+            if (matches.size() == k) radius = std::min(radius, matches.front().distance);
+        }
+        for (const auto& [edge, child] : node.children) {
+            int childBound = std::max(bound, std::abs(distance - static_cast<int>(edge)));
+            if (childBound > radius) continue;
+            pending.emplace_back(childBound, child);
+            std::push_heap(pending.begin(), pending.end(), farther);
+        }
+    }
+    std::sort_heap(matches.begin(), matches.end(), worse);
+    return matches;
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Symbol.h"
+
+struct FuzzyMatch {
+    Symbol key;
+    int distance;  // 按字符计算的编辑距离，不区分 ASCII 大小写
+};
+
+// 书名 / 读者姓名的纠错索引（BK 树）。子节点按与父节点的编辑距离挂接，
+// 查询时由三角不等式只走距离区间内的分支，不扫描全部名称。
+// 同名对象按引用计数共用一个节点；删除只减计数，失效节点过半时重建。
+class FuzzyIndex {
+public:
+    void add(Symbol key);
+    void remove(Symbol key);
+    void clear();
+
+    // 返回至多 k 个最接近的名称，距离升序。maxDistance < 0 时按查询长度取默认上限（1~3）。
+    // 单次查询最多计算 kMaxVisits 个节点的距离，超出时返回已找到的结果。
+    std::vector<FuzzyMatch> closest(std::string_view query, size_t k = 3, int maxDistance = -1) const;
+    size_t size() const { return liveCount; }
+
+    static constexpr size_t kMaxVisits = 4096;
+
+private:
+    struct Node {
+        std::u32string text;
+        Symbol key;
+        uint32_t count = 0;
+        std::vector<std::pair<uint32_t, uint32_t>> children;  // (编辑距离, 子节点)
+    };
+
+    void insert(Symbol key);
+    void rebuild();
+
+    std::vector<Node> nodes;  // nodes[0] 为根
+    std::unordered_map<Symbol, uint32_t> nodeOf;
+    size_t liveCount = 0;
+};
\ No newline at end of file
@@ -0,0 +1,368 @@
+#include "HistoryStore.h"
+#include "Crc32.h"
+#include "Exceptions.h"
+#include "FileSync.h"
+#include "MappedFile.h"
+#include "Varint.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <stdexcept>
+#include <unordered_map>
+#ifdef _WIN32
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+    constexpr char kMagic[8] = { 'L', 'I', 'B', 'H', 'I', 'S', 'T', '\0' };
+    constexpr uint32_t kVersion = 1;
+    constexpr size_t kHeaderSize = sizeof(kMagic) + 2 * sizeof(uint32_t);
+    constexpr uint32_t kRecordSegment = 1;
+    constexpr uint32_t kPurgeSegment = 2;
+    // 每段记录数上限：查询按段跳过，段越小过滤越精细，字典重复越多
+    constexpr size_t kSegmentRecords = 1024;
+    // 每个名称 12 位、6 次探测，误判率约 0.5%
+    constexpr size_t kFilterBitsPerKey = 12;
+    constexpr int kFilterProbes = 6;
+
+    struct SegmentHeader {
+        uint32_t kind;
+        uint32_t count;
+        uint64_t generation;
+        uint32_t filterBytes;
+        uint32_t payloadBytes;
+        uint32_t crc;  // 过滤器 + 负载
+        uint32_t reserved;
+    };
+
+    // FNV-1a 再做一次 splitmix 混合；结果写入文件，不能用随实现变化的 std::hash
+    uint64_t keyHash(HistoryKey key, std::string_view name) {
+        uint64_t h = 0xcbf29ce484222325ull ^ static_cast<uint64_t>(key);
+        for (unsigned char c : name) h = (h ^ c) * 0x100000001b3ull;
+        h ^= h >> 30;
+        h *= 0xbf58476d1ce4e5b9ull;
+        h ^= h >> 27;
+        h *= 0x94d049bb133111ebull;
+        return h ^ (h >> 31);
+    }
+
+    // 分块布隆过滤器：高 32 位选定一个 64 字节块，各次探测都落在块内，查询一段只碰一条缓存行
+    constexpr size_t kFilterBlockBits = 512;
+
+    template <typename Visit>
+    void forEachProbe(uint64_t hash, uint64_t bits, Visit visit) {
+        uint64_t block = ((hash >> 32) * (bits / kFilterBlockBits)) >> 32;
+        uint64_t probes = hash * 0x9e3779b97f4a7c15ull;
+        for (int i = 0; i < kFilterProbes; ++i) {
+            visit(block * kFilterBlockBits + ((probes >> (i * 9)) & (kFilterBlockBits - 1)));
+        }
+    }
+
+    bool filterContains(const char* filter, size_t filterBytes, uint64_t hash) {
+        if (filterBytes < kFilterBlockBits / 8) return true;
+        bool found = true;
+        forEachProbe(hash, filterBytes * 8, [&](uint64_t bit) {
+            found = found && (static_cast<unsigned char>(filter[bit >> 3]) >> (bit & 7)) & 1;
+        });
+        return found;
+    }
+
+    int openFile(const std::string& path) {
+#ifdef _WIN32
+        return _open(path.c_str(), _O_RDWR | _O_CREAT | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+        return ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+#endif
+    }
+
+    void truncateFile(int fd, uint64_t bytes, const std::string& path) {
+#ifdef _WIN32
+        if (_chsize_s(fd, static_cast<long long>(bytes)) != 0) throw std::runtime_error("无法截断历史文件: " + path);
+        _lseeki64(fd, 0, SEEK_END);
+#else
+        if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0) throw std::runtime_error("无法截断历史文件: " + path);
+        ::lseek(fd, 0, SEEK_END);
+#endif
+    }
+}
+
+HistoryStore::~HistoryStore() {
+    close();
+}
+
+void HistoryStore::open(const std::string& filePath, uint64_t committedGeneration) {
+    close();
+    path = filePath;
+    uint64_t validBytes = 0;
+    {
+        MappedFile file(path);
+        if (file.isOpen() && file.size() > 0) {
+            const char* base = file.begin();
+            uint32_t version = 0;
+            if (file.size() >= kHeaderSize) std::memcpy(&version, base + sizeof(kMagic), sizeof(version));
+            if (file.size() < kHeaderSize || std::memcmp(base, kMagic, sizeof(kMagic)) != 0 || version != kVersion) {
+                throw DataFormatException("历史文件格式无效: " + path);
+            }
+            // 只读段头；段是否完整由长度判断，内容的校验和在读取该段时检查。
+            // 下一代的段属于没写成功的快照，从第一个这样的段起截掉；更晚的段说明快照不是写出这个文件的那一份，
+            // 因此先走完全部段头再决定是否截断
+            uint64_t pos = kHeaderSize;
+            uint64_t uncommitted = 0;
+            while (file.size() - pos >= sizeof(SegmentHeader)) {
+                SegmentHeader header;
+                std::memcpy(&header, base + pos, sizeof(header));
+                uint64_t length = sizeof(header) + uint64_t(header.filterBytes) + header.payloadBytes;
+                if ((header.kind != kRecordSegment && header.kind != kPurgeSegment) || file.size() - pos < length) break;
+                if (header.generation > committedGeneration + 1) {
+                    throw DataFormatException("历史文件与快照不匹配（段代号 " + std::to_string(header.generation) + "，快照代号 "
+                        + std::to_string(committedGeneration) + "）: " + path);
+                }
+                if (header.generation == committedGeneration + 1 && uncommitted == 0) uncommitted = pos;
+                if (uncommitted != 0) {
+                    pos += length;
+                    continue;
+                }
+                if (header.kind == kPurgeSegment) {
+                    const char* body = base + pos + sizeof(header) + header.filterBytes;
+                    if (header.payloadBytes < 1 || crc32(0, body, header.payloadBytes) != header.crc) break;
+                    std::string name(body + 1, header.payloadBytes - 1);
+                    auto& purged = static_cast<HistoryKey>(body[0]) == HistoryKey::Book ? purgedBooks : purgedReaders;
+                    purged[name] = segments.size();
+                }
+                segments.push_back({ pos, header.count, header.kind == kPurgeSegment });
+                if (header.kind == kRecordSegment) records += header.count;
+                pos += length;
+            }
+            validBytes = uncommitted != 0 ? uncommitted : pos;
+        }
+    }
+    fd = openFile(path);
+    if (fd < 0) throw std::runtime_error("无法打开历史文件: " + path);
+    if (validBytes == 0) {
+        char header[kHeaderSize] = {};
+        std::memcpy(header, kMagic, sizeof(kMagic));
+        std::memcpy(header + sizeof(kMagic), &kVersion, sizeof(kVersion));
+        truncateFile(fd, 0, path);
+        if (!writeAll(fd, header, sizeof(header)) || !syncDescriptor(fd)) throw std::runtime_error("写入历史文件失败: " + path);
+        validBytes = kHeaderSize;
+    } else {
+        // 截掉未提交的段和崩溃留下的残缺尾部
+        truncateFile(fd, validBytes, path);
+    }
+    bytes = validBytes;
+    remap();
+}
+
+std::string HistoryStore::moveAside(const std::string& filePath) {
+    std::error_code error;
+    uint64_t size = std::filesystem::file_size(filePath, error);
+    if (error || size <= kHeaderSize) return std::string();
+    std::string backup = filePath + ".bak";
+    for (int i = 1; std::filesystem::exists(backup); ++i) backup = filePath + ".bak." + std::to_string(i);
+    std::filesystem::rename(filePath, backup);
+    return backup;
+}
+
+void HistoryStore::close() {
+    mapping.reset();
+    if (fd >= 0) {
+#ifdef _WIN32
+        _close(fd);
+#else
+        ::close(fd);
+#endif
+    }
+    fd = -1;
+    bytes = 0;
+    records = 0;
+    segments.clear();
+    purgedBooks.clear();
+    purgedReaders.clear();
+}
+
+void HistoryStore::append(const std::vector<HistoryRecord>& batch, uint64_t generation) {
+    if (batch.empty()) return;
+    mapping.reset();
+    // 按读者、借阅时间排序后切段：同一读者的历史集中在少数几段里，借阅时间差分也更小
+    std::vector<const HistoryRecord*> order;
+    order.reserve(batch.size());
+    for (const HistoryRecord& record : batch) order.push_back(&record);
+    std::sort(order.begin(), order.end(), [](const HistoryRecord* a, const HistoryRecord* b) {
+        return a->reader != b->reader ? a->reader < b->reader : a->borrowDate < b->borrowDate;
+    });
+    std::string filter;
+    std::string payload;
+    std::string rows;
+    std::unordered_map<std::string_view, uint32_t> ids;
+    std::vector<std::string_view> names;
+    for (size_t begin = 0; begin < order.size(); begin += kSegmentRecords) {
+        size_t end = std::min(order.size(), begin + kSegmentRecords);
+        ids.clear();
+        names.clear();
+        rows.clear();
+        filter.clear();
+        auto idOf = [&](std::string_view name) {
+            auto [it, inserted] = ids.emplace(name, static_cast<uint32_t>(names.size()));
+            if (inserted) names.push_back(name);
+            return it->second;
+        };
+        int64_t previous = 0;
+        for (size_t i = begin; i < end; ++i) {
+            const HistoryRecord& record = *order[i];
+            varint::put(rows, idOf(record.book));
+            varint::put(rows, idOf(record.reader));
+            varint::putSigned(rows, record.borrowDate - previous);
+            varint::putSigned(rows, record.dueDate - record.borrowDate);
+            varint::putSigned(rows, record.returnDate - record.borrowDate);
+            previous = record.borrowDate;
+        }
+        payload.clear();
+        varint::put(payload, names.size());
+        for (std::string_view name : names) {
+            varint::put(payload, name.size());
+            payload.append(name);
+        }
+        payload.append(rows);
+
+        // 过滤器只收本段出现过的名称，书名和读者名用不同的种子区分
+        size_t filterBits = (names.size() * kFilterBitsPerKey + kFilterBlockBits - 1) / kFilterBlockBits * kFilterBlockBits;
+        filter.assign(filterBits / 8, '\0');
+        auto addKey = [&](uint64_t hash) {
+            forEachProbe(hash, filterBits, [&](uint64_t bit) { filter[bit >> 3] |= static_cast<char>(1 << (bit & 7)); });
+        };
+        for (size_t i = begin; i < end; ++i) {
+            addKey(keyHash(HistoryKey::Book, order[i]->book));
+            if (i == begin || order[i]->reader != order[i - 1]->reader) addKey(keyHash(HistoryKey::Reader, order[i]->reader));
+        }
+        writeSegment(kRecordSegment, static_cast<uint32_t>(end - begin), generation, filter, payload);
+        records += end - begin;
+    }
+    if (!syncDescriptor(fd)) throw std::runtime_error("写入历史文件失败: " + path);
+    remap();
+}
+
+void HistoryStore::purge(HistoryKey key, std::string_view name, uint64_t generation) {
+    if (records == 0) return;
+    std::string payload;
+    payload.push_back(static_cast<char>(key));
+    payload.append(name);
+    auto& purged = key == HistoryKey::Book ? purgedBooks : purgedReaders;
+    purged[std::string(name)] = segments.size();
+    mapping.reset();
+    writeSegment(kPurgeSegment, 0, generation, std::string(), payload);
+    if (!syncDescriptor(fd)) throw std::runtime_error("写入历史文件失败: " + path);
+    remap();
+}
+
+// 写入中途失败时文件尾部可能残留半段，因此即使 mark 等于当前大小也截断一次
+void HistoryStore::rollback(uint64_t mark) {
+    if (fd < 0 || mark > bytes) return;
+    while (!segments.empty() && segments.back().offset >= mark) {
+        if (!segments.back().isPurge) records -= segments.back().count;
+        segments.pop_back();
+    }
+    for (auto* purged : { &purgedBooks, &purgedReaders }) {
+        std::erase_if(*purged, [&](const auto& entry) { return entry.second >= segments.size(); });
+    }
+    mapping.reset();
+    truncateFile(fd, mark, path);
+    bytes = mark;
+    remap();
+}
+
+// 只在修改文件的路径上重新映射，查询在共享锁下直接读映射
+void HistoryStore::remap() {
+    mapping = std::make_unique<MappedFile>(path);
+    if (!mapping->isOpen() || mapping->size() < bytes) {
+        mapping.reset();
+        throw std::runtime_error("无法映射历史文件: " + path);
+    }
+}
+
+void HistoryStore::writeSegment(uint32_t kind, uint32_t count, uint64_t generation, const std::string& filter,
+    const std::string& payload) {
+    SegmentHeader header{ kind, count, generation, static_cast<uint32_t>(filter.size()), static_cast<uint32_t>(payload.size()), 0, 0 };
+    header.crc = crc32(crc32(0, filter.data(), filter.size()), payload.data(), payload.size());
+    std::string frame(reinterpret_cast<const char*>(&header), sizeof(header));
+    frame.append(filter);
+    frame.append(payload);
+    if (!writeAll(fd, frame.data(), frame.size())) throw std::runtime_error("写入历史文件失败: " + path);
+    segments.push_back({ bytes, count, kind == kPurgeSegment });
+    bytes += frame.size();
+}
+
+bool HistoryStore::isPurged(HistoryKey key, std::string_view name, size_t segment) const {
+    const auto& purged = key == HistoryKey::Book ? purgedBooks : purgedReaders;
+    if (purged.empty()) return false;
+    auto it = purged.find(name);
+    return it != purged.end() && segment < it->second;
+}
+
+size_t HistoryStore::forEach(HistoryKey key, std::string_view name, const std::function<void(const HistoryRecord&)>& visit) const {
+    return scan(&key, name, visit);
+}
+
+size_t HistoryStore::forEach(const std::function<void(const HistoryRecord&)>& visit) const {
+    return scan(nullptr, std::string_view(), visit);
+}
+
+size_t HistoryStore::scan(const HistoryKey* key, std::string_view name, const std::function<void(const HistoryRecord&)>& visit) const {
+    if (records == 0) return 0;
+    if (!mapping) throw DataFormatException("历史文件未映射: " + path);
+    const MappedFile& file = *mapping;
+    uint64_t hash = key ? keyHash(*key, name) : 0;
+    std::vector<std::string_view> names;
+    size_t visited = 0;
+    for (size_t s = 0; s < segments.size(); ++s) {
+        const Segment& segment = segments[s];
+        if (segment.isPurge) continue;
+        if (key && isPurged(*key, name, s)) continue;
+        SegmentHeader header;
+        std::memcpy(&header, file.begin() + segment.offset, sizeof(header));
+        const char* filter = file.begin() + segment.offset + sizeof(header);
+        if (key && !filterContains(filter, header.filterBytes, hash)) continue;
+        const char* body = filter + header.filterBytes;
+        // 字典解码带越界检查，先确认名称在本段再校验整段，过滤器误判的段不必计算校验和
+        varint::Reader in(body, header.payloadBytes);
+        uint64_t nameCount = in.next();
+        if (nameCount > header.payloadBytes) throw DataFormatException("历史文件已损坏: 字典大小越界");
+        names.resize(nameCount);
+        uint64_t target = names.size();
+        for (size_t i = 0; i < names.size(); ++i) {
+            names[i] = in.bytes(in.next());
+            if (key && names[i] == name) target = i;
+        }
+        if (key && target == names.size()) continue;
+        if (crc32(crc32(0, filter, header.filterBytes), body, header.payloadBytes) != header.crc) {
+            throw DataFormatException("历史文件已损坏: 校验和不匹配");
+        }
+        int64_t previous = 0;
+        bool matched = false;
+        for (uint32_t i = 0; i < header.count; ++i) {
+            uint64_t book = in.next();
+            uint64_t reader = in.next();
+            if (book >= names.size() || reader >= names.size()) throw DataFormatException("历史文件已损坏: 名称编号越界");
+            HistoryRecord record;
+            record.book = names[book];
+            record.reader = names[reader];
+            record.borrowDate = previous + in.nextSigned();
+            record.dueDate = record.borrowDate + in.nextSigned();
+            record.returnDate = record.borrowDate + in.nextSigned();
+            previous = record.borrowDate;
+            if (key && (*key == HistoryKey::Book ? book : reader) != target) {
+                // 段内按读者排序，该读者的记录读完即可结束本段
+                if (matched && *key == HistoryKey::Reader) break;
+                continue;
+            }
+            matched = true;
+            if (isPurged(HistoryKey::Book, record.book, s) || isPurged(HistoryKey::Reader, record.reader, s)) continue;
+            visit(record);
+            ++visited;
+        }
+    }
+    return visited;
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "MappedFile.h"
+#include "StringHash.h"
+
+// 历史层中的一条已归还记录；书名和读者姓名指向解码缓冲区，只在回调期间有效
+struct HistoryRecord {
+    std::string_view book;
+    std::string_view reader;
+    std::time_t borrowDate;
+    std::time_t dueDate;
+    std::time_t returnDate;
+};
+
+enum class HistoryKey : uint8_t { Book = 0, Reader = 1 };
+
+// 冷数据层：归还已久的借阅记录按段追加到磁盘文件，内存中只保留各段的位置。
+// 每批记录按读者排序后切段，每段带书名 / 读者名的布隆过滤器，段内用本段字典 + 变长整数差分编码；
+// 文件整体映射，查询先查过滤器再解码命中的段，不在内存中保留记录。
+// 每段记录所属的快照代号，打开时截掉代号为已提交快照的下一代的段（这些记录仍在快照中），
+// 因此"追加历史段 → 写快照"中途崩溃不会造成记录重复或丢失。
+// 删除图书 / 读者时追加一条清除标记，之前各段中该名称的记录在读取时跳过。
+class HistoryStore {
+public:
+    HistoryStore() = default;
+    ~HistoryStore();
+    HistoryStore(const HistoryStore&) = delete;
+    HistoryStore& operator=(const HistoryStore&) = delete;
+
+    // 文件不存在时新建；文件头无效，或有段的代号比已提交快照的下一代还晚（文件与快照不配套）时
+    // 抛出 DataFormatException，此时不修改文件
+    void open(const std::string& path, uint64_t committedGeneration);
+    // 没有可用的快照时无法判断哪些段已提交：有记录的历史文件改名为 path.bak（已存在时加序号）保留，
+    // 返回新文件名；文件不存在或没有任何段时不动，返回空串
+    static std::string moveAside(const std::string& path);
+    void close();
+    bool isOpen() const { return fd >= 0; }
+
+    // 追加一批记录并刷盘；快照写入失败时用 rollback 截回追加前的 fileSize()
+    void append(const std::vector<HistoryRecord>& records, uint64_t generation);
+    void purge(HistoryKey key, std::string_view name, uint64_t generation);
+    void rollback(uint64_t bytes);
+
+    // 按书名或读者姓名流式读取，返回读到的条数
+    size_t forEach(HistoryKey key, std::string_view name, const std::function<void(const HistoryRecord&)>& visit) const;
+    size_t forEach(const std::function<void(const HistoryRecord&)>& visit) const;
+
+    size_t recordCount() const { return records; }
+    size_t segmentCount() const { return segments.size(); }
+    uint64_t fileSize() const { return bytes; }
+
+private:
+    struct Segment {
+        uint64_t offset;
+        uint32_t count;
+        bool isPurge;
+    };
+
+    void writeSegment(uint32_t kind, uint32_t count, uint64_t generation, const std::string& filter, const std::string& payload);
+    size_t scan(const HistoryKey* key, std::string_view name, const std::function<void(const HistoryRecord&)>& visit) const;
+    // 清除标记之前的段中，该名称的记录视为已删除
+    bool isPurged(HistoryKey key, std::string_view name, size_t segment) const;
+    void remap();
+
+    std::string path;
+    int fd = -1;
+    std::unique_ptr<MappedFile> mapping;
+    uint64_t bytes = 0;
+    size_t records = 0;
+    std::vector<Segment> segments;
+    // 名称 -> 最后一条清除标记所在的段号
+    StringMap<size_t> purgedBooks;
+    StringMap<size_t> purgedReaders;
+};
\ No newline at end of file
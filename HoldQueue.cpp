@@ -0,0 +1,189 @@
+#include "HoldQueue.h"
+#include "Reader.h"
+
+uint8_t HoldQueue::rankOf(const Reader* reader) {
+    switch (reader->getTier()) {
+        case MemberTier::VIP: return 0;
+        case MemberTier::Student: return 1;
+        default: return 2;
+    }
+}
+
+uint32_t HoldQueue::find(const Book* book, const Reader* reader) const {
+    auto it = byKey.find({ book, reader });
+    return it != byKey.end() ? it->second : npos;
+}
+
+uint32_t HoldQueue::place(Book* book, Reader* reader, std::time_t placed) {
+    uint32_t id;
+    if (!freeSlots.empty()) {
+        id = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        id = static_cast<uint32_t>(holds.size());
+        holds.emplace_back();
+    }
+    Hold& hold = holds[id];
+    hold = Hold{ book, reader, placed, 0, CopySet::kNone, rankOf(reader), npos, npos };
+    Queue& queue = queues[book];
+    uint32_t& tail = queue.tail[hold.rank];
+    hold.prev = tail;
+    if (tail != npos) {
+        holds[tail].next = id;
+    } else {
+        queue.head[hold.rank] = id;
+    }
+    tail = id;
+    ++queue.waiting[hold.rank];
+    byKey.emplace(std::make_pair(book, reader), id);
+    return id;
+}
+
+uint32_t HoldQueue::assign(const Book* book, uint32_t copy, std::time_t deadline) {
+    auto it = queues.find(book);
+    if (it == queues.end()) return npos;
+    Queue& queue = it->second;
+    for (size_t rank = 0; rank < kRanks; ++rank) {
+        uint32_t id = queue.head[rank];
+        if (id == npos) continue;
+        unlinkWaiting(queue, id);
+        linkReady(queue, id, copy, deadline);
+        return id;
+    }
+    return npos;
+}
+
+void HoldQueue::markReady(uint32_t id, uint32_t copy, std::time_t deadline) {
+    Queue& queue = queues[holds[id].book];
+    unlinkWaiting(queue, id);
+    linkReady(queue, id, copy, deadline);
+}
+
+void HoldQueue::remove(uint32_t id) {
+    Hold& hold = holds[id];
+    auto it = queues.find(hold.book);
+    Queue& queue = it->second;
+    if (hold.isReady()) {
+        if (hold.prev != npos) {
+            holds[hold.prev].next = hold.next;
+        } else {
+            queue.ready = hold.next;
+        }
+        if (hold.next != npos) holds[hold.next].prev = hold.prev;
+        --queue.readyCount;
+        --readyHolds;
+        wheel.cancel(id);
+    } else {
+        unlinkWaiting(queue, id);
+    }
+    byKey.erase({ hold.book, hold.reader });
+    if (queue.empty()) queues.erase(it);
+    hold = Hold{};
+    freeSlots.push_back(id);
+}
+
+void HoldQueue::removeBook(const Book* book) {
+    std::vector<uint32_t> ids;
+    forEachOf(book, [&](const Hold& hold) { ids.push_back(find(hold.book, hold.reader)); });
+    for (uint32_t id : ids) remove(id);
+}
+
+void HoldQueue::expire(std::time_t now, std::vector<uint32_t>& expired) {
+    wheel.advance(now, expired);
+}
+
+void HoldQueue::reschedule(uint32_t id) {
+    wheel.schedule(id, holds[id].deadline);
+}
+
+std::vector<uint32_t> HoldQueue::overdueOf(const Book* book, std::time_t now) const {
+    std::vector<uint32_t> overdue;
+    auto it = queues.find(book);
+    if (it == queues.end()) return overdue;
+    for (uint32_t id = it->second.ready; id != npos; id = holds[id].next) {
+        if (holds[id].deadline <= now) overdue.push_back(id);
+    }
+    return overdue;
+}
+
+size_t HoldQueue::waitingCount(const Book* book) const {
+    auto it = queues.find(book);
+    if (it == queues.end()) return 0;
+    const Queue& queue = it->second;
+    return queue.waiting[0] + queue.waiting[1] + queue.waiting[2];
+}
+
+size_t HoldQueue::readyCount(const Book* book) const {
+    auto it = queues.find(book);
+    return it != queues.end() ? it->second.readyCount : 0;
+}
+
+size_t HoldQueue::aheadOf(uint32_t id) const {
+    const Hold& hold = holds[id];
+    if (hold.isReady()) return 0;
+    const Queue& queue = queues.at(hold.book);
+    size_t ahead = 0;
+    for (size_t rank = 0; rank < hold.rank; ++rank) ahead += queue.waiting[rank];
+    for (uint32_t other = queue.head[hold.rank]; other != id; other = holds[other].next) ++ahead;
+    return ahead;
+}
+
+std::vector<uint32_t> HoldQueue::holdsOf(const Reader* reader) const {
+    std::vector<uint32_t> ids;
+    for (const auto& [key, id] : byKey) {
+        if (key.second == reader) ids.push_back(id);
+    }
+    return ids;
+}
+
+void HoldQueue::forEach(const std::function<void(const Hold&)>& visit) const {
+    for (const auto& entry : queues) forEachOf(entry.first, visit);
+}
+
+void HoldQueue::forEachOf(const Book* book, const std::function<void(const Hold&)>& visit) const {
+    auto it = queues.find(book);
+    if (it == queues.end()) return;
+    const Queue& queue = it->second;
+    for (uint32_t id = queue.ready; id != npos; id = holds[id].next) visit(holds[id]);
+    for (size_t rank = 0; rank < kRanks; ++rank) {
+        for (uint32_t id = queue.head[rank]; id != npos; id = holds[id].next) visit(holds[id]);
+    }
+}
+
+void HoldQueue::clear() {
+    holds.clear();
+    freeSlots.clear();
+    queues.clear();
+    byKey.clear();
+    wheel.clear();
+    readyHolds = 0;
+}
+
+void HoldQueue::unlinkWaiting(Queue& queue, uint32_t id) {
+    Hold& hold = holds[id];
+    if (hold.prev != npos) {
+        holds[hold.prev].next = hold.next;
+    } else {
+        queue.head[hold.rank] = hold.next;
+    }
+    if (hold.next != npos) {
+        holds[hold.next].prev = hold.prev;
+    } else {
+        queue.tail[hold.rank] = hold.prev;
+    }
+    hold.prev = hold.next = npos;
+    --queue.waiting[hold.rank];
+}
+
+void HoldQueue::linkReady(Queue& queue, uint32_t id, uint32_t copy, std::time_t deadline) {
+    Hold& hold = holds[id];
+    hold.copy = copy;
+    hold.deadline = wheel.roundUp(deadline);
+    hold.prev = npos;
+    hold.next = queue.ready;
+    if (queue.ready != npos) holds[queue.ready].prev = id;
+    queue.ready = id;
+    ++queue.readyCount;
+    ++readyHolds;
+    wheel.schedule(id, hold.deadline);
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "CopySet.h"
+#include "TimingWheel.h"
+
+class Book;
+class Reader;
+
+// 一条预约：deadline 为 0 表示仍在排队，否则已为该读者保留 copy 号副本，须在 deadline 前借走
+struct Hold {
+    Book* book = nullptr;
+    Reader* reader = nullptr;
+    std::time_t placed = 0;
+    std::time_t deadline = 0;
+    uint32_t copy = CopySet::kNone;
+    uint8_t rank = 0;  // 优先级，0 最高：VIP 会员、学生会员、普通会员
+    uint32_t prev = 0;
+    uint32_t next = 0;
+
+    bool isReady() const { return deadline != 0; }
+};
+
+// 各书名的预约队列。每个书名按优先级分三条先进先出的链表，另有一条已保留（待取书）的链表；
+// 预约存放在槽位可复用的数组中，以下标相连，排队、取消、把归还的副本交给队首读者都是 O(1)。
+// 取书期限登记在时间轮上，按小时取整。修改和读取由调用方加锁
+class HoldQueue {
+public:
+    static constexpr uint32_t npos = UINT32_MAX;
+    static constexpr size_t kRanks = 3;
+    static constexpr int kPickupDays = 3;
+
+    static uint8_t rankOf(const Reader* reader);
+
+    // 该读者对该书的预约编号，没有时返回 npos
+    uint32_t find(const Book* book, const Reader* reader) const;
+    const Hold& operator[](uint32_t id) const { return holds[id]; }
+    size_t size() const { return byKey.size(); }
+    size_t readyTotal() const { return readyHolds; }
+
+    // 排到同优先级队尾，返回编号；同一读者对同一书名只能有一条预约，由调用方检查
+    uint32_t place(Book* book, Reader* reader, std::time_t placed);
+    // 把 copy 号副本保留给该书优先级最高的排队读者，取书期限为 deadline 向上取整到整点；没有排队读者时返回 npos
+    uint32_t assign(const Book* book, uint32_t copy, std::time_t deadline);
+    // 把排队中的指定预约转为已保留（加载数据时按保存的状态恢复）
+    void markReady(uint32_t id, uint32_t copy, std::time_t deadline);
+    // 取书、取消或过期后移出队列和时间轮，槽位留待复用
+    void remove(uint32_t id);
+    // 删除图书时丢弃该书的全部预约
+    void removeBook(const Book* book);
+
+    // 推进时间轮：取书期限已过的保留编号追加到 expired。它们仍在表中，由调用方在持有该书的锁后
+    // 按 overdueOf 的结果逐个移除并转交副本
+    void expire(std::time_t now, std::vector<uint32_t>& expired);
+    // 已由 expire 取出但未能移除的保留重新登记，在下一刻度再次取出（已登记的只是改期）
+    void reschedule(uint32_t id);
+    std::time_t nextCheck() const { return wheel.nextCheck(); }
+    // 该书取书期限不晚于 now 的保留（遍历保留链表，条数不超过副本数）
+    std::vector<uint32_t> overdueOf(const Book* book, std::time_t now) const;
+
+    size_t waitingCount(const Book* book) const;
+    size_t readyCount(const Book* book) const;
+    // 排队中的预约前面还有几人，已保留的返回 0（沿同级链表数过去，只用于显示）
+    size_t aheadOf(uint32_t id) const;
+    // 该读者的全部预约（遍历整个表，只在删除读者和显示时使用）
+    std::vector<uint32_t> holdsOf(const Reader* reader) const;
+    // 逐个书名访问：先是已保留的，再按优先级和排队顺序访问排队中的。按此顺序重新 place 即可恢复队列
+    void forEach(const std::function<void(const Hold&)>& visit) const;
+    void forEachOf(const Book* book, const std::function<void(const Hold&)>& visit) const;
+    void clear();
+
+private:
+    struct Queue {
+        uint32_t head[kRanks] = { npos, npos, npos };
+        uint32_t tail[kRanks] = { npos, npos, npos };
+        uint32_t waiting[kRanks] = {};
+        uint32_t ready = npos;  // 已保留链表的表头，无序
+        uint32_t readyCount = 0;
+
+        bool empty() const { return waiting[0] + waiting[1] + waiting[2] + readyCount == 0; }
+    };
+    struct KeyHash {
+        size_t operator()(const std::pair<const Book*, const Reader*>& key) const {
+            return std::hash<const void*>()(key.first) * 31 + std::hash<const void*>()(key.second);
+        }
+    };
+
+    void unlinkWaiting(Queue& queue, uint32_t id);
+    void linkReady(Queue& queue, uint32_t id, uint32_t copy, std::time_t deadline);
+
+    std::vector<Hold> holds;
+    std::vector<uint32_t> freeSlots;
+    std::unordered_map<const Book*, Queue> queues;
+    std::unordered_map<std::pair<const Book*, const Reader*>, uint32_t, KeyHash> byKey;
+    TimingWheel wheel;
+    size_t readyHolds = 0;
+};
\ No newline at end of file
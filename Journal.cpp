@@ -0,0 +1,233 @@
+#include "Journal.h"
+#include "Crc32.h"
+#include "Exceptions.h"
+#include "FileSync.h"
+#include "MappedFile.h"
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <stdexcept>
+#ifdef _WIN32
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+    constexpr char kMagic[8] = { 'L', 'I', 'B', 'J', 'R', 'N', 'L', '\0' };
+    constexpr size_t kHeaderSize = sizeof(kMagic) + sizeof(uint64_t);
+    constexpr size_t kFrameSize = 2 * sizeof(uint32_t);  // 长度 + CRC32
+
+    // 把文件截到 size 字节，之后的写入从末尾接着写
+    bool truncateFile(int fd, uint64_t size) {
+#ifdef _WIN32
+        bool ok = _chsize_s(fd, static_cast<long long>(size)) == 0;
+        _lseeki64(fd, static_cast<long long>(size), SEEK_SET);
+#else
+        bool ok = ::ftruncate(fd, static_cast<off_t>(size)) == 0;
+        ::lseek(fd, static_cast<off_t>(size), SEEK_SET);
+#endif
+        return ok;
+    }
+}
+
+JournalEntry& JournalEntry::putString(std::string_view value) {
+    uint32_t length = static_cast<uint32_t>(value.size());
+    data.append(reinterpret_cast<const char*>(&length), sizeof(length));
+    data.append(value);
+    return *this;
+}
+
+JournalEntry& JournalEntry::putInt(int64_t value) {
+    data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    return *this;
+}
+
+JournalEntry& JournalEntry::putDouble(double value) {
+    data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    return *this;
+}
+
+JournalEntry& JournalEntry::putByte(uint8_t value) {
+    data.push_back(static_cast<char>(value));
+    return *this;
+}
+
+void JournalEntry::take(void* out, size_t bytes) {
+    if (data.size() - cursor < bytes) throw DataFormatException("日志记录已损坏: 字段不完整");
+    std::memcpy(out, data.data() + cursor, bytes);
+    cursor += bytes;
+}
+
+std::string JournalEntry::getString() {
+    uint32_t length;
+    take(&length, sizeof(length));
+    if (data.size() - cursor < length) throw DataFormatException("日志记录已损坏: 字符串不完整");
+    std::string value = data.substr(cursor, length);
+    cursor += length;
+    return value;
+}
+
+int64_t JournalEntry::getInt() {
+    int64_t value;
+    take(&value, sizeof(value));
+    return value;
+}
+
+double JournalEntry::getDouble() {
+    double value;
+    take(&value, sizeof(value));
+    return value;
+}
+
+uint8_t JournalEntry::getByte() {
+    uint8_t value;
+    take(&value, sizeof(value));
+    return value;
+}
+
+uint64_t Journal::replay(const std::string& path, uint64_t generation,
+    const std::function<void(JournalEntry&)>& apply) {
+    MappedFile file(path);
+    if (!file.isOpen() || file.size() < kHeaderSize) return 0;
+    const char* base = file.begin();
+    uint64_t fileGeneration;
+    std::memcpy(&fileGeneration, base + sizeof(kMagic), sizeof(fileGeneration));
+    if (std::memcmp(base, kMagic, sizeof(kMagic)) != 0 || fileGeneration != generation) return 0;
+
+    size_t pos = kHeaderSize;
+    while (file.size() - pos >= kFrameSize) {
+        uint32_t length, crc;
+        std::memcpy(&length, base + pos, sizeof(length));
+        std::memcpy(&crc, base + pos + sizeof(length), sizeof(crc));
+        const char* body = base + pos + kFrameSize;
+        if (length == 0 || file.size() - pos - kFrameSize < length || crc32(0, body, length) != crc) break;
+        JournalEntry entry(static_cast<JournalOp>(body[0]), std::string_view(body + 1, length - 1));
+        apply(entry);
+        pos += kFrameSize + length;
+    }
+    return pos;
+}
+
+Journal::Journal(const std::string& path, uint64_t generation, uint64_t validBytes, JournalOptions options)
+    : path(path), options(options) {
+#ifdef _WIN32
+    fd = _open(path.c_str(), _O_RDWR | _O_CREAT | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+#endif
+    if (fd < 0) throw std::runtime_error("无法打开日志文件: " + path);
+    // 截掉崩溃时写了一半的尾部记录；没有可用内容时（包括代号与快照不符的旧日志）整个清空，
+    // 只覆盖文件头会让旧代号的记录在下次启动时按新代号重放
+    if (validBytes < kHeaderSize) validBytes = 0;
+    if (!truncateFile(fd, validBytes)) throw std::runtime_error("无法截断日志文件: " + path);
+    if (validBytes == 0) {
+        std::unique_lock<std::mutex> lock(mutex);
+        writeHeader(generation, lock);
+    } else {
+        bytes = validBytes;
+    }
+    if (options.policy == FsyncPolicy::Timer) timer = std::thread(&Journal::timerLoop, this);
+}
+
+Journal::~Journal() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeup.notify_all();
+    if (timer.joinable()) timer.join();
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!syncTo(lock, written)) std::cerr << "\033[1;31m[错误] 日志刷盘失败: " << path << "\033[0m\n";
+    }
+#ifdef _WIN32
+    _close(fd);
+#else
+    ::close(fd);
+#endif
+}
+
+void Journal::append(const JournalEntry& entry) {
+    // 帧头、操作类型和负载拼成一次 write
+    uint32_t length = static_cast<uint32_t>(entry.payload().size() + 1);
+    std::string frame;
+    frame.reserve(kFrameSize + length);
+    frame.append(kFrameSize, '\0');
+    frame.push_back(static_cast<char>(entry.op()));
+    frame.append(entry.payload());
+    uint32_t crc = crc32(0, frame.data() + kFrameSize, length);
+    std::memcpy(&frame[0], &length, sizeof(length));
+    std::memcpy(&frame[sizeof(length)], &crc, sizeof(crc));
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!writeAll(fd, frame.data(), frame.size())) {
+        // 去掉写了一半的记录，否则重放停在这里，之后追加的记录全部丢失
+        truncateFile(fd, bytes);
+        throw std::runtime_error("写入日志失败: " + path);
+    }
+    bytes += frame.size();
+    ++written;
+    // 记录已在文件中，重放时会生效，调用方照常修改状态；刷盘失败只报告，由之后的刷盘重试
+    if (options.policy == FsyncPolicy::PerOperation
+        || (options.policy == FsyncPolicy::Batched && written - synced >= options.batchSize)) {
+        if (!syncTo(lock, written)) std::cerr << "\033[1;31m[错误] 日志刷盘失败: " << path << "\033[0m\n";
+    }
+}
+
+void Journal::sync() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!syncTo(lock, written)) throw std::runtime_error("日志刷盘失败: " + path);
+}
+
+void Journal::reset(uint64_t newGeneration) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!truncateFile(fd, 0)) throw std::runtime_error("无法清空日志文件: " + path);
+    bytes = 0;
+    writeHeader(newGeneration, lock);
+}
+
+uint64_t Journal::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return bytes;
+}
+
+void Journal::writeHeader(uint64_t gen, std::unique_lock<std::mutex>& lock) {
+    char header[kHeaderSize];
+    std::memcpy(header, kMagic, sizeof(kMagic));
+    std::memcpy(header + sizeof(kMagic), &gen, sizeof(gen));
+    if (!writeAll(fd, header, sizeof(header))) throw std::runtime_error("写入日志失败: " + path);
+    bytes = kHeaderSize;
+    ++written;
+    if (!syncTo(lock, written)) throw std::runtime_error("日志刷盘失败: " + path);
+}
+
+// 同一时刻只有一个线程在刷盘：先记下此刻的写入次数，释放锁后 fsync，期间的追加由下一次刷盘覆盖；
+// 其他线程等它完成，已覆盖到自己的写入时直接返回。失败时计数不前进，后续调用重新刷盘
+bool Journal::syncTo(std::unique_lock<std::mutex>& lock, uint64_t target) {
+    while (synced < target) {
+        if (syncing) {
+            syncDone.wait(lock);
+            continue;
+        }
+        syncing = true;
+        uint64_t covered = written;
+        lock.unlock();
+        bool ok = syncDescriptor(fd);
+        lock.lock();
+        syncing = false;
+        if (ok) synced = covered;
+        syncDone.notify_all();
+        if (!ok) return false;
+    }
+    return true;
+}
+
+void Journal::timerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        wakeup.wait_for(lock, options.interval);
+        if (!syncTo(lock, written)) std::cerr << "\033[1;31m[错误] 日志刷盘失败: " << path << "\033[0m\n";
+    }
+}
\ No newline at end of file
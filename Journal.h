@@ -0,0 +1,109 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+// 日志操作类型
+enum class JournalOp : uint8_t {
+    AddBook = 1,
+    RemoveBook,
+    AddReader,
+    RemoveReader,
+    Borrow,
+    Return,
+    PayFine,
+    AddUser,
+    DeleteUser,
+    PlaceHold,
+    CancelHold,
+    ExpireHold,
+};
+
+// 刷盘策略：每次操作、每 N 次操作、或后台定时
+enum class FsyncPolicy { PerOperation, Batched, Timer };
+
+struct JournalOptions {
+    FsyncPolicy policy = FsyncPolicy::Batched;
+    size_t batchSize = 32;
+    std::chrono::milliseconds interval{ 1000 };
+    // 日志超过该大小时在退出前做一次快照并清空日志
+    uint64_t checkpointBytes = 64ull * 1024 * 1024;
+};
+
+// 一条日志：操作类型 + 紧凑的二进制负载
+class JournalEntry {
+public:
+    explicit JournalEntry(JournalOp op) : operation(op) {}
+    JournalEntry(JournalOp op, std::string_view payload) : operation(op), data(payload) {}
+
+    JournalOp op() const { return operation; }
+    const std::string& payload() const { return data; }
+
+    JournalEntry& putString(std::string_view value);
+    JournalEntry& putInt(int64_t value);
+    JournalEntry& putDouble(double value);
+    JournalEntry& putByte(uint8_t value);
+
+    // 按写入顺序读取字段，数据不足时抛出 DataFormatException
+    std::string getString();
+    int64_t getInt();
+    double getDouble();
+    uint8_t getByte();
+    // 字段已全部读完；较早写入的记录缺少后来追加的字段时据此取默认值
+    bool atEnd() const { return cursor >= data.size(); }
+
+private:
+    void take(void* out, size_t bytes);
+
+    JournalOp operation;
+    std::string data;
+    size_t cursor = 0;
+};
+
+// 只追加的操作日志（预写日志）。
+// 文件头记录所基于的快照代号，代号不一致的日志在启动时被丢弃；
+// 每条记录带长度和 CRC32，崩溃留下的残缺尾部在重放时截掉。
+// fsync 在锁外进行，刷盘期间其他线程照常追加。
+// append 写入失败时截掉写了一半的记录并抛出异常，调用方先写日志、成功后再修改状态；
+// 记录写入后刷盘失败只输出错误（记录重放时仍会生效），由之后的刷盘重试；sync 刷盘失败时抛出异常。
+class Journal {
+public:
+    // 重放与快照代号匹配的日志，返回有效内容的字节数（无可用日志时为 0）
+    static uint64_t replay(const std::string& path, uint64_t generation,
+        const std::function<void(JournalEntry&)>& apply);
+
+    Journal(const std::string& path, uint64_t generation, uint64_t validBytes, JournalOptions options);
+    ~Journal();
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    void append(const JournalEntry& entry);
+    void sync();
+    // 快照完成后清空日志并切换到新的代号
+    void reset(uint64_t newGeneration);
+    uint64_t size() const;
+
+private:
+    void writeHeader(uint64_t gen, std::unique_lock<std::mutex>& lock);
+    // 确保前 target 次写入已刷盘，失败返回 false；调用时持有 lock，刷盘期间释放
+    bool syncTo(std::unique_lock<std::mutex>& lock, uint64_t target);
+    void timerLoop();
+
+    std::string path;
+    JournalOptions options;
+    int fd = -1;
+    uint64_t bytes = 0;
+    uint64_t written = 0;  // 累计写入次数（含文件头）
+    uint64_t synced = 0;   // 其中已刷盘的次数
+    bool syncing = false;  // 有线程正在锁外刷盘
+    bool stopping = false;
+    mutable std::mutex mutex;
+    std::condition_variable wakeup;
+    std::condition_variable syncDone;
+    std::thread timer;
+};
\ No newline at end of file
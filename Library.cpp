@@ -5,21 +5,144 @@
 #include <numeric>
 #include <algorithm>
 #include <iomanip>
+#include <limits>
+#include "LoanArchive.h"
+#include "MappedFile.h"
+#include "TextParsing.h"
+#include "ThreadPool.h"
+
+namespace {
+    const char* const kSnapshotFile = "library.snap";
+    const char* const kJournalFile = "library.journal";
+    const char* const kHistoryFile = "library.history";
+    // records.txt 的列式压缩版本（LoanArchive），导入时优先读取
+    const char* const kRecordArchiveFile = "records.lar";
+    const char* const kFinePolicyFile = "fine_policy.txt";
+    const char* const kFineReportFile = "fine_report.txt";
+    const char* const kHoldFile = "holds.txt";
+
+    Book* createBook(BookPool& pool, BookCategory category, const std::string& type, const std::string& title,
+        const std::string& author) {
+        switch (category) {
+            case BookCategory::Textbook: return pool.create<Textbook>(title, author);
+            case BookCategory::Novel: return pool.create<Novel>(title, author);
+            case BookCategory::Magazine: return pool.create<Magazine>(title, author);
+            default: return pool.create<Book>(title, author, type);
+        }
+    }
+
+    Book* createBook(BookPool& pool, const std::string& type, const std::string& title, const std::string& author) {
+        return createBook(pool, categoryFromName(type), type, title, author);
+    }
+
+    // 加载时为未还的借阅占用副本：指定的副本不在架（旧数据没有副本编号或数据不一致）时改占其他在架副本，
+    // 都不在架时补一册
+    uint32_t claimCopy(Book* book, uint32_t copy) {
+        if (book->borrowCopy(copy)) return copy;
+        copy = book->borrowCopy();
+        if (copy != CopySet::kNone) return copy;
+        book->addCopies(1);
+        return book->borrowCopy();
+    }
+
+    // 单册图书显示 可借阅 / 已借出，多册时附上在架册数
+    std::string availabilityText(const Book* book) {
+        std::string text = book->isBorrowedStatus() ? "\033[1;31m已借出\033[0m" : "\033[1;32m可借阅\033[0m";
+        if (book->getCopyCount() > 1) {
+            text += "（在架 " + std::to_string(book->getAvailableCopies()) + " / " + std::to_string(book->getCopyCount()) + " 册）";
+        }
+        return text;
+    }
+
+    Reader* createReader(ReaderPool& pool, MemberTier tier, const std::string& name) {
+        switch (tier) {
+            case MemberTier::VIP: return pool.create<VIPMember>(name);
+            case MemberTier::Student: return pool.create<StudentMember>(name);
+            default: return pool.create<RegularMember>(name);
+        }
+    }
+
+    void printSuggestions(const std::vector<FuzzyMatch>& matches) {
+        if (matches.empty()) return;
+        std::cout << "\033[1;33m您是不是要找：\033[0m\n";
+        for (const FuzzyMatch& match : matches) {
+            std::cout << "  " << match.key.view() << "（相差 " << match.distance << " 个字）\n";
+        }
+    }
+
+    // 菜单层：把借阅 / 归还 / 支付的结果格式化输出
+    void printOperationResult(const OperationResult& result) {
+        switch (result.status) {
+            case OperationStatus::Borrowed:
+                if (result.outstandingFine > 0) {
+                    std::cout << "\033[1;33m警告: 该读者有未支付的罚款 " << result.outstandingFine << " 元，可能影响借阅权限\033[0m\n";
+                }
+                if (result.copyCount > 1) std::cout << "📖 借出第 " << result.copy + 1 << " 册（共 " << result.copyCount << " 册）\n";
+                char dueDate[DateUtils::kTimeTextSize];
+                DateUtils::formatTime(result.dueDate, dueDate, sizeof(dueDate));
+                std::cout << "📅 应还日期: " << dueDate << "\n";
+                break;
+            case OperationStatus::ReturnedOverdue:
+                std::cout << "⏰ 超期 " << result.overdueDays << " 天，";
+                std::cout << "图书类型: " << result.bookType << "，";
+                std::cout << "罚款标准: " << result.ratePerDay << "元/天，";
+                std::cout << "读者折扣: " << result.discount * 100 << "%，";
+                std::cout << "需缴纳罚款: \033[1;31m" << result.fine << "\033[0m 元。\n";
+                break;
+            case OperationStatus::ReturnedOnTime:
+                std::cout << "✅ 按时归还，感谢！\n";
+                break;
+            case OperationStatus::NoFineDue:
+                std::cout << "✅ 该读者没有未支付的罚款\n";
+                break;
+            case OperationStatus::FinePaidInFull:
+                if (result.amountCapped) {
+                    std::cout << "⚠️ 支付金额超过欠款，将支付全部欠款: " << result.amountPaid << " 元\n";
+                } else {
+                    std::cout << "✅ 已全额支付罚款: " << result.amountPaid << " 元\n";
+                }
+                break;
+            case OperationStatus::FinePaid:
+                std::cout << "✅ 已支付罚款: " << result.amountPaid << " 元，剩余欠款: " << result.outstandingFine << " 元\n";
+                break;
+            case OperationStatus::HoldPlaced:
+                std::cout << "✅ 预约成功，当前排在第 " << result.queuePosition << " 位。有副本归还时将为您保留 "
+                    << HoldQueue::kPickupDays << " 天\n";
+                break;
+        }
+        if (!result.heldFor.empty()) {
+            char deadline[DateUtils::kTimeTextSize];
+            DateUtils::formatTime(result.holdDeadline, deadline, sizeof(deadline));
+            std::cout << "📌 该册已为预约读者 " << result.heldFor << " 保留，取书期限: " << deadline << "\n";
+        }
+    }
+
+    MemberTier checkedTier(uint8_t value) {
+        if (value >= static_cast<uint8_t>(MemberTier::Count)) throw DataFormatException("未知的会员类型: " + std::to_string(value));
+        return static_cast<MemberTier>(value);
+    }
+}
 
 // 构造函数
-Library::Library(double baseFinePerDay) : baseFinePerDay(baseFinePerDay) {
+Library::Library(double baseFinePerDay, JournalOptions journalOptions, int historyDays)
+    : historyDays(historyDays), baseFinePerDay(baseFinePerDay), journalOptions(journalOptions) {
+    loadFinePolicy();
     loadData();
     // 添加默认管理员
     if (findUser("admin") == nullptr) {
-        users.push_back(std::make_unique<Administrator>("admin", "admin123"));
+        addUser(userPool.create<Administrator>("admin", "admin123"));
     }
 }
 
 // 析构函数
 Library::~Library() {
-    saveData();
-    for (auto book : books) delete book;
-    for (auto reader : readers) delete reader;
+    // 修改已逐条写入日志，只有日志过大时才在退出前合并成新快照
+    try {
+        if (!journal || journal->size() >= journalOptions.checkpointBytes) saveData();
+    } catch (const std::exception& ex) {
+        std::cerr << "\033[1;31m[错误] 保存数据失败: " << ex.what() << "\033[0m\n";
+    }
+    journal.reset();
 }
 
 // 清除输入缓冲区
@@ -34,112 +157,325 @@ void Library::printSectionHeader(const std::string& title) {
 }
 
 // 图书管理
-void Library::addBook(Book* book) { books.push_back(book); }
+void Library::addBook(Book* book) {
+    std::unique_lock<std::shared_mutex> lock(catalogMutex);
+    std::time_t now = DateUtils::getCurrentTime();
+    JournalEntry entry(JournalOp::AddBook);
+    entry.putString(book->getType()).putString(book->getTitle()).putString(book->getAuthor()).putByte(0)
+        .putInt(book->getCopyCount()).putInt(now);
+    // 先确认能并入已有条目再记日志，之后的插入不会失败
+    Book* existing = findBook(book->getTitle());
+    if (existing && book->getCopyCount() > CopySet::kMaxCopies - existing->getCopyCount()) {
+        bookPool.destroy(book);
+        throw InvalidInputException("每种图书最多 " + std::to_string(CopySet::kMaxCopies) + " 册");
+    }
+    log(entry);
+    Book* added = insertBook(book).first;
+    std::lock_guard<std::mutex> holdLock(holdMutex);
+    offerCopies(added, now);
+}
 
+// 每个书名在目录中只有一个条目：同名图书已存在时新对象的副本并入已有条目，新对象随即回收
+std::pair<Book*, uint32_t> Library::insertBook(Book* book) {
+    Book* existing = findBook(book->getTitle());
+    if (!existing) {
+        books.push_back(book);
+        bookIndex.emplace(book->getTitleSymbol(), book);
+        if (!deferIndexes) {
+            searchIndex.add(book);
+            bookTitles.add(book->getTitleSymbol());
+        }
+        return { book, 0 };
+    }
+    uint32_t firstCopy = existing->getCopyCount();
+    try {
+        existing->addCopies(book->getCopyCount());
+    } catch (...) {
+        bookPool.destroy(book);
+        throw;
+    }
+    bookPool.destroy(book);
+    return { existing, firstCopy };
+}
+
+// 借出中的图书不能删除；删除后其历史借阅记录和预约一并清除，对象槽位回收复用
 void Library::removeBook(const std::string& title) {
-    auto it = std::remove_if(books.begin(), books.end(), 
-        [&](Book* b) { return b->getTitle() == title; });
-    if (it == books.end()) {
+    std::unique_lock<std::shared_mutex> lock(catalogMutex);
+    std::vector<Book*> removed;
+    auto key = Symbol::find(title);
+    for (Book* book : books) {
+        if (!key || book->getTitleSymbol() != *key) continue;
+        if (!recordIndex.openLoansOf(book).empty()) throw BookBorrowedException("图书尚有副本未归还，无法删除: " + title);
+        removed.push_back(book);
+    }
+    if (removed.empty()) {
         throw BookNotFoundException("未找到图书: " + title);
     }
-    books.erase(it, books.end());
+    log(JournalEntry(JournalOp::RemoveBook).putString(title));
+    auto isRemoved = [&](const Book* book) { return std::find(removed.begin(), removed.end(), book) != removed.end(); };
+    books.erase(std::remove_if(books.begin(), books.end(), isRemoved), books.end());
+    bookIndex.erase(*key);
+    purgeRecords([&](const BorrowRecord& record) { return isRemoved(record.getBook()); });
+    if (history.isOpen()) history.purge(HistoryKey::Book, title, journalGeneration + 1);
+    for (Book* book : removed) {
+        {
+            std::lock_guard<std::mutex> holdLock(holdMutex);
+            holds.removeBook(book);
+        }
+        searchIndex.remove(book);
+        bookTitles.remove(book->getTitleSymbol());
+        bookPool.destroy(book);
+    }
 }
 
 // 读者管理
-void Library::addReader(Reader* reader) { readers.push_back(reader); }
+void Library::addReader(Reader* reader) {
+    std::unique_lock<std::shared_mutex> lock(catalogMutex);
+    log(JournalEntry(JournalOp::AddReader).putByte(static_cast<uint8_t>(reader->getTier())).putString(reader->getName())
+        .putDouble(reader->getFine()));
+    readers.push_back(reader);
+    readerIndex.emplace(reader->getNameSymbol(), reader);
+    if (!deferIndexes) readerNames.add(reader->getNameSymbol());
+}
 
-void Library::removeReader(const std::string& name) {
-    auto it = std::remove_if(readers.begin(), readers.end(), 
-        [&](Reader* r) { return r->getName() == name; });
-    if (it == readers.end()) {
+// 有未还图书的读者不能删除；删除后其借阅记录、预约和绑定的读者账号一并清除
+void Library::removeReader(const std::string& name, std::time_t now) {
+    std::unique_lock<std::shared_mutex> lock(catalogMutex);
+    std::vector<Reader*> removed;
+    auto key = Symbol::find(name);
+    for (Reader* reader : readers) {
+        if (!key || reader->getNameSymbol() != *key) continue;
+        for (size_t pos : recordIndex.recordsOf(reader)) {
+            if (!borrowRecords.isReturned(pos)) throw InvalidInputException("读者仍有未归还的图书，无法删除: " + name);
+        }
+        removed.push_back(reader);
+    }
+    if (removed.empty()) {
         throw ReaderNotFoundException("未找到读者: " + name);
     }
-    readers.erase(it, readers.end());
+    log(JournalEntry(JournalOp::RemoveReader).putString(name).putInt(now));
+    auto isRemoved = [&](const Reader* reader) { return std::find(removed.begin(), removed.end(), reader) != removed.end(); };
+    readers.erase(std::remove_if(readers.begin(), readers.end(), isRemoved), readers.end());
+    readerIndex.erase(*key);
+    for (size_t i = 0; i < removed.size(); ++i) readerNames.remove(*key);
+    purgeRecords([&](const BorrowRecord& record) { return isRemoved(record.getReader()); });
+    if (history.isOpen()) history.purge(HistoryKey::Reader, name, journalGeneration + 1);
+    eraseUsers([&](const User* user) {
+        auto readerUser = dynamic_cast<const ReaderUser*>(user);
+        return readerUser && isRemoved(readerUser->getReader());
+    });
+    {
+        std::lock_guard<std::mutex> holdLock(holdMutex);
+        for (Reader* reader : removed) {
+            for (uint32_t id : holds.holdsOf(reader)) dropHold(id, now);
+        }
+    }
+    for (Reader* reader : removed) readerPool.destroy(reader);
 }
 
 // 借阅功能
-void Library::borrowBook(const std::string& bookTitle, const std::string& readerName) {
-    Book* book = findBook(bookTitle);
-    Reader* reader = findReader(readerName);
-    if (!book) throw BookNotFoundException("未找到图书: " + bookTitle);
-    if (!reader) throw ReaderNotFoundException("未找到读者: " + readerName);
-    if (book->isBorrowedStatus()) throw BookBorrowedException("图书已被借出: " + bookTitle);
-    if (reader->getFine() > 0) {
-        std::cout << "\033[1;33m警告: 该读者有未支付的罚款 " << reader->getFine() << " 元，可能影响借阅权限\033[0m\n";
-    }
-    book->borrow();
-    std::time_t now = DateUtils::getCurrentTime();
-    borrowRecords.emplace_back(book, reader, now, now + reader->getBorrowPeriod() * 24 * 60 * 60);
-    std::cout << "📅 应还日期: " << DateUtils::formatTime(borrowRecords.back().getDueDate()) << "\n";
+OperationResult Library::borrowBook(const std::string& bookTitle, const std::string& readerName) {
+    return metrics::track(MetricOp::Borrow, [&] {
+        std::shared_lock<std::shared_mutex> catalogLock(catalogMutex);
+        Book* book = findBook(bookTitle);
+        Reader* reader = findReader(readerName);
+        if (!book) throw BookNotFoundException("未找到图书: " + bookTitle);
+        if (!reader) throw ReaderNotFoundException("未找到读者: " + readerName);
+        rolloverAccounts(DateUtils::getCurrentTime());
+        expireHolds(DateUtils::getCurrentTime());
+        StripeGuard entityLock(entityLocks, book, reader);
+        // 为该读者保留的副本优先借出；其他读者只能借在架副本，有人排队时不会有在架副本
+        uint32_t holdId;
+        uint32_t heldCopy = CopySet::kNone;
+        {
+            std::lock_guard<std::mutex> holdLock(holdMutex);
+            holdId = holds.find(book, reader);
+            if (holdId != HoldQueue::npos && holds[holdId].isReady()) heldCopy = holds[holdId].copy;
+        }
+        if (heldCopy == CopySet::kNone && book->isBorrowedStatus()) throw BookBorrowedException("图书已全部借出: " + bookTitle);
+        // 在借数只在持有读者分片锁时变化，这里读到的值在借出前不会改变
+        int limit = FinePolicy::loanLimit(reader->getTier());
+        if (limit > 0 && reader->activeLoanCount() >= limit) {
+            throw LoanLimitException("已达到借阅上限 " + std::to_string(limit) + " 本: " + readerName);
+        }
+        // 持有该书和该读者的分片锁，上面确认的保留副本或在架副本这里一定能借到
+        uint32_t copy = heldCopy != CopySet::kNone ? heldCopy : book->borrowCopy();
+        std::time_t now = DateUtils::getCurrentTime();
+        std::time_t dueDate = now + reader->getBorrowPeriod() * 24 * 60 * 60;
+        // 先记日志再修改状态，写日志失败时放回刚借出的在架副本，其余状态未动。
+        // 同一图书 / 读者的日志顺序由分片锁保证
+        try {
+            log(JournalEntry(JournalOp::Borrow).putString(bookTitle).putString(readerName).putInt(now).putInt(dueDate).putInt(copy));
+        } catch (...) {
+            if (heldCopy == CopySet::kNone) book->returnCopy(copy);
+            throw;
+        }
+        if (holdId != HoldQueue::npos) {
+            std::lock_guard<std::mutex> holdLock(holdMutex);
+            holds.remove(holdId);
+        }
+        {
+            std::lock_guard<std::mutex> recordLock(recordMutex);
+            appendRecord(book, copy, reader, now, dueDate);
+        }
+        OperationResult result;
+        result.status = OperationStatus::Borrowed;
+        result.dueDate = dueDate;
+        result.copy = copy;
+        result.copyCount = book->getCopyCount();
+        result.bookType = book->getType();
+        result.outstandingFine = reader->getFine();
+        return result;
+    });
 }
 
 // 归还功能
-void Library::returnBook(const std::string& bookTitle, const std::string& readerName) {
+OperationResult Library::returnBook(const std::string& bookTitle, const std::string& readerName) {
+    return metrics::track(MetricOp::Return, [&] {
+        std::shared_lock<std::shared_mutex> catalogLock(catalogMutex);
+        Book* book = findBook(bookTitle);
+        Reader* reader = findReader(readerName);
+        if (!book) throw BookNotFoundException("未找到图书: " + bookTitle);
+        if (!reader) throw ReaderNotFoundException("未找到读者: " + readerName);
+        rolloverAccounts(DateUtils::getCurrentTime());
+        expireHolds(DateUtils::getCurrentTime());
+        StripeGuard entityLock(entityLocks, book, reader);
+        size_t pos;
+        uint32_t copy = 0;
+        {
+            std::lock_guard<std::mutex> recordLock(recordMutex);
+            pos = findOpenLoan(book, reader);
+            if (pos != RecordIndex::npos) copy = borrowRecords.copyAt(pos);
+        }
+        if (pos == RecordIndex::npos) throw BookNotBorrowedException("未找到借阅记录: " + bookTitle + " 由 " + readerName + " 借阅");
+        std::time_t now = DateUtils::getCurrentTime();
+        log(JournalEntry(JournalOp::Return).putString(bookTitle).putString(readerName).putInt(now).putInt(copy));
+        Hold handedTo;
+        const BorrowRecord record = finishReturn(pos, now, &handedTo);
+        OperationResult result;
+        result.copy = record.getCopy();
+        result.copyCount = book->getCopyCount();
+        result.overdueDays = record.getOverdueDays();
+        result.status = result.overdueDays > 0 ? OperationStatus::ReturnedOverdue : OperationStatus::ReturnedOnTime;
+        result.dueDate = record.getDueDate();
+        result.fine = record.calculateFine();
+        result.ratePerDay = book->getFinePerDay();
+        result.discount = reader->getFineDiscount();
+        result.bookType = book->getType();
+        result.outstandingFine = reader->getFine();
+        if (handedTo.reader) {
+            result.heldFor = handedTo.reader->getName();
+            result.holdDeadline = handedTo.deadline;
+        }
+        return result;
+    });
+}
+
+// 预约功能
+OperationResult Library::placeHold(const std::string& bookTitle, const std::string& readerName) {
+    return metrics::track(MetricOp::Hold, [&] {
+        std::shared_lock<std::shared_mutex> catalogLock(catalogMutex);
+        Book* book = findBook(bookTitle);
+        Reader* reader = findReader(readerName);
+        if (!book) throw BookNotFoundException("未找到图书: " + bookTitle);
+        if (!reader) throw ReaderNotFoundException("未找到读者: " + readerName);
+        std::time_t now = DateUtils::getCurrentTime();
+        expireHolds(now);
+        StripeGuard entityLock(entityLocks, book, reader);
+        if (!book->isBorrowedStatus()) throw InvalidInputException("图书有在架副本，可直接借阅: " + bookTitle);
+        // 该书的预约只在持有其分片锁时变化，检查与排队之间释放 holdMutex 写日志，刷盘不挡住其他书名的预约。
+        // 同一书名的排队顺序由分片锁保证，与日志顺序一致
+        {
+            std::lock_guard<std::mutex> holdLock(holdMutex);
+            if (holds.find(book, reader) != HoldQueue::npos) throw InvalidInputException("已预约该书: " + bookTitle);
+        }
+        log(JournalEntry(JournalOp::PlaceHold).putString(bookTitle).putString(readerName).putInt(now));
+        OperationResult result;
+        {
+            std::lock_guard<std::mutex> holdLock(holdMutex);
+            result.queuePosition = holds.aheadOf(holds.place(book, reader, now)) + 1;
+        }
+        result.status = OperationStatus::HoldPlaced;
+        result.copyCount = book->getCopyCount();
+        result.bookType = book->getType();
+        return result;
+    });
+}
+
+void Library::cancelHold(const std::string& bookTitle, const std::string& readerName) {
+    std::shared_lock<std::shared_mutex> catalogLock(catalogMutex);
     Book* book = findBook(bookTitle);
     Reader* reader = findReader(readerName);
     if (!book) throw BookNotFoundException("未找到图书: " + bookTitle);
     if (!reader) throw ReaderNotFoundException("未找到读者: " + readerName);
-    bool foundRecord = false;
-    for (auto& record : borrowRecords) {
-        if (record.getBook() == book && record.getReader() == reader && !record.getIsReturned()) {
-            std::time_t now = DateUtils::getCurrentTime();
-            record.setReturnDate(now);
-            book->returnBook();
-            int overdueDays = record.getOverdueDays();
-            if (overdueDays > 0) {
-                double fine = record.calculateFine();
-                reader->addFine(fine);
-                std::cout << "⏰ 超期 " << overdueDays << " 天，";
-                std::cout << "图书类型: " << book->getType() << "，";
-                std::cout << "罚款标准: " << book->getFinePerDay() << "元/天，";
-                std::cout << "读者折扣: " << reader->getFineDiscount() * 100 << "%，";
-                std::cout << "需缴纳罚款: \033[1;31m" << fine << "\033[0m 元。\n";
-            } else {
-                std::cout << "✅ 按时归还，感谢！\n";
-            }
-            foundRecord = true;
-            break;
-        }
+    std::time_t now = DateUtils::getCurrentTime();
+    expireHolds(now);
+    StripeGuard entityLock(entityLocks, book, reader);
+    uint32_t id;
+    {
+        std::lock_guard<std::mutex> holdLock(holdMutex);
+        id = holds.find(book, reader);
     }
-    if (!foundRecord) throw BookNotBorrowedException("未找到借阅记录: " + bookTitle + " 由 " + readerName + " 借阅");
+    if (id == HoldQueue::npos) throw InvalidInputException("未找到预约: " + bookTitle + " 由 " + readerName + " 预约");
+    // 持有该书的分片锁，写日志期间这条预约不会被移走
+    log(JournalEntry(JournalOp::CancelHold).putString(bookTitle).putString(readerName).putInt(now));
+    std::lock_guard<std::mutex> holdLock(holdMutex);
+    dropHold(id, now);
 }
 
 // 支付功能
-void Library::payFine(const std::string& readerName, double amount) {
-    Reader* reader = findReader(readerName);
-    if (!reader) throw ReaderNotFoundException("未找到读者: " + readerName);
-    double currentFine = reader->getFine();
-    if (currentFine <= 0) {
-        std::cout << "✅ 该读者没有未支付的罚款\n";
-        return;
-    }
-    if (amount < 0) {
-        reader->payFullFine();
-        std::cout << "✅ 已全额支付罚款: " << currentFine << " 元\n";
-    } else {
-        if (amount > currentFine) {
-            std::cout << "⚠️ 支付金额超过欠款，将支付全部欠款: " << currentFine << " 元\n";
+OperationResult Library::payFine(const std::string& readerName, double amount) {
+    return metrics::track(MetricOp::PayFine, [&] {
+        std::shared_lock<std::shared_mutex> catalogLock(catalogMutex);
+        Reader* reader = findReader(readerName);
+        if (!reader) throw ReaderNotFoundException("未找到读者: " + readerName);
+        rolloverAccounts(DateUtils::getCurrentTime());
+        StripeGuard entityLock(entityLocks, reader);
+        OperationResult result;
+        double currentFine = reader->getFine();
+        if (currentFine <= 0) {
+            result.status = OperationStatus::NoFineDue;
+            return result;
+        }
+        // 负数表示全额支付；超过欠款的金额按欠款结清
+        bool full = amount < 0 || amount > currentFine;
+        result.status = full ? OperationStatus::FinePaidInFull : OperationStatus::FinePaid;
+        result.amountPaid = full ? currentFine : amount;
+        result.amountCapped = amount > currentFine;
+        log(JournalEntry(JournalOp::PayFine).putString(readerName).putDouble(result.amountPaid));
+        if (full) {
             reader->payFullFine();
         } else {
             reader->payFine(amount);
-            std::cout << "✅ 已支付罚款: " << amount << " 元，剩余欠款: " << reader->getFine() << " 元\n";
         }
-    }
+        result.outstandingFine = reader->getFine();
+        return result;
+    });
+}
+
+AccountSummary Library::readerAccount(const std::string& readerName) {
+    std::shared_lock<std::shared_mutex> catalogLock(catalogMutex);
+    Reader* reader = findReader(readerName);
+    if (!reader) throw ReaderNotFoundException("未找到读者: " + readerName);
+    rolloverAccounts(DateUtils::getCurrentTime());
+    return reader->account();
 }
 
 // 显示功能
 void Library::displayBooks() const {
+    std::shared_lock<std::shared_mutex> catalogLock(catalogMutex);
     std::cout << "📚 图书列表：\n";
     for (const auto& book : books) {
         std::cout << "书名: " << book->getTitle()
             << ", 作者: " << book->getAuthor()
             << ", 类型: " << book->getType()
             << ", 罚款标准: " << book->getFinePerDay() << "元/天"
-            << ", 状态: " << (book->isBorrowedStatus() ? "\033[1;31m已借出\033[0m" : "\033[1;32m可借阅\033[0m") << std::endl;
+            << ", 状态: " << availabilityText(book) << std::endl;
     }
 }
 
 void Library::displayReaders() const {
+    std::shared_lock<std::shared_mutex> catalogLock(catalogMutex);
     std::cout << "👥 读者列表：\n";
     for (const auto& reader : readers) {
         std::cout << "姓名: " << reader->getName()
@@ -150,99 +486,603 @@ void Library::displayReaders() const {
 }
 
 void Library::searchBook(const std::string& bookTitle) const {
+    std::shared_lock<std::shared_mutex> catalogLock(catalogMutex);
+    std::time_t now = DateUtils::getCurrentTime();
     bool found = false;
+    auto key = Symbol::find(bookTitle);
     for (const auto& book : books) {
-        if (book->getTitle() == bookTitle) {
+        if (key && book->getTitleSymbol() == *key) {
             std::cout << "书名: \033[1;33m" << book->getTitle()
                 << "\033[0m, 作者: \033[1;33m" << book->getAuthor()
                 << "\033[0m, 类型: \033[1;33m" << book->getType()
                 << "\033[0m, 罚款标准: " << book->getFinePerDay() << "元/天"
-                << ", 状态: " << (book->isBorrowedStatus() ? "\033[1;31m已借出\033[0m" : "\033[1;32m可借阅\033[0m") << std::endl;
-            std::cout << "借阅记录：\n";
-            bool hasRecord = false;
-            for (const auto& record : borrowRecords) {
-                if (record.getBook() == book) {
-                    record.display();
-                    hasRecord = true;
-                }
+                << ", 状态: " << availabilityText(book) << std::endl;
+            {
+                std::lock_guard<std::mutex> holdLock(holdMutex);
+                size_t position = 0;
+                holds.forEachOf(book, [&](const Hold& hold) {
+                    if (position == 0) std::cout << "预约队列：\n";
+                    char time[DateUtils::kTimeTextSize];
+                    if (hold.isReady()) {
+                        DateUtils::formatTime(hold.deadline, time, sizeof(time));
+                        std::cout << "  已为 " << hold.reader->getName() << " 保留";
+                        if (book->getCopyCount() > 1) std::cout << "第 " << hold.copy + 1 << " 册";
+                        std::cout << "，取书期限: " << time << "\n";
+                    } else {
+                        DateUtils::formatTime(hold.placed, time, sizeof(time));
+                        std::cout << "  排队: " << hold.reader->getName() << "（" << hold.reader->getTypeName() << "），预约于 " << time << "\n";
+                    }
+                    ++position;
+                });
             }
-            if (!hasRecord) std::cout << "暂无借阅记录\n";
+            std::cout << "借阅记录：\n";
+            // 历史文件按书名归档，同名图书只在第一本下列出；读历史文件时不持有记录锁
+            size_t shown = found ? 0 : displayHistory(HistoryKey::Book, bookTitle, now);
+            std::lock_guard<std::mutex> recordLock(recordMutex);
+            const auto& positions = recordIndex.recordsOf(book);
+            for (size_t pos : positions) borrowRecords[pos].display(now);
+            if (positions.empty() && shown == 0) std::cout << "暂无借阅记录\n";
             found = true;
         }
     }
-    if (!found) std::cout << "\033[1;31m未找到相关图书\033[0m\n";
+    if (!found) {
+        std::cout << "\033[1;31m未找到相关图书\033[0m\n";
+        printSuggestions(bookTitles.closest(bookTitle));
+    }
+}
+
+// 关键词以空格分隔，末尾加 * 表示按前缀匹配
+void Library::displaySearchResults(const std::string& query) const {
+    std::string_view text = query;
+    SearchMode mode = parseSearchQuery(text);
+    std::vector<SearchHit> hits = searchBooks(text, mode);
+    if (hits.empty()) {
+        std::cout << "\033[1;31m未找到相关图书\033[0m\n";
+        return;
+    }
+    std::shared_lock<std::shared_mutex> lock(catalogMutex);
+    for (const SearchHit& hit : hits) {
+        std::cout << "书名: \033[1;33m" << hit.book->getTitle()
+            << "\033[0m, 作者: \033[1;33m" << hit.book->getAuthor()
+            << "\033[0m, 类型: " << hit.book->getType()
+            << ", 状态: " << availabilityText(hit.book) << std::endl;
+    }
+    std::cout << "共 " << hits.size() << " 条结果\n";
 }
 
 void Library::searchReader(const std::string& readerName) const {
+    std::shared_lock<std::shared_mutex> catalogLock(catalogMutex);
+    std::time_t now = DateUtils::getCurrentTime();
     bool found = false;
+    auto key = Symbol::find(readerName);
     for (const auto& reader : readers) {
-        if (reader->getName() == readerName) {
+        if (key && reader->getNameSymbol() == *key) {
             std::cout << "姓名: \033[1;33m" << reader->getName()
                 << "\033[0m, 类型: \033[1;33m" << reader->getTypeName()
                 << "\033[0m, 借阅期限: \033[1;33m" << reader->getBorrowPeriod()
                 << "\033[0m 天, 罚款: \033[1;31m" << reader->getFine() << "\033[0m 元\n";
-            std::cout << "借阅记录：\n";
-            bool hasRecord = false;
-            for (const auto& record : borrowRecords) {
-                if (record.getReader() == reader) {
-                    record.display();
-                    hasRecord = true;
+            AccountSummary account = reader->account();
+            std::cout << "在借: " << account.activeLoans << " 本, 超期: " << account.overdueLoans
+                << " 本, 应计罚款: " << account.accruedFine << " 元, 累计借阅: " << account.lifetimeLoans << " 次\n";
+            {
+                std::lock_guard<std::mutex> holdLock(holdMutex);
+                for (uint32_t id : holds.holdsOf(reader)) {
+                    const Hold& hold = holds[id];
+                    std::cout << "预约: " << hold.book->getTitle();
+                    if (hold.isReady()) {
+                        char deadline[DateUtils::kTimeTextSize];
+                        DateUtils::formatTime(hold.deadline, deadline, sizeof(deadline));
+                        std::cout << "，\033[1;32m已保留\033[0m，请于 " << deadline << " 前借阅\n";
+                    } else {
+                        std::cout << "，排队中，前面还有 " << holds.aheadOf(id) << " 人\n";
+                    }
                 }
             }
-            if (!hasRecord) std::cout << "暂无借阅记录\n";
+            std::cout << "借阅记录：\n";
+            size_t shown = found ? 0 : displayHistory(HistoryKey::Reader, readerName, now);
+            std::lock_guard<std::mutex> recordLock(recordMutex);
+            const auto& positions = recordIndex.recordsOf(reader);
+            for (size_t pos : positions) borrowRecords[pos].display(now);
+            if (positions.empty() && shown == 0) std::cout << "暂无借阅记录\n";
             found = true;
         }
     }
-    if (!found) std::cout << "\033[1;31m未找到相关读者\033[0m\n";
+    if (!found) {
+        std::cout << "\033[1;31m未找到相关读者\033[0m\n";
+        printSuggestions(readerNames.closest(readerName));
+    }
 }
 
 void Library::displayBorrowRecords() const {
+    std::shared_lock<std::shared_mutex> catalogLock(catalogMutex);
     std::cout << "📜 所有借阅记录：\n";
+    std::time_t now = DateUtils::getCurrentTime();
+    displayHistory(std::nullopt, std::string_view(), now);
+    std::lock_guard<std::mutex> recordLock(recordMutex);
     for (const auto& record : borrowRecords) {
-        record.display();
+        record.display(now);
     }
 }
 
 void Library::displayOverdueBooks() const {
     std::cout << "⚠️ 超期未还图书：\n";
-    bool hasOverdue = false;
-    for (const auto& record : borrowRecords) {
-        if (!record.getIsReturned() && record.getOverdueDays() > 0) {
-            std::cout << "书名: " << record.getBook()->getTitle()
-                << ", 读者: " << record.getReader()->getName()
-                << ", 超期: " << record.getOverdueDays() << "天"
-                << ", 罚款: " << record.calculateFine() << "元\n";
-            hasOverdue = true;
-        }
+    LoanReport report = overdueReport(DateUtils::getCurrentTime());
+    if (report.entries.empty()) {
+        std::cout << "所有图书均按时归还\n";
+        return;
     }
-    if (!hasOverdue) std::cout << "所有图书均按时归还\n";
+    for (const auto& entry : report.entries) {
+        std::cout << "书名: " << entry.title
+            << ", 读者: " << entry.reader
+            << ", 超期: " << entry.days << "天"
+            << ", 罚款: " << entry.fine << "元\n";
+    }
+    std::cout << "共 " << report.count << " 笔超期，罚款合计 " << report.fineTotal << " 元\n";
 }
 
 void Library::displayBooksDueSoon(int days) const {
     std::cout << "📅 即将到期的图书（" << days << "天内）：\n";
-    bool hasDueSoon = false;
-    std::time_t now = DateUtils::getCurrentTime();
+    LoanReport report = dueSoonReport(days, DateUtils::getCurrentTime());
+    for (const auto& entry : report.entries) {
+        std::cout << "书名: " << entry.title
+            << ", 读者: " << entry.reader
+            << ", 剩余天数: " << entry.days << "天\n";
+    }
+    if (report.entries.empty()) {
+        std::cout << "没有即将到期的图书\n";
+    } else {
+        std::cout << "共 " << report.count << " 笔即将到期\n";
+    }
+}
+
+LoanReport Library::overdueReport(std::time_t now) const {
+    std::shared_lock<std::shared_mutex> catalogLock(catalogMutex);
+    std::lock_guard<std::mutex> recordLock(recordMutex);
+    LoanReport report;
+    // 超期至少一整天才计入，即应还日期不晚于 now - 1天
+    auto range = dueDateIndex.dueBefore(now - 24 * 60 * 60 + 1);
+    // 先收集超期天数和类别 / 等级，再整批查表计算罚款
+    std::vector<int32_t> overdueDays;
+    std::vector<BookCategory> categories;
+    std::vector<MemberTier> tiers;
+    for (auto it = range.first; it != range.second; ++it) {
+        const BorrowRecord record = borrowRecords[it->second];
+        report.entries.push_back({ record.getBook()->getTitle(), record.getReader()->getName(), record.getDueDate(), 0, 0.0 });
+        overdueDays.push_back(record.getOverdueDays(now));
+        categories.push_back(record.getBook()->getCategory());
+        tiers.push_back(record.getReader()->getTier());
+    }
+    std::vector<double> fines(report.entries.size());
+    FinePolicy::computeFines(fines.size(), overdueDays.data(), categories.data(), tiers.data(), fines.data());
+    for (size_t i = 0; i < report.entries.size(); ++i) {
+        report.entries[i].days = overdueDays[i];
+        report.entries[i].fine = fines[i];
+        report.fineTotal += fines[i];
+    }
+    // 汇总只来自索引区间，持锁时间与结果条数成正比，不扫描整列
+    report.count = report.entries.size();
+    return report;
+}
+
+LoanReport Library::dueSoonReport(int days, std::time_t now) const {
+    std::shared_lock<std::shared_mutex> catalogLock(catalogMutex);
+    std::lock_guard<std::mutex> recordLock(recordMutex);
+    LoanReport report;
+    // 剩余天数按整天截断，落在 [0, days] 内的应还日期区间为 (now - 1天, now + (days + 1)天)
+    std::time_t from = now - 24 * 60 * 60 + 1;
+    std::time_t to = now + (days + 1) * 24 * 60 * 60;
+    auto range = dueDateIndex.dueBetween(from, to);
+    for (auto it = range.first; it != range.second; ++it) {
+        const BorrowRecord record = borrowRecords[it->second];
+        int daysLeft = (record.getDueDate() - now) / (24 * 60 * 60);
+        report.entries.push_back({ record.getBook()->getTitle(), record.getReader()->getName(), record.getDueDate(), daysLeft, 0.0 });
+    }
+    report.count = report.entries.size();
+    return report;
+}
+
+std::vector<SearchHit> Library::searchBooks(std::string_view query, SearchMode mode, size_t limit) const {
+    std::shared_lock<std::shared_mutex> lock(catalogMutex);
+    return searchIndex.search(query, mode, limit);
+}
+
+std::vector<FuzzyMatch> Library::suggestBooks(std::string_view title, size_t k) const {
+    std::shared_lock<std::shared_mutex> lock(catalogMutex);
+    return bookTitles.closest(title, k);
+}
+
+std::vector<FuzzyMatch> Library::suggestReaders(std::string_view name, size_t k) const {
+    std::shared_lock<std::shared_mutex> lock(catalogMutex);
+    return readerNames.closest(name, k);
+}
+
+// 数据持久化
+void Library::saveData() {
+    metrics::track(MetricOp::SaveData, [&] {
+        std::unique_lock<std::shared_mutex> lock(catalogMutex);
+        writeSnapshot();
+    });
+}
+
+// 调用方持有目录独占锁
+void Library::writeSnapshot() {
+    SnapshotWriter writer;
+    std::unordered_map<const Book*, uint32_t> bookIds;
+    std::unordered_map<const Reader*, uint32_t> readerIds;
+    writer.books.reserve(books.size());
+    for (const auto& book : books) {
+        bookIds.emplace(book, static_cast<uint32_t>(writer.books.size()));
+        writer.books.push_back({ writer.addString(book->getTitle()), writer.addString(book->getAuthor()),
+            writer.addString(book->getType()), static_cast<uint8_t>(book->isBorrowedStatus()),
+            static_cast<uint8_t>(book->getCategory()), static_cast<uint16_t>(book->getCopyCount()) });
+    }
+    writer.readers.reserve(readers.size());
+    writer.readerLoans.reserve(readers.size());
+    for (const auto& reader : readers) {
+        readerIds.emplace(reader, static_cast<uint32_t>(writer.readers.size()));
+        writer.readers.push_back({ writer.addString(reader->getName()), static_cast<uint8_t>(reader->getTier()), {}, reader->getFine() });
+        writer.readerLoans.push_back(reader->account().lifetimeLoans);
+    }
+    // 归还超过 historyDays 天的记录追加到历史文件，不再写入快照
+    std::time_t cutoff = DateUtils::getCurrentTime() - static_cast<std::time_t>(historyDays) * DateUtils::kSecondsPerDay;
+    auto isCold = [&](const BorrowRecord& record) {
+        return historyDays > 0 && history.isOpen() && record.getIsReturned() && record.getReturnDate() < cutoff;
+    };
+    std::vector<HistoryRecord> cold;
+    // 已删除的图书 / 读者的记录不再写入，与文本格式重新加载后的结果一致
+    writer.records.reserve(borrowRecords.size());
     for (const auto& record : borrowRecords) {
-        if (!record.getIsReturned()) {
-            int daysLeft = (record.getDueDate() - now) / (24 * 60 * 60);
-            if (daysLeft >= 0 && daysLeft <= days) {
-                std::cout << "书名: " << record.getBook()->getTitle()
-                    << ", 读者: " << record.getReader()->getName()
-                    << ", 剩余天数: " << daysLeft << "天\n";
-                hasDueSoon = true;
+        auto bookIt = bookIds.find(record.getBook());
+        auto readerIt = readerIds.find(record.getReader());
+        if (bookIt == bookIds.end() || readerIt == readerIds.end()) continue;
+        if (isCold(record)) {
+            cold.push_back({ record.getBook()->getTitle(), record.getReader()->getName(), record.getBorrowDate(),
+                record.getDueDate(), record.getReturnDate() });
+            continue;
+        }
+        writer.records.push_back({ bookIt->second, readerIt->second, record.getBorrowDate(), record.getDueDate(),
+            record.getReturnDate(), record.getIsReturned(), record.getCopy() });
+    }
+    // 同一书名的预约按排队顺序写入，加载时依次排队即可恢复
+    holds.forEach([&](const Hold& hold) {
+        auto bookIt = bookIds.find(hold.book);
+        auto readerIt = readerIds.find(hold.reader);
+        if (bookIt == bookIds.end() || readerIt == readerIds.end()) return;
+        writer.holds.push_back({ bookIt->second, readerIt->second, hold.placed, hold.deadline, hold.copy, 0 });
+    });
+    for (const auto& user : users) {
+        uint32_t username = writer.addString(user->getUsername());
+        uint32_t password = writer.addString(user->getPassword());
+        if (dynamic_cast<Administrator*>(user)) {
+            writer.users.push_back({ username, password, snapshot::kNoIndex, snapshot::AdministratorUser, {} });
+        } else if (auto readerUser = dynamic_cast<ReaderUser*>(user)) {
+            auto readerIt = readerIds.find(readerUser->getReader());
+            if (readerIt == readerIds.end()) continue;
+            writer.users.push_back({ username, password, readerIt->second, snapshot::ReaderAccount, {} });
+        }
+    }
+    writer.journalGeneration = journalGeneration + 1;
+    // 历史段带新快照的代号，快照没写成功时撤销，两边始终只有一份
+    uint64_t historyMark = history.fileSize();
+    try {
+        if (history.isOpen()) history.append(cold, writer.journalGeneration);
+        writer.write(kSnapshotFile);
+    } catch (...) {
+        if (history.isOpen()) history.rollback(historyMark);
+        throw;
+    }
+    // 新快照已落盘，旧日志中的修改都已包含在内
+    journalGeneration = writer.journalGeneration;
+    if (journal) journal->reset(journalGeneration);
+    if (!cold.empty()) purgeRecords(isCold);
+}
+
+// 罚款费率表：配置文件缺失时使用默认表，格式错误时提示并保留默认表
+void Library::loadFinePolicy() {
+    try {
+        if (FinePolicy::loadFile(kFinePolicyFile)) {
+            std::cout << "\033[1;32m已加载罚款策略配置: " << kFinePolicyFile << "\033[0m\n";
+        }
+    } catch (const InvalidInputException& ex) {
+        std::cerr << "\033[1;31m[错误] 罚款策略配置无效，使用默认费率: " << ex.what() << "\033[0m\n";
+    }
+}
+
+void Library::loadData() {
+    metrics::track(MetricOp::LoadData, [&] {
+        deferIndexes = true;
+        bool fromSnapshot = false;
+        try {
+            SnapshotReader snapshot(kSnapshotFile);
+            if (snapshot.isOpen()) {
+                loadSnapshot(snapshot);
+                journalGeneration = snapshot.journalGeneration();
+                fromSnapshot = true;
+            }
+        } catch (const DataFormatException& ex) {
+            std::cerr << "\033[1;31m[错误] " << ex.what() << "，改为从文本文件导入\033[0m\n";
+            clearData();
+        }
+        if (!fromSnapshot) importText();
+        // 历史文件中晚于该快照的段在这里截掉，随后由日志重放恢复
+        openHistory(fromSnapshot);
+
+        // 重放上次快照之后的日志
+        uint64_t validBytes = Journal::replay(kJournalFile, journalGeneration, [this](JournalEntry& entry) {
+            try {
+                applyJournalEntry(entry);
+            } catch (const std::exception& ex) {
+                std::cerr << "\033[1;31m[错误] 日志重放失败: " << ex.what() << "\033[0m\n";
+            }
+        });
+        journal = std::make_unique<Journal>(kJournalFile, journalGeneration, validBytes, journalOptions);
+        deferIndexes = false;
+        rebuildIndexes();
+        rolloverAccounts(DateUtils::getCurrentTime(), true);
+        // 停机期间到期的保留在这里转给下一位，转交记入新日志
+        expireHolds(DateUtils::getCurrentTime());
+        if (!fromSnapshot) saveData();
+    });
+}
+
+void Library::applyJournalEntry(JournalEntry& entry) {
+    switch (entry.op()) {
+        case JournalOp::AddBook: {
+            std::string type = entry.getString();
+            std::string title = entry.getString();
+            std::string author = entry.getString();
+            entry.getByte();  // 早期的借出标志，在架状态由借阅记录决定
+            int64_t copies = entry.atEnd() ? 1 : entry.getInt();
+            std::time_t added = entry.atEnd() ? DateUtils::getCurrentTime() : entry.getInt();
+            Book* book = createBook(bookPool, type, title, author);
+            if (copies > 1) book->addCopies(static_cast<uint32_t>(std::min<int64_t>(copies, CopySet::kMaxCopies) - 1));
+            offerCopies(insertBook(book).first, added);
+            break;
+        }
+        case JournalOp::RemoveBook:
+            removeBook(entry.getString());
+            break;
+        case JournalOp::AddReader: {
+            MemberTier tier = checkedTier(entry.getByte());
+            Reader* reader = createReader(readerPool, tier, entry.getString());
+            double fine = entry.getDouble();
+            if (fine > 0) reader->addFine(fine);
+            addReader(reader);
+            break;
+        }
+        case JournalOp::RemoveReader: {
+            std::string name = entry.getString();
+            removeReader(name, entry.atEnd() ? DateUtils::getCurrentTime() : entry.getInt());
+            break;
+        }
+        case JournalOp::Borrow: {
+            std::string bookTitle = entry.getString();
+            std::string readerName = entry.getString();
+            std::time_t borrowDate = entry.getInt();
+            std::time_t dueDate = entry.getInt();
+            uint32_t copy = entry.atEnd() ? CopySet::kNone : static_cast<uint32_t>(entry.getInt());
+            Book* book = findBook(bookTitle);
+            Reader* reader = findReader(readerName);
+            if (!book) throw BookNotFoundException("未找到图书: " + bookTitle);
+            if (!reader) throw ReaderNotFoundException("未找到读者: " + readerName);
+            // 借走为该读者保留的副本时预约随之结束
+            uint32_t holdId = holds.find(book, reader);
+            copy = holdId != HoldQueue::npos && holds[holdId].isReady() ? holds[holdId].copy : claimCopy(book, copy);
+            if (holdId != HoldQueue::npos) holds.remove(holdId);
+            appendRecord(book, copy, reader, borrowDate, dueDate);
+            break;
+        }
+        case JournalOp::Return: {
+            std::string bookTitle = entry.getString();
+            std::string readerName = entry.getString();
+            std::time_t returnDate = entry.getInt();
+            uint32_t copy = entry.atEnd() ? CopySet::kNone : static_cast<uint32_t>(entry.getInt());
+            size_t pos = findOpenLoan(findBook(bookTitle), findReader(readerName), copy);
+            if (pos == RecordIndex::npos) throw BookNotBorrowedException("未找到借阅记录: " + bookTitle + " 由 " + readerName + " 借阅");
+            finishReturn(pos, returnDate);
+            break;
+        }
+        case JournalOp::PayFine: {
+            std::string readerName = entry.getString();
+            double amount = entry.getDouble();
+            Reader* reader = findReader(readerName);
+            if (!reader) throw ReaderNotFoundException("未找到读者: " + readerName);
+            reader->payFine(std::min(amount, reader->getFine()));
+            break;
+        }
+        case JournalOp::AddUser: {
+            uint8_t type = entry.getByte();
+            std::string username = entry.getString();
+            std::string password = entry.getString();
+            std::string readerName = entry.getString();
+            if (type == snapshot::AdministratorUser) {
+                addUser(userPool.create<Administrator>(username, password));
+            } else {
+                Reader* reader = findReader(readerName);
+                if (!reader) throw ReaderNotFoundException("未找到读者: " + readerName);
+                addUser(userPool.create<ReaderUser>(username, password, reader));
             }
+            break;
         }
+        case JournalOp::DeleteUser:
+            deleteUser(entry.getString());
+            break;
+        case JournalOp::PlaceHold:
+        case JournalOp::CancelHold:
+        case JournalOp::ExpireHold: {
+            std::string bookTitle = entry.getString();
+            std::string readerName = entry.getString();
+            std::time_t when = entry.getInt();
+            Book* book = findBook(bookTitle);
+            Reader* reader = findReader(readerName);
+            if (!book) throw BookNotFoundException("未找到图书: " + bookTitle);
+            if (!reader) throw ReaderNotFoundException("未找到读者: " + readerName);
+            uint32_t id = holds.find(book, reader);
+            if (entry.op() == JournalOp::PlaceHold) {
+                if (id == HoldQueue::npos) holds.place(book, reader, when);
+                break;
+            }
+            if (id == HoldQueue::npos) throw InvalidInputException("未找到预约: " + bookTitle + " 由 " + readerName + " 预约");
+            dropHold(id, when);
+            break;
+        }
+        default:
+            throw DataFormatException("未知的日志操作类型");
     }
-    if (!hasDueSoon) std::cout << "没有即将到期的图书\n";
 }
 
-// 数据持久化
-void Library::saveData() {
+void Library::log(const JournalEntry& entry) {
+    if (journal) journal->append(entry);
+}
+
+// 历史文件无法使用时本次运行不做分层，所有记录留在内存和快照中。
+// 快照缺失或损坏时代号无从比对，原文件改名保留而不是按代号 0 截断，从新的历史文件开始
+void Library::openHistory(bool fromSnapshot) {
+    try {
+        if (!fromSnapshot) {
+            std::string backup = HistoryStore::moveAside(kHistoryFile);
+            if (!backup.empty()) {
+                std::cerr << "\033[1;33m[警告] 未加载快照，原历史文件已改名为 " << backup << " 保留，其中的记录本次不显示\033[0m\n";
+            }
+        }
+        history.open(kHistoryFile, journalGeneration);
+    } catch (const std::exception& ex) {
+        history.close();
+        std::cerr << "\033[1;31m[错误] " << ex.what() << "，本次运行不移出历史记录\033[0m\n";
+    }
+}
+
+size_t Library::displayHistory(std::optional<HistoryKey> key, std::string_view name, std::time_t now) const {
+    if (!history.isOpen()) return 0;
+    size_t shown = 0;
+    auto display = [&](const HistoryRecord& record) {
+        auto title = Symbol::find(record.book);
+        auto readerName = Symbol::find(record.reader);
+        auto bookIt = title ? bookIndex.find(*title) : bookIndex.end();
+        auto readerIt = readerName ? readerIndex.find(*readerName) : readerIndex.end();
+        if (bookIt == bookIndex.end() || readerIt == readerIndex.end()) return;
+        // 历史文件不保存副本编号
+        BorrowRecord(bookIt->second, readerIt->second, record.borrowDate, record.dueDate, record.returnDate, true).display(now);
+        ++shown;
+    };
+    try {
+        if (key) {
+            history.forEach(*key, name, display);
+        } else {
+            history.forEach(display);
+        }
+    } catch (const DataFormatException& ex) {
+        std::cerr << "\033[1;31m[错误] 读取历史记录失败: " << ex.what() << "\033[0m\n";
+    }
+    return shown;
+}
+
+void Library::rebuildIndexes() {
+    searchIndex.build(books);
+    bookTitles.clear();
+    for (const Book* book : books) bookTitles.add(book->getTitleSymbol());
+    readerNames.clear();
+    for (const Reader* reader : readers) readerNames.add(reader->getNameSymbol());
+}
+
+void Library::clearData() {
+    books.clear();
+    readers.clear();
+    borrowRecords.clear();
+    users.clear();
+    bookIndex.clear();
+    readerIndex.clear();
+    userIndex.clear();
+    recordIndex.clear();
+    dueDateIndex.clear();
+    accountCutoff = 0;
+    nextRollover.store(0);
+    holds.clear();
+    nextHoldCheck.store(0);
+    searchIndex.clear();
+    bookTitles.clear();
+    readerNames.clear();
+    bookPool.clear();
+    readerPool.clear();
+    userPool.clear();
+    currentUser = nullptr;
+}
+
+void Library::loadSnapshot(const SnapshotReader& snapshot) {
+    // 编号对应的目录条目和首个副本编号：版本 6 以前同名图书各占一条，合并后分别对应各自的副本
+    std::vector<std::pair<Book*, uint32_t>> bookById(snapshot.bookCount());
+    std::vector<Reader*> readerById(snapshot.readerCount());
+    books.reserve(books.size() + bookById.size());
+    readers.reserve(readers.size() + readerById.size());
+    borrowRecords.reserve(borrowRecords.size() + snapshot.recordCount());
+
+    // 版本 3 起类别直接存在记录中，不再按类型名逐本比较
+    bool hasCategory = snapshot.version() >= 3;
+    const snapshot::BookEntry* bookEntries = snapshot.books();
+    for (size_t i = 0; i < bookById.size(); ++i) {
+        const snapshot::BookEntry& entry = bookEntries[i];
+        std::string type(snapshot.string(entry.type));
+        if (hasCategory && entry.category >= static_cast<uint8_t>(BookCategory::Count)) {
+            throw DataFormatException("快照文件已损坏: 未知的图书类别");
+        }
+        BookCategory category = hasCategory ? static_cast<BookCategory>(entry.category) : categoryFromName(type);
+        Book* book = createBook(bookPool, category, type, std::string(snapshot.string(entry.title)),
+            std::string(snapshot.string(entry.author)));
+        if (entry.copies > 1) book->addCopies(std::min<uint32_t>(entry.copies, CopySet::kMaxCopies) - 1);
+        // borrowed 标志不再使用，在架状态由下面的未还借阅记录恢复
+        bookById[i] = insertBook(book);
+    }
+    const snapshot::ReaderEntry* readerEntries = snapshot.readers();
+    for (size_t i = 0; i < readerById.size(); ++i) {
+        const snapshot::ReaderEntry& entry = readerEntries[i];
+        Reader* reader = createReader(readerPool, checkedTier(entry.type), std::string(snapshot.string(entry.name)));
+        if (entry.fine > 0) reader->addFine(entry.fine);
+        addReader(reader);
+        readerById[i] = reader;
+    }
+    snapshot.forEachRecord([&](const LoanRow& entry) {
+        if (entry.book >= bookById.size() || entry.reader >= readerById.size()) {
+            throw DataFormatException("快照文件已损坏: 借阅记录引用越界");
+        }
+        auto [book, firstCopy] = bookById[entry.book];
+        uint32_t copy = firstCopy + entry.copy;
+        if (!entry.returned) copy = claimCopy(book, copy);
+        size_t pos = appendRecord(book, copy, readerById[entry.reader], entry.borrowDate, entry.dueDate);
+        if (entry.returned) closeRecord(pos, entry.returnDate);
+    });
+    // 预约在借阅记录之后恢复，已保留的副本这时才能从书架上取下
+    const snapshot::HoldEntry* holdEntries = snapshot.holdCount() > 0 ? snapshot.holds() : nullptr;
+    for (size_t i = 0; i < snapshot.holdCount(); ++i) {
+        const snapshot::HoldEntry& entry = holdEntries[i];
+        if (entry.book >= bookById.size() || entry.reader >= readerById.size()) {
+            throw DataFormatException("快照文件已损坏: 预约引用越界");
+        }
+        restoreHold(bookById[entry.book].first, readerById[entry.reader], entry.placed, entry.deadline, entry.copy);
+    }
+    // 累计借阅数包含已移入历史文件的记录，版本 5 以前的快照只能按驻留记录计数
+    if (const uint64_t* loans = snapshot.readerLoans()) {
+        for (size_t i = 0; i < readerById.size(); ++i) readerById[i]->setLifetimeLoans(loans[i]);
+    }
+    const snapshot::UserEntry* userEntries = snapshot.users();
+    for (size_t i = 0; i < snapshot.userCount(); ++i) {
+        const snapshot::UserEntry& entry = userEntries[i];
+        std::string username(snapshot.string(entry.username));
+        std::string password(snapshot.string(entry.password));
+        if (entry.type == snapshot::AdministratorUser) {
+            addUser(userPool.create<Administrator>(username, password));
+        } else if (entry.reader < readerById.size()) {
+            addUser(userPool.create<ReaderUser>(username, password, readerById[entry.reader]));
+        }
+    }
+}
+
+void Library::exportText() {
+    std::unique_lock<std::shared_mutex> lock(catalogMutex);
     std::ofstream bookFile("books.txt");
     if (bookFile.is_open()) {
         for (const auto& book : books) {
             bookFile << book->getType() << "," << book->getTitle() << ","
-                << book->getAuthor() << "," << book->isBorrowedStatus() << "\n";
+                << book->getAuthor() << "," << book->isBorrowedStatus() << "," << book->getCopyCount() << "\n";
         }
         bookFile.close();
     }
@@ -250,12 +1090,7 @@ void Library::saveData() {
     std::ofstream readerFile("readers.txt");
     if (readerFile.is_open()) {
         for (const auto& reader : readers) {
-            std::string type;
-            if (dynamic_cast<RegularMember*>(reader)) type = "RegularMember";
-            else if (dynamic_cast<VIPMember*>(reader)) type = "VIPMember";
-            else if (dynamic_cast<StudentMember*>(reader)) type = "StudentMember";
-            else type = "RegularMember";
-            readerFile << type << "," << reader->getName() << ","
+            readerFile << tierTag(reader->getTier()) << "," << reader->getName() << ","
                 << reader->getBorrowPeriod() << "," << reader->getFine() << "\n";
         }
         readerFile.close();
@@ -263,154 +1098,594 @@ void Library::saveData() {
 
     std::ofstream recordFile("records.txt");
     if (recordFile.is_open()) {
+        // 文本导出是完整数据：先写历史文件中的记录，再写内存中的记录
+        if (history.isOpen()) {
+            history.forEach([&](const HistoryRecord& record) {
+                recordFile << record.book << "," << record.reader << "," << record.borrowDate << "," << record.dueDate
+                    << "," << record.returnDate << ",1\n";
+            });
+        }
         for (const auto& record : borrowRecords) {
             recordFile << record.getBook()->getTitle() << "," << record.getReader()->getName()
                 << "," << record.getBorrowDate() << "," << record.getDueDate()
-                << "," << record.getReturnDate() << "," << record.getIsReturned() << "\n";
+                << "," << record.getReturnDate() << "," << record.getIsReturned() << "," << record.getCopy() << "\n";
         }
         recordFile.close();
     }
 
+    // 同一份记录再写一份列式归档，导入时优先读取它
+    LoanArchiveWriter archive;
+    if (history.isOpen()) {
+        history.forEach([&](const HistoryRecord& record) {
+            archive.add(archive.addName(record.book), archive.addName(record.reader), record.borrowDate, record.dueDate,
+                record.returnDate, true);
+        });
+    }
+    for (const auto& record : borrowRecords) {
+        archive.add(archive.addName(record.getBook()->getTitle()), archive.addName(record.getReader()->getName()),
+            record.getBorrowDate(), record.getDueDate(), record.getReturnDate(), record.getIsReturned(), record.getCopy());
+    }
+    try {
+        archive.write(kRecordArchiveFile);
+    } catch (const std::exception& ex) {
+        std::cerr << "\033[1;31m[错误] " << ex.what() << "\033[0m\n";
+    }
+
+    // 每行 <书名>,<读者>,<预约时间>,<取书期限>[,<保留的副本编号>]，排队中的取书期限为 0
+    std::ofstream holdFile(kHoldFile);
+    if (holdFile.is_open()) {
+        holds.forEach([&](const Hold& hold) {
+            holdFile << hold.book->getTitle() << "," << hold.reader->getName() << "," << hold.placed << "," << hold.deadline;
+            if (hold.isReady()) holdFile << "," << hold.copy;
+            holdFile << "\n";
+        });
+        holdFile.close();
+    }
+
     std::ofstream userFile("users.txt");
     if (userFile.is_open()) {
         for (const auto& user : users) {
-            if (dynamic_cast<Administrator*>(user.get())) {
-                userFile << "Administrator," << user->getUsername() << "," << user->getUsername() << "\n";
-            } else if (auto readerUser = dynamic_cast<ReaderUser*>(user.get())) {
-                userFile << "ReaderUser," << user->getUsername() << "," << user->getUsername() << "," << readerUser->getReader()->getName() << "\n";
+            if (dynamic_cast<Administrator*>(user)) {
+                userFile << "Administrator," << user->getUsername() << "," << user->getPassword() << "\n";
+            } else if (auto readerUser = dynamic_cast<ReaderUser*>(user)) {
+                userFile << "ReaderUser," << user->getUsername() << "," << user->getPassword() << "," << readerUser->getReader()->getName() << "\n";
             }
         }
         userFile.close();
     }
 }
 
-void Library::loadData() {
-    std::ifstream bookFile("books.txt");
-    if (bookFile.is_open()) {
-        std::string line;
-        while (std::getline(bookFile, line)) {
-            size_t pos1 = line.find(',');
-            size_t pos2 = line.find(',', pos1 + 1);
-            size_t pos3 = line.find(',', pos2 + 1);
-            std::string type = line.substr(0, pos1);
-            std::string title = line.substr(pos1 + 1, pos2 - pos1 - 1);
-            std::string author = line.substr(pos2 + 1, pos3 - pos2 - 1);
-            bool isBorrowed = (line.substr(pos3 + 1) == "1");
-            Book* book;
-            if (type == "教科书") book = new Textbook(title, author);
-            else if (type == "小说") book = new Novel(title, author);
-            else if (type == "杂志") book = new Magazine(title, author);
-            else book = new Book(title, author, type);
-            if (isBorrowed) book->borrow();
-            books.push_back(book);
+// 文本导入：图书与读者并行解析，借阅记录按行切块后在线程池上解析，
+// 书名 / 读者名通过已建好的哈希索引解析，最后按块顺序合并，结果与串行加载一致
+void Library::importText() {
+    MappedFile bookFile("books.txt");
+    MappedFile readerFile("readers.txt");
+    MappedFile recordFile("records.txt");
+    MappedFile userFile("users.txt");
+    MappedFile holdFile(kHoldFile);
+    ThreadPool pool;
+
+    auto parsedBooks = pool.submit([this, &bookFile] {
+        std::vector<Book*> result;
+        std::string_view text = bookFile.view();
+        while (!text.empty()) {
+            std::string_view line = textparse::nextLine(text);
+            if (line.empty()) continue;
+            std::string type(textparse::nextField(line));
+            std::string title(textparse::nextField(line));
+            std::string author(textparse::nextField(line));
+            textparse::nextField(line);  // 是否全部借出：在架状态由未还借阅记录恢复
+            uint32_t copies = 1;
+            textparse::parseNumber(line, copies);
+            Book* book = createBook(bookPool, type, title, author);
+            if (copies > 1) book->addCopies(std::min(copies, CopySet::kMaxCopies) - 1);
+            result.push_back(book);
+        }
+        return result;
+    });
+    auto parsedReaders = pool.submit([this, &readerFile] {
+        std::vector<Reader*> result;
+        std::string_view text = readerFile.view();
+        while (!text.empty()) {
+            std::string_view line = textparse::nextLine(text);
+            if (line.empty()) continue;
+            std::string type(textparse::nextField(line));
+            std::string name(textparse::nextField(line));
+            textparse::nextField(line);  // 借阅期限由会员类型决定
+            double fine = 0.0;
+            textparse::parseNumber(line, fine);
+            Reader* reader = createReader(readerPool, tierFromTag(type), name);
+            if (fine > 0) reader->addFine(fine);
+            result.push_back(reader);
+        }
+        return result;
+    });
+    // 早期的文本数据中同一书名的每一册各占一行，这里合并为一个条目的多个副本
+    std::vector<Book*> loadedBooks = parsedBooks.get();
+    books.reserve(books.size() + loadedBooks.size());
+    for (Book* book : loadedBooks) insertBook(book);
+    std::vector<Reader*> loadedReaders = parsedReaders.get();
+    readers.reserve(readers.size() + loadedReaders.size());
+    for (Reader* reader : loadedReaders) addReader(reader);
+
+    struct LoadedRecord {
+        Book* book;
+        Reader* reader;
+        std::time_t borrowDate;
+        std::time_t dueDate;
+        std::time_t returnDate;
+        bool isReturned;
+        uint32_t copy;  // 没有副本编号时为 CopySet::kNone
+    };
+    std::vector<std::vector<LoadedRecord>> loadedRecords;
+    bool fromArchive = false;
+    std::unique_ptr<LoanArchiveReader> archive;
+    try {
+        archive = std::make_unique<LoanArchiveReader>(kRecordArchiveFile);
+    } catch (const DataFormatException& ex) {
+        std::cerr << "\033[1;31m[错误] " << ex.what() << "，改为读取 records.txt\033[0m\n";
+    }
+    if (archive && archive->isOpen()) {
+        // 字典中的名称先统一解析成图书 / 读者，各块再按编号直接取用
+        const auto& names = archive->names();
+        std::vector<Book*> bookByName(names.size());
+        std::vector<Reader*> readerByName(names.size());
+        for (size_t i = 0; i < names.size(); ++i) {
+            bookByName[i] = findBook(names[i]);
+            readerByName[i] = findReader(names[i]);
+        }
+        std::vector<std::future<std::vector<LoadedRecord>>> parts;
+        size_t blockCount = archive->blocks().size();
+        size_t step = std::max<size_t>(1, blockCount / (pool.size() * 4));
+        for (size_t first = 0; first < blockCount; first += step) {
+            parts.push_back(pool.submit([&, first] {
+                std::vector<LoadedRecord> result;
+                std::vector<LoanRow> rows;
+                for (size_t i = first; i < std::min(blockCount, first + step); ++i) archive->decodeBlock(i, rows);
+                for (const LoanRow& row : rows) {
+                    LoadedRecord record{ bookByName[row.book], readerByName[row.reader], row.borrowDate, row.dueDate,
+                        row.returnDate, row.returned, row.copy };
+                    if (record.book && record.reader) result.push_back(record);
+                }
+                return result;
+            }));
+        }
+        // 等所有块都解码完再判断，损坏时整体改读文本文件
+        bool damaged = false;
+        for (auto& part : parts) {
+            try {
+                loadedRecords.push_back(part.get());
+            } catch (const DataFormatException& ex) {
+                if (!damaged) std::cerr << "\033[1;31m[错误] " << ex.what() << "，改为读取 records.txt\033[0m\n";
+                damaged = true;
+            }
+        }
+        if (damaged) loadedRecords.clear();
+        fromArchive = !damaged;
+    }
+    if (!fromArchive) {
+        std::vector<std::future<std::vector<LoadedRecord>>> parts;
+        for (std::string_view chunk : textparse::splitLines(recordFile.view(), pool.size() * 4)) {
+            parts.push_back(pool.submit([this, chunk] {
+                std::vector<LoadedRecord> result;
+                std::string_view text = chunk;
+                while (!text.empty()) {
+                    std::string_view line = textparse::nextLine(text);
+                    std::string_view bookTitle = textparse::nextField(line);
+                    std::string_view readerName = textparse::nextField(line);
+                    LoadedRecord record{};
+                    if (!textparse::parseNumber(textparse::nextField(line), record.borrowDate)
+                        || !textparse::parseNumber(textparse::nextField(line), record.dueDate)
+                        || !textparse::parseNumber(textparse::nextField(line), record.returnDate)) {
+                        continue;
+                    }
+                    record.isReturned = textparse::nextField(line) == "1";
+                    if (!textparse::parseNumber(line, record.copy)) record.copy = CopySet::kNone;
+                    // 并发只读查找驻留表和哈希索引
+                    record.book = findBook(bookTitle);
+                    record.reader = findReader(readerName);
+                    if (!record.book || !record.reader) continue;
+                    result.push_back(record);
+                }
+                return result;
+            }));
+        }
+        for (auto& part : parts) loadedRecords.push_back(part.get());
+    }
+    for (const auto& part : loadedRecords) {
+        for (const LoadedRecord& record : part) {
+            uint32_t copy = record.isReturned ? (record.copy == CopySet::kNone ? 0 : record.copy) : claimCopy(record.book, record.copy);
+            size_t pos = appendRecord(record.book, copy, record.reader, record.borrowDate, record.dueDate);
+            if (record.isReturned) closeRecord(pos, record.returnDate);
         }
-        bookFile.close();
     }
 
-    std::ifstream readerFile("readers.txt");
-    if (readerFile.is_open()) {
-        std::string line;
-        while (std::getline(readerFile, line)) {
-            size_t pos1 = line.find(',');
-            size_t pos2 = line.find(',', pos1 + 1);
-            size_t pos3 = line.find(',', pos2 + 1);
-            std::string type = line.substr(0, pos1);
-            std::string name = line.substr(pos1 + 1, pos2 - pos1 - 1);
-            double fine = std::stod(line.substr(pos3 + 1));
-            Reader* reader;
-            if (type == "RegularMember") reader = new RegularMember(name);
-            else if (type == "VIPMember") reader = new VIPMember(name);
-            else if (type == "StudentMember") reader = new StudentMember(name);
-            else reader = new RegularMember(name);
-            if (fine > 0) reader->addFine(fine);
-            readers.push_back(reader);
+    // 预约按文件中的顺序依次排队
+    std::string_view holdText = holdFile.view();
+    while (!holdText.empty()) {
+        std::string_view line = textparse::nextLine(holdText);
+        Book* book = findBook(textparse::nextField(line));
+        Reader* reader = findReader(textparse::nextField(line));
+        std::time_t placed = 0;
+        std::time_t deadline = 0;
+        if (!book || !reader || !textparse::parseNumber(textparse::nextField(line), placed)
+            || !textparse::parseNumber(textparse::nextField(line), deadline)) {
+            continue;
         }
-        readerFile.close();
+        uint32_t copy = CopySet::kNone;
+        textparse::parseNumber(line, copy);
+        restoreHold(book, reader, placed, deadline, copy);
     }
 
-    std::ifstream recordFile("records.txt");
-    if (recordFile.is_open()) {
-        std::string line;
-        while (std::getline(recordFile, line)) {
-            size_t pos1 = line.find(',');
-            size_t pos2 = line.find(',', pos1 + 1);
-            size_t pos3 = line.find(',', pos2 + 1);
-            size_t pos4 = line.find(',', pos3 + 1);
-            size_t pos5 = line.find(',', pos4 + 1);
-            std::string bookTitle = line.substr(0, pos1);
-            std::string readerName = line.substr(pos1 + 1, pos2 - pos1 - 1);
-            std::time_t borrowDate = std::stol(line.substr(pos2 + 1, pos3 - pos2 - 1));
-            std::time_t dueDate = std::stol(line.substr(pos3 + 1, pos4 - pos3 - 1));
-            std::time_t returnDate = std::stol(line.substr(pos4 + 1, pos5 - pos4 - 1));
-            bool isReturned = (line.substr(pos5 + 1) == "1");
-            Book* book = findBook(bookTitle);
-            Reader* reader = findReader(readerName);
-            if (book && reader) {
-                borrowRecords.emplace_back(book, reader, borrowDate, dueDate);
-                if (isReturned) {
-                    borrowRecords.back().setReturnDate(returnDate);
-                }
+    std::string_view text = userFile.view();
+    while (!text.empty()) {
+        std::string_view line = textparse::nextLine(text);
+        std::string_view userType = textparse::nextField(line);
+        std::string username(textparse::nextField(line));
+        std::string password(textparse::nextField(line));
+        if (userType == "Administrator") {
+            addUser(userPool.create<Administrator>(username, password));
+        } else if (userType == "ReaderUser") {
+            Reader* reader = findReader(textparse::nextField(line));
+            if (reader) {
+                addUser(userPool.create<ReaderUser>(username, password, reader));
             }
         }
-        recordFile.close();
     }
+}
 
-    std::ifstream userFile("users.txt");
-    if (userFile.is_open()) {
-        std::string line;
-        while (std::getline(userFile, line)) {
-            size_t pos1 = line.find(',');
-            size_t pos2 = line.find(',', pos1 + 1);
-            size_t pos3 = line.find(',', pos2 + 1);
-            std::string userType = line.substr(0, pos1);
-            std::string username = line.substr(pos1 + 1, pos2 - pos1 - 1);
-            std::string password = line.substr(pos2 + 1, pos3 - pos2 - 1);
-            if (userType == "Administrator") {
-                users.push_back(std::make_unique<Administrator>(username, password));
-            } else if (userType == "ReaderUser") {
-                size_t pos4 = line.find(',', pos3 + 1);
-                std::string readerName = line.substr(pos3 + 1, pos4 - pos3 - 1);
-                Reader* reader = findReader(readerName);
-                if (reader) {
-                    users.push_back(std::make_unique<ReaderUser>(username, password, reader));
+ImportReport Library::bulkImport(ImportTarget target, const std::string& path) {
+    auto start = std::chrono::steady_clock::now();
+    MappedFile file(path);
+    if (!file.isOpen()) throw InvalidInputException("无法打开导入文件: " + path);
+    ParsedImport parsed;
+    {
+        ThreadPool pool;
+        parsed = parseImportFile(file.view(), target, pool);
+    }
+    ImportReport& report = parsed.report;
+    {
+        std::unique_lock<std::shared_mutex> lock(catalogMutex);
+        // 名称索引随插入更新，文件内的重复行也能在这里查出；检索和纠错索引在全部插入后只对新增部分补建一次
+        size_t first = target == ImportTarget::Books ? books.size() : readers.size();
+        if (target == ImportTarget::Books) {
+            books.reserve(books.size() + parsed.rows.size());
+            for (const ImportRow& row : parsed.rows) {
+                if (findBook(row.name)) {
+                    ++report.duplicates;
+                    continue;
+                }
+                auto category = static_cast<BookCategory>(row.kind);
+                Book* book = createBook(bookPool, category, std::string(categoryName(category)), row.name, row.author);
+                books.push_back(book);
+                bookIndex.emplace(book->getTitleSymbol(), book);
+                ++report.imported;
+            }
+            for (size_t i = first; i < books.size(); ++i) {
+                searchIndex.add(books[i]);
+                bookTitles.add(books[i]->getTitleSymbol());
+            }
+        } else {
+            readers.reserve(readers.size() + parsed.rows.size());
+            for (const ImportRow& row : parsed.rows) {
+                if (findReader(row.name)) {
+                    ++report.duplicates;
+                    continue;
                 }
+                Reader* reader = createReader(readerPool, static_cast<MemberTier>(row.kind), row.name);
+                readers.push_back(reader);
+                readerIndex.emplace(reader->getNameSymbol(), reader);
+                ++report.imported;
+            }
+            for (size_t i = first; i < readers.size(); ++i) readerNames.add(readers[i]->getNameSymbol());
+        }
+        // 导入的行不记日志，释放锁之前写快照：其他线程看到它们时快照已经包含它们，
+        // 否则之后的借阅记入日志却在重放时找不到图书 / 读者。快照写入失败时撤销本次插入
+        if (report.imported > 0) {
+            try {
+                metrics::track(MetricOp::SaveData, [&] { writeSnapshot(); });
+            } catch (...) {
+                if (target == ImportTarget::Books) {
+                    for (size_t i = first; i < books.size(); ++i) {
+                        searchIndex.remove(books[i]);
+                        bookTitles.remove(books[i]->getTitleSymbol());
+                        bookIndex.erase(books[i]->getTitleSymbol());
+                        bookPool.destroy(books[i]);
+                    }
+                    books.resize(first);
+                } else {
+                    for (size_t i = first; i < readers.size(); ++i) {
+                        readerNames.remove(readers[i]->getNameSymbol());
+                        readerIndex.erase(readers[i]->getNameSymbol());
+                        readerPool.destroy(readers[i]);
+                    }
+                    readers.resize(first);
+                }
+                throw;
             }
         }
-        userFile.close();
     }
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    report.peakMemoryKb = peakMemoryKb();
+    return report;
 }
 
 // 辅助方法
-Book* Library::findBook(const std::string& title) {
-    for (auto book : books) {
-        if (book->getTitle() == title) return book;
+Book* Library::findBook(std::string_view title) {
+    auto key = Symbol::find(title);
+    if (!key) return nullptr;
+    auto it = bookIndex.find(*key);
+    return it != bookIndex.end() ? it->second : nullptr;
+}
+
+Reader* Library::findReader(std::string_view name) {
+    auto key = Symbol::find(name);
+    if (!key) return nullptr;
+    auto it = readerIndex.find(*key);
+    return it != readerIndex.end() ? it->second : nullptr;
+}
+
+User* Library::findUser(std::string_view username) {
+    auto key = Symbol::find(username);
+    if (!key) return nullptr;
+    auto it = userIndex.find(*key);
+    return it != userIndex.end() ? it->second : nullptr;
+}
+
+void Library::addUser(User* user) {
+    auto readerUser = dynamic_cast<ReaderUser*>(user);
+    log(JournalEntry(JournalOp::AddUser)
+        .putByte(readerUser ? snapshot::ReaderAccount : snapshot::AdministratorUser)
+        .putString(user->getUsername()).putString(user->getPassword())
+        .putString(readerUser ? readerUser->getReader()->getName() : std::string_view()));
+    userIndex.emplace(user->getUsernameSymbol(), user);
+    users.push_back(user);
+}
+
+bool Library::deleteUser(const std::string& username) {
+    if (!findUser(username)) return false;
+    log(JournalEntry(JournalOp::DeleteUser).putString(username));
+    Symbol key = *Symbol::find(username);
+    eraseUsers([&](const User* user) { return user->getUsernameSymbol() == key; });
+    return true;
+}
+
+// 删除满足条件的用户并回收对象，返回删除的数量
+size_t Library::eraseUsers(const std::function<bool(const User*)>& match) {
+    auto it = std::stable_partition(users.begin(), users.end(), [&](const User* user) { return !match(user); });
+    size_t count = users.end() - it;
+    for (auto victim = it; victim != users.end(); ++victim) {
+        User* user = *victim;
+        auto indexIt = userIndex.find(user->getUsernameSymbol());
+        if (indexIt != userIndex.end() && indexIt->second == user) userIndex.erase(indexIt);
+        if (currentUser == user) currentUser = nullptr;
+        userPool.destroy(user);
     }
-    return nullptr;
+    users.erase(it, users.end());
+    return count;
 }
 
-Reader* Library::findReader(const std::string& name) {
-    for (auto reader : readers) {
-        if (reader->getName() == name) return reader;
+// 删除满足条件的借阅记录；记录下标随之变化，两个记录索引整体重建
+void Library::purgeRecords(const std::function<bool(const BorrowRecord&)>& match) {
+    if (borrowRecords.eraseIf(match) == 0) return;
+    recordIndex.rebuild(borrowRecords);
+    dueDateIndex.clear();
+    for (size_t i = 0; i < borrowRecords.size(); ++i) {
+        if (!borrowRecords.isReturned(i)) dueDateIndex.add(i, borrowRecords.dueDateAt(i));
     }
-    return nullptr;
 }
 
-User* Library::findUser(const std::string& username) {
-    for (const auto& user : users) {
-        if (user->getUsername() == username) {
-            return user.get();
+size_t Library::appendRecord(Book* book, uint32_t copy, Reader* reader, std::time_t borrowDate, std::time_t dueDate) {
+    size_t pos = borrowRecords.append(book, copy, reader, borrowDate, dueDate);
+    recordIndex.add(pos, borrowRecords[pos]);
+    dueDateIndex.add(pos, dueDate);
+    reader->openLoan();
+    return pos;
+}
+
+// 该读者对该书的未还借阅（copy 不为 kNone 时限定副本）：先查该书各副本的未还记录，
+// 数据异常时退回到该书自己的历史记录中查找
+size_t Library::findOpenLoan(const Book* book, const Reader* reader, uint32_t copy) const {
+    if (!book || !reader) return RecordIndex::npos;
+    auto matches = [&](size_t pos) {
+        return borrowRecords.readerAt(pos) == reader && (copy == CopySet::kNone || borrowRecords.copyAt(pos) == copy);
+    };
+    for (size_t pos : recordIndex.openLoansOf(book)) {
+        if (matches(pos)) return pos;
+    }
+    for (size_t candidate : recordIndex.recordsOf(book)) {
+        if (matches(candidate) && !borrowRecords.isReturned(candidate)) return candidate;
+    }
+    return RecordIndex::npos;
+}
+
+// 结清一笔借阅并计入罚款，返回结清后的记录。副本交给该书的下一位预约读者（写入 handedTo）或放回书架
+BorrowRecord Library::finishReturn(size_t pos, std::time_t returnDate, Hold* handedTo) {
+    std::unique_lock<std::mutex> recordLock(recordMutex);
+    closeRecord(pos, returnDate);
+    const BorrowRecord record = borrowRecords[pos];
+    recordLock.unlock();
+    {
+        std::lock_guard<std::mutex> holdLock(holdMutex);
+        uint32_t id = releaseCopy(record.getBook(), record.getCopy(), returnDate);
+        if (handedTo && id != HoldQueue::npos) *handedTo = holds[id];
+    }
+    double fine = record.calculateFine();
+    if (fine > 0) record.getReader()->addFine(fine);
+    return record;
+}
+
+// 副本交给该书优先级最高的排队读者，保留到 now 起 kPickupDays 天后；没有排队的读者时放回书架。
+// 返回得到副本的预约编号，放回书架时为 npos
+uint32_t Library::releaseCopy(Book* book, uint32_t copy, std::time_t now) {
+    uint32_t id = holds.assign(book, copy, now + static_cast<std::time_t>(HoldQueue::kPickupDays) * DateUtils::kSecondsPerDay);
+    if (id == HoldQueue::npos) book->returnCopy(copy);
+    return id;
+}
+
+// 取消、逾期或删除读者时移除一条预约，已保留的副本转给下一位
+void Library::dropHold(uint32_t id, std::time_t now) {
+    const Hold hold = holds[id];
+    holds.remove(id);
+    if (hold.isReady()) releaseCopy(hold.book, hold.copy, now);
+}
+
+// 新增副本后把在架副本依次保留给排队的读者，保持 "有人排队时没有在架副本"
+void Library::offerCopies(Book* book, std::time_t now) {
+    while (book->getAvailableCopies() > 0 && holds.waitingCount(book) > 0) {
+        holds.assign(book, book->borrowCopy(), now + static_cast<std::time_t>(HoldQueue::kPickupDays) * DateUtils::kSecondsPerDay);
+    }
+}
+
+// 按保存的状态恢复一条预约：已保留的副本从书架上取下，该副本不在架（数据不一致）时改保留其他在架副本，
+// 都不在架时继续排队
+void Library::restoreHold(Book* book, Reader* reader, std::time_t placed, std::time_t deadline, uint32_t copy) {
+    if (holds.find(book, reader) != HoldQueue::npos) return;
+    uint32_t id = holds.place(book, reader, placed);
+    if (deadline == 0) return;
+    if (!book->borrowCopy(copy)) copy = book->borrowCopy();
+    if (copy != CopySet::kNone) holds.markReady(id, copy, deadline);
+}
+
+void Library::expireHolds(std::time_t now) {
+    if (now < nextHoldCheck.load(std::memory_order_acquire)) return;
+    std::vector<Book*> due;
+    {
+        std::lock_guard<std::mutex> holdLock(holdMutex);
+        if (now < nextHoldCheck.load(std::memory_order_relaxed)) return;
+        std::vector<uint32_t> expired;
+        holds.expire(now, expired);
+        for (uint32_t id : expired) due.push_back(holds[id].book);
+        nextHoldCheck.store(holds.nextCheck(), std::memory_order_release);
+    }
+    // 取出后到加锁前保留可能已被借走；同一本书出现多次时，后几次已没有逾期的保留
+    for (size_t i = 0; i < due.size(); ++i) {
+        try {
+            StripeGuard entityLock(entityLocks, due[i]);
+            expireHoldsOf(due[i], now);
+        } catch (...) {
+            // 写日志失败：尚未移除的逾期保留已从时间轮取出，重新登记，留到下次检查
+            std::lock_guard<std::mutex> holdLock(holdMutex);
+            for (size_t j = i; j < due.size(); ++j) {
+                for (uint32_t id : holds.overdueOf(due[j], now)) holds.reschedule(id);
+            }
+            nextHoldCheck.store(holds.nextCheck(), std::memory_order_release);
+            throw;
         }
     }
-    return nullptr;
+}
+
+// 调用方持有该书的分片锁
+void Library::expireHoldsOf(Book* book, std::time_t now) {
+    std::vector<std::pair<uint32_t, const Reader*>> overdue;
+    {
+        std::lock_guard<std::mutex> holdLock(holdMutex);
+        for (uint32_t id : holds.overdueOf(book, now)) overdue.emplace_back(id, holds[id].reader);
+    }
+    // 逐条先写日志再移除
+    for (const auto& [id, reader] : overdue) {
+        log(JournalEntry(JournalOp::ExpireHold).putString(book->getTitle()).putString(reader->getName()).putInt(now));
+        std::lock_guard<std::mutex> holdLock(holdMutex);
+        dropHold(id, now);
+    }
+}
+
+void Library::closeRecord(size_t pos, std::time_t returnDate) {
+    // 撤销这笔借阅在上次结转时计入的超期数和应计罚款
+    const BorrowRecord open = borrowRecords[pos];
+    open.getReader()->closeLoan(open.getOverdueDays(accountCutoff) > 0, open.calculateFine(accountCutoff));
+    borrowRecords.markReturned(pos, returnDate);
+    recordIndex.markReturned(pos, borrowRecords[pos]);
+    dueDateIndex.remove(pos, borrowRecords.dueDateAt(pos));
+}
+
+void Library::rolloverAccounts(std::time_t now, bool force) {
+    if (!force && now < nextRollover.load(std::memory_order_acquire)) return;
+    std::lock_guard<std::mutex> recordLock(recordMutex);
+    if (!force && now < nextRollover.load(std::memory_order_relaxed)) return;
+    // 只遍历超期的未还借阅，超期口径与 overdueReport 一致（满一整天）
+    std::unordered_map<Reader*, std::pair<int, double>> overdue;
+    auto range = dueDateIndex.dueBefore(now - DateUtils::kSecondsPerDay + 1);
+    for (auto it = range.first; it != range.second; ++it) {
+        const BorrowRecord record = borrowRecords[it->second];
+        auto& entry = overdue[record.getReader()];
+        ++entry.first;
+        entry.second += record.calculateFine(now);
+    }
+    for (Reader* reader : readers) {
+        auto it = overdue.find(reader);
+        if (it == overdue.end()) {
+            reader->setOverdue(0, 0.0);
+        } else {
+            reader->setOverdue(it->second.first, it->second.second);
+        }
+    }
+    accountCutoff = now;
+    nextRollover.store(now + DateUtils::kSecondsPerDay, std::memory_order_release);
+}
+
+FineAccrualReport Library::accrueFines(std::time_t now, size_t threads) const {
+    auto start = std::chrono::steady_clock::now();
+    OpenLoans loans;
+    {
+        std::shared_lock<std::shared_mutex> catalogLock(catalogMutex);
+        std::lock_guard<std::mutex> recordLock(recordMutex);
+        loans.reserve(dueDateIndex.size());
+        auto range = dueDateIndex.dueBefore(std::numeric_limits<std::time_t>::max());
+        for (auto it = range.first; it != range.second; ++it) {
+            const Reader* reader = borrowRecords.readerAt(it->second);
+            loans.add(reader->getNameSymbol(), it->first, borrowRecords.bookAt(it->second)->getCategory(), reader->getTier());
+        }
+    }
+    ThreadPool pool(threads);
+    FineAccrualReport report = computeFineAccrual(loans, now, pool);
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return report;
+}
+
+FineAccrualReport Library::runFineAccrualJob() const {
+    FineAccrualReport report = accrueFines(DateUtils::getCurrentTime());
+    std::ofstream out(kFineReportFile);
+    if (!out) throw std::runtime_error(std::string("无法写入罚款预估报表: ") + kFineReportFile);
+    writeFineAccrualReport(out, report);
+    return report;
+}
+
+MetricsGauges Library::metricsGauges() const {
+    std::shared_lock<std::shared_mutex> catalogLock(catalogMutex);
+    MetricsGauges gauges;
+    gauges.books = books.size();
+    gauges.readers = readers.size();
+    for (const Reader* reader : readers) gauges.outstandingFines += reader->getFine();
+    {
+        std::lock_guard<std::mutex> holdLock(holdMutex);
+        gauges.readyHolds = holds.readyTotal();
+        gauges.waitingHolds = holds.size() - gauges.readyHolds;
+    }
+    std::lock_guard<std::mutex> recordLock(recordMutex);
+    gauges.openLoans = dueDateIndex.size();
+    gauges.residentRecords = borrowRecords.size();
+    gauges.historyRecords = history.recordCount();
+    return gauges;
+}
+
+void Library::displayMetrics() const {
+    metrics::writeReport(std::cout, metrics::snapshot(), metricsGauges());
+}
+
+void Library::startMetricsDump(const std::string& path, std::chrono::seconds interval) {
+    metricsDumper = std::make_unique<MetricsDumper>(path, interval, [this] { return metricsGauges(); });
 }
 
 int Library::countBooks() const { return books.size(); }
 
 int Library::countReaders() const { return readers.size(); }
 
+// 借出中的副本数（不在架的副本中去掉为预约读者保留的）
 int Library::countBorrowedBooks() const {
-    return std::count_if(books.begin(), books.end(), 
-        [](Book* b) { return b->isBorrowedStatus(); });
+    int borrowed = 0;
+    for (const Book* book : books) borrowed += book->getCopyCount() - book->getAvailableCopies();
+    return borrowed - static_cast<int>(holds.readyTotal());
 }
 
 // 菜单系统
@@ -422,9 +1697,11 @@ void Library::bookManagementMenu() {
         std::cout << std::setw(4) << " " << " 2. 删除图书\n";
         std::cout << std::setw(4) << " " << " 3. 查找图书\n";
         std::cout << std::setw(4) << " " << " 4. 显示所有图书\n";
-        std::cout << std::setw(4) << " " << " 5. 返回主菜单\n";
+        std::cout << std::setw(4) << " " << " 5. 按关键词搜索图书\n";
+        std::cout << std::setw(4) << " " << " 6. 批量导入图书（CSV / TSV）\n";
+        std::cout << std::setw(4) << " " << " 7. 返回主菜单\n";
         int choice;
-        std::cout << "请输入选项 (1-5): ";
+        std::cout << "请输入选项 (1-7): ";
         if (!(std::cin >> choice)) {
             clearInputBuffer();
             std::cerr << "\033[1;31m[错误] 请输入有效的数字选项！\033[0m\n";
@@ -451,14 +1728,24 @@ void Library::bookManagementMenu() {
                         clearInputBuffer();
                         Book* newBook = nullptr;
                         switch (typeChoice) {
-                            case 1: newBook = new Textbook(title, author); break;
-                            case 2: newBook = new Novel(title, author); break;
-                            case 3: newBook = new Magazine(title, author); break;
-                            case 4: newBook = new Book(title, author); break;
+                            case 1: newBook = makeBook<Textbook>(title, author); break;
+                            case 2: newBook = makeBook<Novel>(title, author); break;
+                            case 3: newBook = makeBook<Magazine>(title, author); break;
+                            case 4: newBook = makeBook<Book>(title, author); break;
                             default:
                                 std::cerr << "\033[1;31m[错误] 无效的类型选择！\033[0m\n";
                                 continue;
                         }
+                        std::string copiesText;
+                        std::cout << "册数（直接回车为 1 册；书名已存在时作为新增副本）: ";
+                        std::getline(std::cin, copiesText);
+                        uint32_t copies = 1;
+                        if (!copiesText.empty()
+                            && (!textparse::parseNumber(copiesText, copies) || copies == 0 || copies > CopySet::kMaxCopies)) {
+                            std::cerr << "\033[1;31m[错误] 册数无效，按 1 册添加\033[0m\n";
+                            copies = 1;
+                        }
+                        if (copies > 1) newBook->addCopies(copies - 1);
                         addBook(newBook);
                         std::cout << "\033[1;32m[成功] ✔ 图书添加成功！\033[0m\n";
                         break;
@@ -486,7 +1773,23 @@ void Library::bookManagementMenu() {
                     printSectionHeader("所有图书");
                     displayBooks();
                     break;
-                case 5:
+                case 5: {
+                    printSectionHeader("搜索图书");
+                    std::string query;
+                    std::cout << "请输入书名或作者关键词（空格分隔多个关键词，末尾加 * 按前缀匹配）: ";
+                    std::getline(std::cin, query);
+                    displaySearchResults(query);
+                    break;
+                }
+                case 6: {
+                    printSectionHeader("批量导入图书");
+                    std::string path;
+                    std::cout << "每行格式：类型,书名,作者（类型为 教科书 / 小说 / 杂志 / 普通图书）\n请输入文件路径: ";
+                    std::getline(std::cin, path);
+                    writeImportReport(std::cout, bulkImport(ImportTarget::Books, path));
+                    break;
+                }
+                case 7:
                     return;
                 default:
                     std::cerr << "\033[1;31m[错误] 无效的选项，请重新输入！\033[0m\n";
@@ -507,9 +1810,10 @@ void Library::readerManagementMenu() {
         std::cout << std::setw(4) << " " << " 2. 删除读者\n";
         std::cout << std::setw(4) << " " << " 3. 查找读者\n";
         std::cout << std::setw(4) << " " << " 4. 显示所有读者\n";
-        std::cout << std::setw(4) << " " << " 5. 返回主菜单\n";
+        std::cout << std::setw(4) << " " << " 5. 批量导入读者（CSV / TSV）\n";
+        std::cout << std::setw(4) << " " << " 6. 返回主菜单\n";
         int choice;
-        std::cout << "请输入选项 (1-5): ";
+        std::cout << "请输入选项 (1-6): ";
         if (!(std::cin >> choice)) {
             clearInputBuffer();
             std::cerr << "\033[1;31m[错误] 请输入有效的数字选项！\033[0m\n";
@@ -534,9 +1838,9 @@ void Library::readerManagementMenu() {
                         clearInputBuffer();
                         Reader* newReader = nullptr;
                         switch (typeChoice) {
-                            case 1: newReader = new RegularMember(name); break;
-                            case 2: newReader = new VIPMember(name); break;
-                            case 3: newReader = new StudentMember(name); break;
+                            case 1: newReader = makeReader<RegularMember>(name); break;
+                            case 2: newReader = makeReader<VIPMember>(name); break;
+                            case 3: newReader = makeReader<StudentMember>(name); break;
                             default:
                                 std::cerr << "\033[1;31m[错误] 无效的类型选择！\033[0m\n";
                                 continue;
@@ -568,7 +1872,15 @@ void Library::readerManagementMenu() {
                     printSectionHeader("所有读者");
                     displayReaders();
                     break;
-                case 5:
+                case 5: {
+                    printSectionHeader("批量导入读者");
+                    std::string path;
+                    std::cout << "每行格式：会员类型,姓名（会员类型为 普通会员 / VIP会员 / 学生会员）\n请输入文件路径: ";
+                    std::getline(std::cin, path);
+                    writeImportReport(std::cout, bulkImport(ImportTarget::Readers, path));
+                    break;
+                }
+                case 6:
                     return;
                 default:
                     std::cerr << "\033[1;31m[错误] 无效的选项，请重新输入！\033[0m\n";
@@ -614,20 +1926,20 @@ void Library::registerUser() {
             clearInputBuffer();
             Reader* newReader = nullptr;
             switch (readerTypeChoice) {
-                case 1: newReader = new RegularMember(readerName); break;
-                case 2: newReader = new VIPMember(readerName); break;
-                case 3: newReader = new StudentMember(readerName); break;
+                case 1: newReader = makeReader<RegularMember>(readerName); break;
+                case 2: newReader = makeReader<VIPMember>(readerName); break;
+                case 3: newReader = makeReader<StudentMember>(readerName); break;
                 default:
                     std::cerr << "\033[1;31m[错误] 无效的读者类型选择！\033[0m\n";
                     continue;
             }
             addReader(newReader);
-            users.push_back(std::make_unique<ReaderUser>(username, password, newReader));
+            addUser(userPool.create<ReaderUser>(username, password, newReader));
             std::cout << "\033[1;32m[成功] ✔ 读者用户注册成功！\033[0m\n";
             break;
         } while (true);
     } else if (userTypeChoice == 2) {
-        users.push_back(std::make_unique<Administrator>(username, password));
+        addUser(userPool.create<Administrator>(username, password));
         std::cout << "\033[1;32m[成功] ✔ 管理员用户注册成功！\033[0m\n";
     }
 }
@@ -640,9 +1952,9 @@ void Library::adminViewAllUsers() {
     std::cout << "👥 所有用户信息：\n";
     for (const auto& user : users) {
         std::cout << "用户名: " << user->getUsername();
-        if (dynamic_cast<Administrator*>(user.get())) {
+        if (dynamic_cast<Administrator*>(user)) {
             std::cout << ", 用户类型: 管理员\n";
-        } else if (auto readerUser = dynamic_cast<ReaderUser*>(user.get())) {
+        } else if (auto readerUser = dynamic_cast<ReaderUser*>(user)) {
             std::cout << ", 用户类型: 读者, 读者姓名: " << readerUser->getReader()->getName() << "\n";
         }
     }
@@ -656,12 +1968,9 @@ void Library::adminDeleteUser() {
     std::string username;
     std::cout << "请输入要删除的用户名: ";
     std::getline(std::cin, username);
-    auto it = std::remove_if(users.begin(), users.end(), 
-        [&](const std::unique_ptr<User>& user) { return user->getUsername() == username; });
-    if (it == users.end()) {
+    if (!deleteUser(username)) {
         std::cout << "\033[1;31m[错误] 未找到该用户！\033[0m\n";
     } else {
-        users.erase(it, users.end());
         std::cout << "\033[1;32m[成功] ✔ 用户删除成功！\033[0m\n";
     }
 }
@@ -672,11 +1981,16 @@ bool Library::login() {
     std::getline(std::cin, username);
     std::cout << "请输入密码: ";
     std::getline(std::cin, password);
-    currentUser = findUser(username);
-    if (currentUser && currentUser->verifyPassword(password)) {
+    auto start = std::chrono::steady_clock::now();
+    User* user = findUser(username);
+    bool verified = user && user->verifyPassword(password);
+    metrics::record(MetricOp::Login, verified ? MetricOutcome::Success : MetricOutcome::Rejected, metrics::elapsedSince(start));
+    if (verified) {
+        currentUser = user;
         std::cout << "\033[1;32m[成功] ✔ 登录成功！\033[0m\n";
         return true;
     } else {
+        std::cerr << "\033[1;31m[错误] 用户名或密码错误！\033[0m\n";
         return false;
     }
 }
@@ -719,7 +2033,10 @@ void Library::mainMenu() {
                 std::cout << std::setw(4) << " " << " 5. 查看即将到期图书\n";
                 std::cout << std::setw(4) << " " << " 6. 查看所有用户信息\n";
                 std::cout << std::setw(4) << " " << " 7. 删除用户\n";
-                std::cout << std::setw(4) << " " << " 8. 注销登录\n";
+                std::cout << std::setw(4) << " " << " 8. 导出文本数据\n";
+                std::cout << std::setw(4) << " " << " 9. 查看运行指标\n";
+                std::cout << std::setw(4) << " " << "10. 罚款预估报表\n";
+                std::cout << std::setw(4) << " " << "11. 注销登录\n";
             } else {
                 auto readerUser = dynamic_cast<ReaderUser*>(currentUser);
                 if (readerUser) {
@@ -727,7 +2044,9 @@ void Library::mainMenu() {
                     std::cout << std::setw(4) << " " << " 2. 归还图书\n";
                     std::cout << std::setw(4) << " " << " 3. 支付罚款\n";
                     std::cout << std::setw(4) << " " << " 4. 查看个人借阅记录\n";
-                    std::cout << std::setw(4) << " " << " 5. 注销登录\n";
+                    std::cout << std::setw(4) << " " << " 5. 预约图书\n";
+                    std::cout << std::setw(4) << " " << " 6. 取消预约\n";
+                    std::cout << std::setw(4) << " " << " 7. 注销登录\n";
                 }
             }
             int choice;
@@ -763,6 +2082,21 @@ void Library::mainMenu() {
                             adminDeleteUser();
                             break;
                         case 8:
+                            exportText();
+                            std::cout << "\033[1;32m[成功] ✔ 已导出到 books.txt / readers.txt / records.txt / holds.txt / users.txt\033[0m\n";
+                            break;
+                        case 9:
+                            printSectionHeader("运行指标");
+                            displayMetrics();
+                            break;
+                        case 10: {
+                            printSectionHeader("罚款预估报表");
+                            FineAccrualReport report = runFineAccrualJob();
+                            writeFineAccrualReport(std::cout, report, 10);
+                            std::cout << "\033[1;32m[成功] ✔ 完整报表已写入 " << kFineReportFile << "\033[0m\n";
+                            break;
+                        }
+                        case 11:
                             currentUser = nullptr;
                             break;
                         default:
@@ -776,14 +2110,27 @@ void Library::mainMenu() {
                                 std::string bookTitle;
                                 std::cout << "请输入要借阅的书名: ";
                                 std::getline(std::cin, bookTitle);
-                                borrowBook(bookTitle, readerUser->getReader()->getName());
+                                try {
+                                    printOperationResult(borrowBook(bookTitle, std::string(readerUser->getReader()->getName())));
+                                } catch (const BookNotFoundException& ex) {
+                                    std::cerr << "\033[1;31m[错误] " << ex.what() << "\033[0m\n";
+                                    printSuggestions(suggestBooks(bookTitle));
+                                } catch (const BookBorrowedException& ex) {
+                                    std::cerr << "\033[1;31m[错误] " << ex.what() << "\033[0m\n";
+                                    std::cout << "\033[1;33m可选择 5 预约该书，有副本归还时将为您保留\033[0m\n";
+                                }
                                 break;
                             }
                             case 2: {
                                 std::string bookTitle;
                                 std::cout << "请输入要归还的书名: ";
                                 std::getline(std::cin, bookTitle);
-                                returnBook(bookTitle, readerUser->getReader()->getName());
+                                try {
+                                    printOperationResult(returnBook(bookTitle, std::string(readerUser->getReader()->getName())));
+                                } catch (const BookNotFoundException& ex) {
+                                    std::cerr << "\033[1;31m[错误] " << ex.what() << "\033[0m\n";
+                                    printSuggestions(suggestBooks(bookTitle));
+                                }
                                 break;
                             }
                             case 3: {
@@ -791,13 +2138,33 @@ void Library::mainMenu() {
                                 std::cout << "请输入要支付的罚款金额（输入 -1 全额支付）: ";
                                 std::cin >> amount;
                                 clearInputBuffer();
-                                payFine(readerUser->getReader()->getName(), amount);
+                                printOperationResult(payFine(std::string(readerUser->getReader()->getName()), amount));
                                 break;
                             }
                             case 4:
-                                searchReader(readerUser->getReader()->getName());
+                                searchReader(std::string(readerUser->getReader()->getName()));
+                                break;
+                            case 5: {
+                                std::string bookTitle;
+                                std::cout << "请输入要预约的书名: ";
+                                std::getline(std::cin, bookTitle);
+                                try {
+                                    printOperationResult(placeHold(bookTitle, std::string(readerUser->getReader()->getName())));
+                                } catch (const BookNotFoundException& ex) {
+                                    std::cerr << "\033[1;31m[错误] " << ex.what() << "\033[0m\n";
+                                    printSuggestions(suggestBooks(bookTitle));
+                                }
                                 break;
-                            case 5:
+                            }
+                            case 6: {
+                                std::string bookTitle;
+                                std::cout << "请输入要取消预约的书名: ";
+                                std::getline(std::cin, bookTitle);
+                                cancelHold(bookTitle, std::string(readerUser->getReader()->getName()));
+                                std::cout << "\033[1;32m[成功] ✔ 预约已取消\033[0m\n";
+                                break;
+                            }
+                            case 7:
                                 currentUser = nullptr;
                                 break;
                             default:
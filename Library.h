@@ -1,60 +1,136 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <string_view>
 #include <memory>
+#include <optional>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
 #include <unordered_map>
 #include "Book.h"
+#include "BulkImport.h"
 #include "Reader.h"
 #include "BorrowRecord.h"
 #include "User.h"
 #include "Exceptions.h"
 #include "DateUtils.h"
+#include "Symbol.h"
+#include "RecordStore.h"
+#include "RecordIndex.h"
+#include "DueDateIndex.h"
+#include "FineAccrual.h"
+#include "Snapshot.h"
+#include "Journal.h"
+#include "ObjectPool.h"
+#include "LockStripes.h"
+#include "OperationResult.h"
+#include "SearchIndex.h"
+#include "FuzzyIndex.h"
+#include "Metrics.h"
+#include "HistoryStore.h"
+#include "HoldQueue.h"
+
+using BookPool = ObjectPool<Book, Book, Textbook, Novel, Magazine>;
+using ReaderPool = ObjectPool<Reader, Reader, RegularMember, VIPMember, StudentMember>;
+using UserPool = ObjectPool<User, User, Administrator, ReaderUser>;
 
 class Library {
 public:
-    Library(double baseFinePerDay = 1.0);
+    // historyDays：归还超过该天数的记录在保存快照时移入历史文件，<= 0 表示全部留在内存
+    Library(double baseFinePerDay = 1.0, JournalOptions journalOptions = {}, int historyDays = 90);
     ~Library();
     
     void clearInputBuffer();
     void printSectionHeader(const std::string& title);
     
-    // 图书管理
+    // 图书 / 读者对象由库内的对象池创建，addBook / addReader 只接受这样创建的对象，
+    // 删除后由对象池回收
+    template <typename T, typename... Args>
+    T* makeBook(Args&&... args) {
+        std::unique_lock<std::shared_mutex> lock(catalogMutex);
+        return bookPool.create<T>(std::forward<Args>(args)...);
+    }
+    template <typename T, typename... Args>
+    T* makeReader(Args&&... args) {
+        std::unique_lock<std::shared_mutex> lock(catalogMutex);
+        return readerPool.create<T>(std::forward<Args>(args)...);
+    }
+
+    // 并发约定：借阅、归还、支付和查询可由多个柜台线程同时调用。
+    // 它们持有目录共享锁，再按图书 / 读者所在分片加锁，涉及不同图书和读者的操作互不阻塞；
+    // 增删图书 / 读者、saveData、exportText 持有目录独占锁。loadData 和菜单只在单线程中使用。
+
+    // 图书管理：同名图书已在目录中时 book 的副本并入已有条目，book 随即回收，调用方不应再使用它
     void addBook(Book* book);
     void removeBook(const std::string& title);
     
-    // 读者管理
+    // 读者管理：删除读者时其预约一并取消，为其保留的副本转给下一位预约读者（now 为删除时间，重放日志时取日志中的时间）
     void addReader(Reader* reader);
-    void removeReader(const std::string& name);
-    
-    // 借阅功能
-    void borrowBook(const std::string& bookTitle, const std::string& readerName);
+    void removeReader(const std::string& name, std::time_t now = DateUtils::getCurrentTime());
     
-    // 归还功能
-    void returnBook(const std::string& bookTitle, const std::string& readerName);
-    
-    // 支付功能
-    void payFine(const std::string& readerName, double amount = -1);
+    // 借阅 / 归还 / 支付：不做控制台输入输出，结果以结构体返回，失败时抛出异常
+    OperationResult borrowBook(const std::string& bookTitle, const std::string& readerName);
+    OperationResult returnBook(const std::string& bookTitle, const std::string& readerName);
+    OperationResult payFine(const std::string& readerName, double amount = -1);
+    // 读者账户汇总（在借、超期、应计罚款、欠款、累计借阅），O(1) 读取，不扫描借阅记录
+    AccountSummary readerAccount(const std::string& readerName);
+    // 预约：所有副本都不在架时加入该书的预约队列，VIP 会员优先，其次学生会员、普通会员，同级先到先得。
+    // 副本归还时直接为队首读者保留 HoldQueue::kPickupDays 天，期间只有该读者能借走，逾期未借转给下一位；
+    // 取消已保留的预约时副本同样转给下一位。失败时抛出异常
+    OperationResult placeHold(const std::string& bookTitle, const std::string& readerName);
+    void cancelHold(const std::string& bookTitle, const std::string& readerName);
     
     // 显示功能
     void displayBooks() const;
     void displayReaders() const;
     void searchBook(const std::string& bookTitle) const;
+    void displaySearchResults(const std::string& query) const;
     void searchReader(const std::string& readerName) const;
     void displayBorrowRecords() const;
     void displayOverdueBooks() const;
     void displayBooksDueSoon(int days = 3) const;
+    // 报表数据（不做输出）
+    LoanReport overdueReport(std::time_t now) const;
+    LoanReport dueSoonReport(int days, std::time_t now) const;
+    // 罚款预估批处理：只在复制未还借阅时短暂持有目录共享锁和记录锁，计算在线程池上进行，柜台可同时借还
+    FineAccrualReport accrueFines(std::time_t now, size_t threads = std::thread::hardware_concurrency()) const;
+    // 按当前时间运行批处理并把完整报表写入 fine_report.txt（启动时或由管理员菜单调用）
+    FineAccrualReport runFineAccrualJob() const;
+    // 按书名 / 作者关键词检索（不做输出）
+    std::vector<SearchHit> searchBooks(std::string_view query, SearchMode mode = SearchMode::Substring, size_t limit = 20) const;
+    // 名称拼写有误时的候选（"您是不是要找"），按编辑距离升序
+    std::vector<FuzzyMatch> suggestBooks(std::string_view title, size_t k = 3) const;
+    std::vector<FuzzyMatch> suggestReaders(std::string_view name, size_t k = 3) const;
     
-    // 数据持久化
+    // 数据持久化：默认读写二进制快照，文本文件作为导入 / 导出格式保留。
+    // 每次修改先追加到操作日志，saveData 写出新快照并清空日志，同时把归还已久的记录移入历史文件；
+    // 查询图书 / 读者的借阅记录时合并内存和历史文件两部分。
     void saveData();
     void loadData();
+    void exportText();
+    void importText();
+    // 从 CSV / TSV 文件批量导入图书或读者（格式见 BulkImport.h）：与目录中已有的或文件中前面的同名条目重复的行跳过，
+    // 其余在一次目录独占锁内全部插入，
+    // 之后一次性补建检索 / 纠错索引，并在释放锁之前写一次快照代替逐行记日志（写入失败时撤销本次插入并抛出）。
+    // 文件无法打开时抛出 InvalidInputException
+    ImportReport bulkImport(ImportTarget target, const std::string& path);
     
     // 辅助方法
-    Book* findBook(const std::string& title);
-    Reader* findReader(const std::string& name);
-    User* findUser(const std::string& username);
+    Book* findBook(std::string_view title);
+    Reader* findReader(std::string_view name);
+    User* findUser(std::string_view username);
     int countBooks() const;
     int countReaders() const;
     int countBorrowedBooks() const;
+
+    // 运行指标：延迟直方图和失败计数见 Metrics.h，状态量在读取时计算
+    MetricsGauges metricsGauges() const;
+    void displayMetrics() const;
+    // 启动后台线程，每隔 interval 把指标报告写入 path；Library 析构前再写一次
+    void startMetricsDump(const std::string& path, std::chrono::seconds interval);
     
     // 菜单系统
     void bookManagementMenu();
@@ -66,10 +142,78 @@ public:
     void mainMenu();
 
 private:
+    void addUser(User* user);
+    bool deleteUser(const std::string& username);
+    size_t eraseUsers(const std::function<bool(const User*)>& match);
+    void purgeRecords(const std::function<bool(const BorrowRecord&)>& match);
+    void clearData();
+    void rebuildIndexes();
+    std::pair<Book*, uint32_t> insertBook(Book* book);
+    void loadFinePolicy();
+    size_t appendRecord(Book* book, uint32_t copy, Reader* reader, std::time_t borrowDate, std::time_t dueDate);
+    void closeRecord(size_t pos, std::time_t returnDate);
+    // 每日结转：距上次结转满一天（或 force）时按应还日期索引重算各读者的超期数和应计罚款。
+    // 调用方持有目录锁，不持有记录锁和分片锁
+    void rolloverAccounts(std::time_t now, bool force = false);
+    void loadSnapshot(const SnapshotReader& snapshot);
+    // saveData 的主体，调用方持有目录独占锁
+    void writeSnapshot();
+    size_t findOpenLoan(const Book* book, const Reader* reader, uint32_t copy = CopySet::kNone) const;
+    BorrowRecord finishReturn(size_t pos, std::time_t returnDate, Hold* handedTo = nullptr);
+    // 预约队列的维护：调用方持有该书的分片锁（或目录独占锁）和 holdMutex
+    uint32_t releaseCopy(Book* book, uint32_t copy, std::time_t now);
+    void dropHold(uint32_t id, std::time_t now);
+    void offerCopies(Book* book, std::time_t now);
+    void restoreHold(Book* book, Reader* reader, std::time_t placed, std::time_t deadline, uint32_t copy);
+    // 处理取书期限已过的保留，时间轮每小时最多推进一次。调用方持有目录锁，不持有分片锁和 holdMutex
+    void expireHolds(std::time_t now);
+    void expireHoldsOf(Book* book, std::time_t now);
+    // 修改状态之前调用：写入失败时抛出异常，调用方尚未改动任何状态
+    void log(const JournalEntry& entry);
+    void openHistory(bool fromSnapshot);
+    // 历史文件中按书名 / 读者姓名读出的记录（key 为空时读出全部），转换为当前对象上的视图后输出
+    size_t displayHistory(std::optional<HistoryKey> key, std::string_view name, std::time_t now) const;
+    void applyJournalEntry(JournalEntry& entry);
+
+    BookPool bookPool;
+    ReaderPool readerPool;
+    UserPool userPool;
     std::vector<Book*> books;
     std::vector<Reader*> readers;
-    std::vector<BorrowRecord> borrowRecords;
-    std::vector<std::unique_ptr<User>> users;
+    RecordStore borrowRecords;
+    RecordIndex recordIndex;
+    DueDateIndex dueDateIndex;
+    // 上次账户结转的时间（受 recordMutex 保护）和下次结转的时间
+    std::time_t accountCutoff = 0;
+    std::atomic<std::time_t> nextRollover{ 0 };
+    // 预约队列（受 holdMutex 保护）和下次推进取书期限时间轮的时间
+    HoldQueue holds;
+    std::atomic<std::time_t> nextHoldCheck{ 0 };
+    // 冷数据层：内存中只保留未还和近期归还的记录
+    HistoryStore history;
+    int historyDays;
+    // 检索索引：增删图书 / 读者时增量维护，loadData 期间暂停，结束时整体重建
+    SearchIndex searchIndex;
+    FuzzyIndex bookTitles;
+    FuzzyIndex readerNames;
+    bool deferIndexes = false;
+    std::vector<User*> users;
+    // 按书名 / 读者姓名 / 用户名建立的哈希索引，同名时保留最先加入的对象（与线性查找的结果一致）。
+    // 键为驻留字符串句柄，查找时先在驻留表中定位，再按句柄比较。
+    std::unordered_map<Symbol, Book*> bookIndex;
+    std::unordered_map<Symbol, Reader*> readerIndex;
+    std::unordered_map<Symbol, User*> userIndex;
     User* currentUser = nullptr;
     double baseFinePerDay;
+    JournalOptions journalOptions;
+    std::unique_ptr<Journal> journal;
+    uint64_t journalGeneration = 0;
+    // 目录锁保护图书 / 读者集合及索引；分片锁串行化同一图书或读者上的借还；
+    // recordMutex 只在追加 / 结清 / 读取借阅记录表及其索引时短暂持有，holdMutex 只在读写预约队列时短暂持有，两者不嵌套
+    mutable std::shared_mutex catalogMutex;
+    LockStripes entityLocks;
+    mutable std::mutex recordMutex;
+    mutable std::mutex holdMutex;
+    // 最后声明、最先析构：停止写指标的线程之后其余成员才开始析构
+    std::unique_ptr<MetricsDumper> metricsDumper;
 };
\ No newline at end of file
@@ -0,0 +1,286 @@
+#include "LoanArchive.h"
+#include "Crc32.h"
+#include "Exceptions.h"
+#include "FileSync.h"
+#include "Varint.h"
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <numeric>
+#include <stdexcept>
+
+namespace {
+    constexpr char kMagic[8] = { 'L', 'I', 'B', 'L', 'O', 'A', 'N', '\0' };
+    // 版本 2 起数据块可带副本编号列（见 BlockInfo::flags），版本 1 的文件仍可读取
+    constexpr uint32_t kVersion = 2;
+
+    struct Section {
+        uint64_t offset;
+        uint64_t bytes;
+    };
+
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t headerSize;
+        uint64_t rowCount;
+        uint64_t nameCount;
+        uint64_t blockCount;
+        Section data;
+        Section names;
+        Section index;  // BlockInfo[blockCount]
+    };
+
+    // 按列内最大值的位宽紧凑存放，低位在前
+    void packColumn(std::string& out, const std::vector<uint32_t>& values) {
+        uint32_t maxValue = values.empty() ? 0 : *std::max_element(values.begin(), values.end());
+        int width = std::bit_width(maxValue);
+        out.push_back(static_cast<char>(width));
+        uint64_t pending = 0;
+        int bits = 0;
+        for (uint32_t value : values) {
+            pending |= static_cast<uint64_t>(value) << bits;
+            for (bits += width; bits >= 8; bits -= 8) {
+                out.push_back(static_cast<char>(pending));
+                pending >>= 8;
+            }
+        }
+        if (bits > 0) out.push_back(static_cast<char>(pending));
+    }
+
+    template <typename Store>
+    void unpackColumn(varint::Reader& in, size_t count, Store store) {
+        int width = static_cast<uint8_t>(in.bytes(1)[0]);
+        if (width > 32) throw DataFormatException("借阅历史已损坏: 编号位宽无效");
+        std::string_view packed = in.bytes((count * width + 7) / 8);
+        const uint64_t mask = (uint64_t(1) << width) - 1;
+        uint64_t pending = 0;
+        int bits = 0;
+        size_t cursor = 0;
+        for (size_t i = 0; i < count; ++i) {
+            while (bits < width) {
+                pending |= static_cast<uint64_t>(static_cast<uint8_t>(packed[cursor++])) << bits;
+                bits += 8;
+            }
+            store(i, static_cast<uint32_t>(pending & mask));
+            pending >>= width;
+            bits -= width;
+        }
+    }
+
+    // 偏移列的公约数：按天计的借期整除 86400，整列只存天数
+    uint64_t commonDivisor(const std::vector<int64_t>& values) {
+        uint64_t divisor = 0;
+        for (int64_t value : values) {
+            divisor = std::gcd(divisor, static_cast<uint64_t>(value < 0 ? -value : value));
+            if (divisor == 1) break;
+        }
+        return divisor == 0 ? 1 : divisor;
+    }
+
+    void putOffsets(std::string& out, const std::vector<int64_t>& offsets) {
+        uint64_t divisor = commonDivisor(offsets);
+        varint::put(out, divisor);
+        for (int64_t offset : offsets) varint::putSigned(out, offset / static_cast<int64_t>(divisor));
+    }
+
+    // 返回块标志
+    uint32_t encodeBlock(const LoanRow* rows, size_t count, std::string& out) {
+        varint::put(out, count);
+        std::vector<uint32_t> ids(count);
+        for (size_t i = 0; i < count; ++i) ids[i] = rows[i].book;
+        packColumn(out, ids);
+        for (size_t i = 0; i < count; ++i) ids[i] = rows[i].reader;
+        packColumn(out, ids);
+        // 已按借阅时间排序，差值非负
+        varint::putSigned(out, rows[0].borrowDate);
+        for (size_t i = 1; i < count; ++i) varint::put(out, static_cast<uint64_t>(rows[i].borrowDate - rows[i - 1].borrowDate));
+        std::vector<int64_t> offsets(count);
+        for (size_t i = 0; i < count; ++i) offsets[i] = rows[i].dueDate - rows[i].borrowDate;
+        putOffsets(out, offsets);
+        std::string returnedBits((count + 7) / 8, '\0');
+        offsets.clear();
+        for (size_t i = 0; i < count; ++i) {
+            if (!rows[i].returned) continue;
+            returnedBits[i >> 3] |= static_cast<char>(1 << (i & 7));
+            offsets.push_back(rows[i].returnDate - rows[i].borrowDate);
+        }
+        out.append(returnedBits);
+        putOffsets(out, offsets);
+        // 单册图书的副本编号都是 0，不写这一列
+        if (std::none_of(rows, rows + count, [](const LoanRow& row) { return row.copy != 0; })) return 0;
+        for (size_t i = 0; i < count; ++i) ids[i] = rows[i].copy;
+        packColumn(out, ids);
+        return loanarchive::kHasCopies;
+    }
+}
+
+void loanarchive::encode(std::vector<LoanRow>& rows, std::string& data, std::vector<BlockInfo>& blocks) {
+    std::stable_sort(rows.begin(), rows.end(), [](const LoanRow& a, const LoanRow& b) { return a.borrowDate < b.borrowDate; });
+    for (size_t begin = 0; begin < rows.size(); begin += kBlockRows) {
+        size_t count = std::min(kBlockRows, rows.size() - begin);
+        const LoanRow* block = rows.data() + begin;
+        BlockInfo info{};
+        info.offset = data.size();
+        info.count = static_cast<uint32_t>(count);
+        info.minBorrow = block[0].borrowDate;
+        info.maxBorrow = block[count - 1].borrowDate;
+        auto [minDue, maxDue] = std::minmax_element(block, block + count,
+            [](const LoanRow& a, const LoanRow& b) { return a.dueDate < b.dueDate; });
+        info.minDue = minDue->dueDate;
+        info.maxDue = maxDue->dueDate;
+        info.flags = encodeBlock(block, count, data);
+        info.bytes = static_cast<uint32_t>(data.size() - info.offset);
+        info.crc = crc32(0, data.data() + info.offset, info.bytes);
+        blocks.push_back(info);
+    }
+}
+
+void loanarchive::decodeBlock(const char* data, size_t dataSize, const BlockInfo& block, std::vector<LoanRow>& out) {
+    if (block.offset > dataSize || block.bytes > dataSize - block.offset) throw DataFormatException("借阅历史已损坏: 数据块越界");
+    const char* bytes = data + block.offset;
+    if (crc32(0, bytes, block.bytes) != block.crc) throw DataFormatException("借阅历史已损坏: 校验和不匹配");
+    if ((block.flags & ~kHasCopies) != 0) throw DataFormatException("借阅历史已损坏: 未知的块标志");
+    varint::Reader in(bytes, block.bytes);
+    size_t count = in.next();
+    // 每条记录至少占 1 字节借阅时间差值，块索引损坏时不会按错误的条数分配内存
+    if (count != block.count || count > block.bytes) throw DataFormatException("借阅历史已损坏: 记录数不一致");
+    size_t base = out.size();
+    out.resize(base + count);
+    LoanRow* rows = out.data() + base;
+    unpackColumn(in, count, [&](size_t i, uint32_t id) { rows[i].book = id; });
+    unpackColumn(in, count, [&](size_t i, uint32_t id) { rows[i].reader = id; });
+    int64_t borrowDate = count > 0 ? in.nextSigned() : 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (i > 0) borrowDate += static_cast<int64_t>(in.next());
+        rows[i].borrowDate = borrowDate;
+    }
+    int64_t divisor = static_cast<int64_t>(in.next());
+    for (size_t i = 0; i < count; ++i) rows[i].dueDate = rows[i].borrowDate + in.nextSigned() * divisor;
+    std::string_view returnedBits = in.bytes((count + 7) / 8);
+    divisor = static_cast<int64_t>(in.next());
+    for (size_t i = 0; i < count; ++i) {
+        rows[i].returned = (static_cast<uint8_t>(returnedBits[i >> 3]) >> (i & 7)) & 1;
+        rows[i].returnDate = rows[i].returned ? rows[i].borrowDate + in.nextSigned() * divisor : 0;
+    }
+    if (block.flags & kHasCopies) unpackColumn(in, count, [&](size_t i, uint32_t copy) { rows[i].copy = copy; });
+}
+
+uint32_t LoanArchiveWriter::addName(std::string_view name) {
+    auto it = nameIds.find(name);
+    if (it != nameIds.end()) return it->second;
+    uint32_t id = static_cast<uint32_t>(names.size());
+    names.emplace_back(name);
+    nameIds.emplace(names.back(), id);
+    return id;
+}
+
+void LoanArchiveWriter::add(uint32_t book, uint32_t reader, int64_t borrowDate, int64_t dueDate, int64_t returnDate, bool returned,
+    uint32_t copy) {
+    rows.push_back({ book, reader, borrowDate, dueDate, returned ? returnDate : 0, returned, copy });
+}
+
+void LoanArchiveWriter::write(const std::string& path) {
+    std::string data;
+    std::vector<loanarchive::BlockInfo> blocks;
+    loanarchive::encode(rows, data, blocks);
+    std::string nameData;
+    for (const std::string& name : names) {
+        varint::put(nameData, name.size());
+        nameData.append(name);
+    }
+
+    FileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.headerSize = sizeof(header);
+    header.rowCount = rows.size();
+    header.nameCount = names.size();
+    header.blockCount = blocks.size();
+    header.data = { sizeof(header), data.size() };
+    header.names = { header.data.offset + data.size(), nameData.size() };
+    // 块索引按 8 字节对齐，读取时直接在映射内存上使用
+    uint64_t indexOffset = (header.names.offset + nameData.size() + 7) & ~uint64_t(7);
+    header.index = { indexOffset, blocks.size() * sizeof(loanarchive::BlockInfo) };
+
+    std::string tempPath = path + ".tmp";
+    std::FILE* out = std::fopen(tempPath.c_str(), "wb");
+    if (!out) throw std::runtime_error("无法写入借阅历史文件: " + tempPath);
+    static const char padding[8] = {};
+    size_t gap = static_cast<size_t>(indexOffset - header.names.offset - nameData.size());
+    bool ok = std::fwrite(&header, sizeof(header), 1, out) == 1
+        && std::fwrite(data.data(), 1, data.size(), out) == data.size()
+        && std::fwrite(nameData.data(), 1, nameData.size(), out) == nameData.size()
+        && std::fwrite(padding, 1, gap, out) == gap
+        && std::fwrite(blocks.data(), sizeof(loanarchive::BlockInfo), blocks.size(), out) == blocks.size()
+        && syncFile(out);
+    std::fclose(out);
+    if (!ok) throw std::runtime_error("无法写入借阅历史文件: " + tempPath);
+    std::filesystem::rename(tempPath, path);
+}
+
+LoanArchiveReader::LoanArchiveReader(const std::string& path) : file(path) {
+    if (!file.isOpen()) return;
+    FileHeader header;
+    if (file.size() < sizeof(header)) throw DataFormatException("借阅历史文件已损坏: 文件头不完整");
+    std::memcpy(&header, file.begin(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version < 1 || header.version > kVersion
+        || header.headerSize != sizeof(header)) {
+        throw DataFormatException("不是有效的借阅历史文件: " + path);
+    }
+    auto inside = [&](const Section& s) { return s.offset <= file.size() && s.bytes <= file.size() - s.offset; };
+    if (!inside(header.data) || !inside(header.names) || !inside(header.index) || header.index.offset % 8 != 0
+        || header.index.bytes != header.blockCount * sizeof(loanarchive::BlockInfo)) {
+        throw DataFormatException("借阅历史文件已损坏: 数据区越界");
+    }
+    data = file.begin() + header.data.offset;
+    dataSize = header.data.bytes;
+    rows = header.rowCount;
+    varint::Reader in(file.begin() + header.names.offset, header.names.bytes);
+    if (header.nameCount > header.names.bytes) throw DataFormatException("借阅历史文件已损坏: 名称数越界");
+    nameTable.reserve(header.nameCount);
+    for (uint64_t i = 0; i < header.nameCount; ++i) nameTable.push_back(in.bytes(in.next()));
+    const auto* index = reinterpret_cast<const loanarchive::BlockInfo*>(file.begin() + header.index.offset);
+    blockTable.assign(index, index + header.blockCount);
+}
+
+void LoanArchiveReader::decodeBlock(size_t index, std::vector<LoanRow>& out) const {
+    size_t base = out.size();
+    loanarchive::decodeBlock(data, dataSize, blockTable[index], out);
+    for (size_t i = base; i < out.size(); ++i) {
+        if (out[i].book >= nameTable.size() || out[i].reader >= nameTable.size()) {
+            throw DataFormatException("借阅历史文件已损坏: 名称编号越界");
+        }
+    }
+}
+
+size_t LoanArchiveReader::forEach(const std::function<void(const LoanRow&)>& visit) const {
+    std::vector<LoanRow> rowBuffer;
+    size_t visited = 0;
+    for (size_t i = 0; i < blockTable.size(); ++i) {
+        rowBuffer.clear();
+        decodeBlock(i, rowBuffer);
+        for (const LoanRow& row : rowBuffer) visit(row);
+        visited += rowBuffer.size();
+    }
+    return visited;
+}
+
+size_t LoanArchiveReader::forEachBorrowedBetween(int64_t from, int64_t to, const std::function<void(const LoanRow&)>& visit) const {
+    std::vector<LoanRow> rowBuffer;
+    size_t visited = 0;
+    for (size_t i = 0; i < blockTable.size(); ++i) {
+        const loanarchive::BlockInfo& block = blockTable[i];
+        if (block.maxBorrow < from || block.minBorrow >= to) continue;
+        rowBuffer.clear();
+        decodeBlock(i, rowBuffer);
+        for (const LoanRow& row : rowBuffer) {
+            if (row.borrowDate < from || row.borrowDate >= to) continue;
+            visit(row);
+            ++visited;
+        }
+    }
+    return visited;
+}
\ No newline at end of file
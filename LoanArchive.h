@@ -0,0 +1,90 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "MappedFile.h"
+#include "StringHash.h"
+
+// 一条借阅记录的编码形式：图书 / 读者为字典编号，由外部的名称表或快照的图书 / 读者区解释
+struct LoanRow {
+    uint32_t book;
+    uint32_t reader;
+    int64_t borrowDate;
+    int64_t dueDate;
+    int64_t returnDate;  // 未归还时为 0
+    bool returned;
+    uint32_t copy = 0;   // 副本编号
+};
+
+// 借阅记录的列式分块编码。记录按借阅时间排序后每 kBlockRows 条一块，块内各列分别编码：
+//   图书 / 读者编号按块内最大值的位宽紧凑存放；借阅时间存首值和递增差值（变长整数）；
+//   应还 / 归还时间存相对借阅时间的偏移，先除以整列的最大公约数（按天借期时每条 1 字节）；
+//   归还标志为位图，只有已归还的记录存归还时间；块内有非 0 副本编号时末尾再加一列按位宽存放的副本编号。
+// 每块的位置、条数、借阅 / 应还时间的最小最大值和校验和放在块外的索引里，按时间范围读取时整块跳过。
+namespace loanarchive {
+    constexpr size_t kBlockRows = 4096;
+    // BlockInfo::flags
+    constexpr uint32_t kHasCopies = 1;
+
+    struct BlockInfo {
+        uint64_t offset;  // 相对数据区起点
+        uint32_t bytes;
+        uint32_t count;
+        int64_t minBorrow;
+        int64_t maxBorrow;
+        int64_t minDue;
+        int64_t maxDue;
+        uint32_t crc;
+        uint32_t flags;  // 早期文件中为 0
+    };
+
+    // 编码：rows 会被按借阅时间稳定排序
+    void encode(std::vector<LoanRow>& rows, std::string& data, std::vector<BlockInfo>& blocks);
+    // 解码一块并追加到 out，数据损坏时抛出 DataFormatException
+    void decodeBlock(const char* data, size_t dataSize, const BlockInfo& block, std::vector<LoanRow>& out);
+}
+
+// 独立的借阅历史文件：文件头 + 各块数据 + 名称字典 + 块索引（文件尾）。
+// 名称字典同时容纳书名和读者姓名，记录中的编号都指向它。
+class LoanArchiveWriter {
+public:
+    uint32_t addName(std::string_view name);
+    void add(uint32_t book, uint32_t reader, int64_t borrowDate, int64_t dueDate, int64_t returnDate, bool returned,
+        uint32_t copy = 0);
+    // 先写临时文件并刷盘再替换
+    void write(const std::string& path);
+    size_t size() const { return rows.size(); }
+
+private:
+    std::vector<LoanRow> rows;
+    std::vector<std::string> names;
+    StringMap<uint32_t> nameIds;
+};
+
+// 映射整个文件并校验文件头、字典和块索引的边界；文件不存在时 isOpen() 为 false
+class LoanArchiveReader {
+public:
+    explicit LoanArchiveReader(const std::string& path);
+
+    bool isOpen() const { return file.isOpen(); }
+    size_t rowCount() const { return rows; }
+    size_t fileSize() const { return file.size(); }
+    const std::vector<std::string_view>& names() const { return nameTable; }
+    const std::vector<loanarchive::BlockInfo>& blocks() const { return blockTable; }
+
+    void decodeBlock(size_t index, std::vector<LoanRow>& out) const;
+    // 逐块解码，返回实际访问的条数；带时间范围时只解码借阅时间落在 [from, to) 内可能有记录的块
+    size_t forEach(const std::function<void(const LoanRow&)>& visit) const;
+    size_t forEachBorrowedBetween(int64_t from, int64_t to, const std::function<void(const LoanRow&)>& visit) const;
+
+private:
+    MappedFile file;
+    const char* data = nullptr;
+    size_t dataSize = 0;
+    size_t rows = 0;
+    std::vector<std::string_view> nameTable;
+    std::vector<loanarchive::BlockInfo> blockTable;
+};
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+
+// 分片锁：按对象地址散列到固定数量的互斥量上，不同对象通常落在不同分片，互不阻塞
+class LockStripes {
+public:
+    static constexpr size_t kStripeCount = 256;
+
+    size_t indexOf(const void* key) const {
+        // 对象池槽位地址间隔固定，先做乘法散列再取高位，避免集中到少数分片
+        uint64_t value = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(key)) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(value >> 56);
+    }
+    std::mutex& at(size_t index) { return stripes[index].mutex; }
+
+private:
+    struct alignas(64) Stripe {
+        std::mutex mutex;
+    };
+    std::array<Stripe, kStripeCount> stripes;
+};
+
+static_assert(LockStripes::kStripeCount == 256, "indexOf 取散列值的高 8 位");
+
+// 同时锁住一个或两个对象所在的分片：按分片下标升序加锁以避免死锁，落在同一分片时只锁一次
+class StripeGuard {
+public:
+    StripeGuard(LockStripes& stripes, const void* first, const void* second = nullptr) {
+        size_t a = stripes.indexOf(first);
+        size_t b = second ? stripes.indexOf(second) : a;
+        if (b < a) std::swap(a, b);
+        locked[0] = &stripes.at(a);
+        locked[0]->lock();
+        if (b != a) {
+            locked[1] = &stripes.at(b);
+            locked[1]->lock();
+        }
+    }
+    ~StripeGuard() {
+        if (locked[1]) locked[1]->unlock();
+        locked[0]->unlock();
+    }
+    StripeGuard(const StripeGuard&) = delete;
+    StripeGuard& operator=(const StripeGuard&) = delete;
+
+private:
+    std::mutex* locked[2] = {};
+};
\ No newline at end of file
@@ -0,0 +1,27 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+// 只读内存映射文件（Windows 使用 MapViewOfFile，其余平台使用 mmap）
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool isOpen() const { return opened; }
+    const char* begin() const { return data; }
+    size_t size() const { return length; }
+    std::string_view view() const { return std::string_view(data, length); }
+
+private:
+    const char* data = nullptr;
+    size_t length = 0;
+    bool opened = false;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
\ No newline at end of file
@@ -0,0 +1,226 @@
+#include "Metrics.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace {
+    constexpr size_t kOps = static_cast<size_t>(MetricOp::Count);
+    constexpr size_t kOutcomes = static_cast<size_t>(MetricOutcome::Count);
+
+    // 单个线程的计数块。只有持有它的线程写入，写入用 relaxed load + store（无需原子读改写）
+    struct ThreadBlock {
+        std::atomic<uint64_t> outcomes[kOps][kOutcomes] = {};
+        std::atomic<uint64_t> buckets[kOps][LatencyHistogram::kBuckets] = {};
+        std::atomic<uint64_t> sumNanoseconds[kOps] = {};
+        std::atomic<uint64_t> maxNanoseconds[kOps] = {};
+        std::atomic<bool> inUse{ false };
+    };
+
+    // 所有计数块登记在这里，线程退出后块留给后来的线程复用，计数继续累积。
+    // 登记表本身永不释放，避免进程退出时与仍在运行的线程发生析构顺序问题
+    struct Registry {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<ThreadBlock>> blocks;
+
+        ThreadBlock* acquire() {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto& block : blocks) {
+                bool expected = false;
+                if (block->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire)) return block.get();
+            }
+            blocks.push_back(std::make_unique<ThreadBlock>());
+            blocks.back()->inUse.store(true, std::memory_order_relaxed);
+            return blocks.back().get();
+        }
+    };
+
+    Registry& registry() {
+        static Registry* instance = new Registry;
+        return *instance;
+    }
+
+#ifndef LIBRARY_DISABLE_METRICS
+    void bump(std::atomic<uint64_t>& counter, uint64_t amount) {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    struct BlockLease {
+        ThreadBlock* block = registry().acquire();
+        ~BlockLease() { block->inUse.store(false, std::memory_order_release); }
+    };
+
+    ThreadBlock& localBlock() {
+        thread_local BlockLease lease;
+        return *lease.block;
+    }
+#endif
+
+    const char* const kOpNames[kOps] = { "borrow", "return", "pay_fine", "hold", "login", "load_data", "save_data" };
+    const char* const kOutcomeNames[kOutcomes] = {
+        "ok", "book_not_found", "reader_not_found", "book_borrowed", "not_borrowed", "loan_limit", "invalid_input", "rejected", "other",
+    };
+
+    std::string formatNanoseconds(uint64_t nanoseconds) {
+        char buffer[32];
+        if (nanoseconds < 10000) {
+            std::snprintf(buffer, sizeof(buffer), "%lluns", static_cast<unsigned long long>(nanoseconds));
+        } else if (nanoseconds < 10000000) {
+            std::snprintf(buffer, sizeof(buffer), "%.1fus", nanoseconds / 1e3);
+        } else if (nanoseconds < 10000000000ull) {
+            std::snprintf(buffer, sizeof(buffer), "%.1fms", nanoseconds / 1e6);
+        } else {
+            std::snprintf(buffer, sizeof(buffer), "%.1fs", nanoseconds / 1e9);
+        }
+        return buffer;
+    }
+}
+
+std::string_view metricOpName(MetricOp op) { return kOpNames[static_cast<size_t>(op)]; }
+
+std::string_view metricOutcomeName(MetricOutcome outcome) { return kOutcomeNames[static_cast<size_t>(outcome)]; }
+
+size_t LatencyHistogram::bucketOf(uint64_t nanoseconds) {
+    if (nanoseconds < kSubBuckets) return static_cast<size_t>(nanoseconds);
+    int exponent = 63 - std::countl_zero(nanoseconds);
+    size_t sub = static_cast<size_t>(nanoseconds >> (exponent - kSubBucketBits)) & (kSubBuckets - 1);
+    return static_cast<size_t>(exponent - kSubBucketBits + 1) * kSubBuckets + sub;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t bucket) {
+    if (bucket < kSubBuckets) return bucket;
+    int exponent = static_cast<int>(bucket / kSubBuckets) + kSubBucketBits - 1;
+    uint64_t width = 1ull << (exponent - kSubBucketBits);
+    uint64_t lower = (kSubBuckets + bucket % kSubBuckets) * width;
+    return lower + (width - 1);
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+    if (total == 0) return 0;
+    uint64_t rank = static_cast<uint64_t>(p / 100.0 * total + 0.5);
+    rank = std::clamp<uint64_t>(rank, 1, total);
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < kBuckets; ++bucket) {
+        seen += counts[bucket];
+        if (seen >= rank) return std::min(bucketUpperBound(bucket), maxNanoseconds);
+    }
+    return maxNanoseconds;
+}
+
+namespace metrics {
+#ifndef LIBRARY_DISABLE_METRICS
+    void record(MetricOp op, MetricOutcome outcome, uint64_t nanoseconds) {
+        ThreadBlock& block = localBlock();
+        size_t index = static_cast<size_t>(op);
+        bump(block.outcomes[index][static_cast<size_t>(outcome)], 1);
+        bump(block.buckets[index][LatencyHistogram::bucketOf(nanoseconds)], 1);
+        bump(block.sumNanoseconds[index], nanoseconds);
+        if (nanoseconds > block.maxNanoseconds[index].load(std::memory_order_relaxed)) {
+            block.maxNanoseconds[index].store(nanoseconds, std::memory_order_relaxed);
+        }
+    }
+#endif
+
+    // 各线程的块在读取期间仍可能被写入，快照是近似一致的
+    MetricsSnapshot snapshot() {
+        MetricsSnapshot result;
+        Registry& instance = registry();
+        std::lock_guard<std::mutex> lock(instance.mutex);
+        for (const auto& block : instance.blocks) {
+            for (size_t op = 0; op < kOps; ++op) {
+                MetricsSnapshot::OpStats& stats = result.ops[op];
+                for (size_t outcome = 0; outcome < kOutcomes; ++outcome) {
+                    stats.outcomes[outcome] += block->outcomes[op][outcome].load(std::memory_order_relaxed);
+                }
+                for (size_t bucket = 0; bucket < LatencyHistogram::kBuckets; ++bucket) {
+                    uint64_t count = block->buckets[op][bucket].load(std::memory_order_relaxed);
+                    if (count) stats.latency.add(bucket, count);
+                }
+                stats.latency.sumNanoseconds += block->sumNanoseconds[op].load(std::memory_order_relaxed);
+                stats.latency.maxNanoseconds = std::max(stats.latency.maxNanoseconds,
+                    block->maxNanoseconds[op].load(std::memory_order_relaxed));
+            }
+        }
+        return result;
+    }
+
+    void writeReport(std::ostream& out, const MetricsSnapshot& snapshot, const MetricsGauges& gauges) {
+        out << "图书 " << gauges.books << " 本, 读者 " << gauges.readers << " 位, 未还借阅 " << gauges.openLoans
+            << " 笔, 未缴罚款合计 " << std::fixed << std::setprecision(2) << gauges.outstandingFines << " 元\n";
+        out << "借阅记录: 内存 " << gauges.residentRecords << " 条, 历史文件 " << gauges.historyRecords << " 条\n";
+        out << "预约: 排队 " << gauges.waitingHolds << " 条, 待取书 " << gauges.readyHolds << " 条\n";
+        out.unsetf(std::ios::floatfield);
+        if (!kEnabled) {
+            out << "（编译时未启用运行指标）\n";
+            return;
+        }
+        // 表头用 ASCII，中文按字节计宽会导致列错位
+        out << std::left << std::setw(10) << "op" << std::right << std::setw(10) << "calls" << std::setw(10) << "failed"
+            << std::setw(10) << "mean" << std::setw(10) << "p50" << std::setw(10) << "p90" << std::setw(10) << "p99"
+            << std::setw(10) << "p99.9" << std::setw(10) << "max" << "  failures\n";
+        for (size_t op = 0; op < kOps; ++op) {
+            const MetricsSnapshot::OpStats& stats = snapshot.ops[op];
+            const LatencyHistogram& latency = stats.latency;
+            uint64_t mean = stats.calls() ? latency.sumNanoseconds / stats.calls() : 0;
+            out << std::left << std::setw(10) << kOpNames[op] << std::right << std::setw(10) << stats.calls()
+                << std::setw(10) << stats.failures() << std::setw(10) << formatNanoseconds(mean)
+                << std::setw(10) << formatNanoseconds(latency.percentile(50)) << std::setw(10) << formatNanoseconds(latency.percentile(90))
+                << std::setw(10) << formatNanoseconds(latency.percentile(99)) << std::setw(10) << formatNanoseconds(latency.percentile(99.9))
+                << std::setw(10) << formatNanoseconds(latency.maxNanoseconds);
+            const char* separator = "  ";
+            for (size_t outcome = 1; outcome < kOutcomes; ++outcome) {
+                if (!stats.outcomes[outcome]) continue;
+                out << separator << kOutcomeNames[outcome] << "=" << stats.outcomes[outcome];
+                separator = " ";
+            }
+            out << "\n";
+        }
+    }
+}
+
+MetricsDumper::MetricsDumper(std::string path, std::chrono::seconds interval, std::function<MetricsGauges()> gauges)
+    : path(std::move(path)), interval(interval), gauges(std::move(gauges)) {
+    worker = std::thread(&MetricsDumper::run, this);
+}
+
+MetricsDumper::~MetricsDumper() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeup.notify_all();
+    if (worker.joinable()) worker.join();
+    dump();
+}
+
+void MetricsDumper::dump() const {
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::trunc);
+        if (!out) return;
+        metrics::writeReport(out, metrics::snapshot(), gauges());
+        if (!out) return;
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+}
+
+void MetricsDumper::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        if (wakeup.wait_for(lock, interval, [this] { return stopping; })) break;
+        lock.unlock();
+        try {
+            dump();
+        } catch (const std::exception& ex) {
+            std::cerr << "\033[1;31m[错误] 写入运行指标失败: " << ex.what() << "\033[0m\n";
+        }
+        lock.lock();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,151 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include "Exceptions.h"
+
+// 运行指标：热点操作的延迟直方图与按结果分类的计数。
+// 每个线程写自己的计数块（单写者，relaxed 原子读写，无锁），读取时汇总所有线程的块。
+// 定义 LIBRARY_DISABLE_METRICS 编译时，track / record 直接展开为空操作。
+enum class MetricOp : uint8_t { Borrow, Return, PayFine, Hold, Login, LoadData, SaveData, Count };
+enum class MetricOutcome : uint8_t {
+    Success, BookNotFound, ReaderNotFound, BookBorrowed, NotBorrowed, LoanLimit, InvalidInput, Rejected, Other, Count
+};
+
+std::string_view metricOpName(MetricOp op);
+std::string_view metricOutcomeName(MetricOutcome outcome);
+
+// 对数-线性分桶（HDR 风格）：小于 16ns 每纳秒一桶，之后每个 2 的幂区间再分 16 桶，相对误差不超过 1/16
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 4;
+    static constexpr size_t kSubBuckets = 1 << kSubBucketBits;
+    static constexpr size_t kBuckets = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+    static size_t bucketOf(uint64_t nanoseconds);
+    static uint64_t bucketUpperBound(size_t bucket);
+
+    void add(size_t bucket, uint64_t count) { counts[bucket] += count; total += count; }
+    uint64_t count() const { return total; }
+    // 第 p 百分位（0~100）所在桶的上界
+    uint64_t percentile(double p) const;
+
+    uint64_t sumNanoseconds = 0;
+    uint64_t maxNanoseconds = 0;
+
+private:
+    uint64_t counts[kBuckets] = {};
+    uint64_t total = 0;
+};
+
+struct MetricsSnapshot {
+    struct OpStats {
+        uint64_t outcomes[static_cast<size_t>(MetricOutcome::Count)] = {};
+        LatencyHistogram latency;
+
+        uint64_t calls() const { return latency.count(); }
+        uint64_t failures() const { return calls() - outcomes[static_cast<size_t>(MetricOutcome::Success)]; }
+    };
+    OpStats ops[static_cast<size_t>(MetricOp::Count)];
+};
+
+// 由 Library 在读取时计算的状态量
+struct MetricsGauges {
+    size_t books = 0;
+    size_t readers = 0;
+    size_t openLoans = 0;
+    size_t residentRecords = 0;  // 内存中的借阅记录（未还 + 近期归还）
+    size_t historyRecords = 0;   // 已移入历史文件的记录
+    size_t waitingHolds = 0;     // 排队中的预约
+    size_t readyHolds = 0;       // 已保留副本、等待取书的预约
+    double outstandingFines = 0.0;
+};
+
+namespace metrics {
+#ifdef LIBRARY_DISABLE_METRICS
+    constexpr bool kEnabled = false;
+    inline void record(MetricOp, MetricOutcome, uint64_t) {}
+#else
+    constexpr bool kEnabled = true;
+    void record(MetricOp op, MetricOutcome outcome, uint64_t nanoseconds);
+#endif
+
+    MetricsSnapshot snapshot();
+    void writeReport(std::ostream& out, const MetricsSnapshot& snapshot, const MetricsGauges& gauges);
+
+    inline uint64_t elapsedSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // 计时执行 body 并按结果计数；异常按类型归类后原样抛出
+    template <typename F>
+    decltype(auto) track(MetricOp op, F&& body) {
+        if constexpr (!kEnabled) {
+            return body();
+        } else {
+            auto start = std::chrono::steady_clock::now();
+            auto fail = [&](MetricOutcome outcome) { record(op, outcome, elapsedSince(start)); };
+            try {
+                if constexpr (std::is_void_v<decltype(body())>) {
+                    body();
+                    record(op, MetricOutcome::Success, elapsedSince(start));
+                } else {
+                    decltype(auto) result = body();
+                    record(op, MetricOutcome::Success, elapsedSince(start));
+                    return result;
+                }
+            } catch (const BookNotFoundException&) {
+                fail(MetricOutcome::BookNotFound);
+                throw;
+            } catch (const ReaderNotFoundException&) {
+                fail(MetricOutcome::ReaderNotFound);
+                throw;
+            } catch (const BookBorrowedException&) {
+                fail(MetricOutcome::BookBorrowed);
+                throw;
+            } catch (const BookNotBorrowedException&) {
+                fail(MetricOutcome::NotBorrowed);
+                throw;
+            } catch (const LoanLimitException&) {
+                fail(MetricOutcome::LoanLimit);
+                throw;
+            } catch (const InvalidInputException&) {
+                fail(MetricOutcome::InvalidInput);
+                throw;
+            } catch (...) {
+                fail(MetricOutcome::Other);
+                throw;
+            }
+        }
+    }
+}
+
+// 后台线程按固定间隔把指标报告写入文件（先写临时文件再改名），析构时再写一次
+class MetricsDumper {
+public:
+    MetricsDumper(std::string path, std::chrono::seconds interval, std::function<MetricsGauges()> gauges);
+    ~MetricsDumper();
+    MetricsDumper(const MetricsDumper&) = delete;
+    MetricsDumper& operator=(const MetricsDumper&) = delete;
+
+    void dump() const;
+
+private:
+    void run();
+
+    std::string path;
+    std::chrono::seconds interval;
+    std::function<MetricsGauges()> gauges;
+    bool stopping = false;
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::thread worker;
+};
\ No newline at end of file
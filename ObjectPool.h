@@ -0,0 +1,87 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// 多态对象池：Base 及其各派生类共用一个定长槽位（取最大的派生类尺寸），
+// 槽位按块分配，对象地址在整个生命周期内不变；destroy 后槽位进入空闲链表供复用，
+// 池析构时统一析构所有存活对象。同一块内的对象在内存中连续，顺序扫描对缓存友好。
+template <typename Base, typename... Derived>
+class ObjectPool {
+public:
+    ObjectPool() = default;
+    ~ObjectPool() { clear(); }
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    template <typename T, typename... Args>
+    T* create(Args&&... args) {
+        static_assert((std::is_same_v<T, Derived> || ...), "类型未在对象池中登记");
+        Slot* slot = acquire();
+        T* object = new (slot->storage) T(std::forward<Args>(args)...);
+        slot->live = true;
+        ++liveCount;
+        return object;
+    }
+
+    void destroy(Base* object) {
+        if (!object) return;
+        // 取得最派生对象的起始地址，即槽位存储区的起始地址
+        Slot* slot = static_cast<Slot*>(dynamic_cast<void*>(object));
+        object->~Base();
+        slot->live = false;
+        slot->nextFree = freeList;
+        freeList = slot;
+        --liveCount;
+    }
+
+    // 析构所有存活对象并归还全部内存
+    void clear() {
+        for (auto& block : blocks) {
+            for (size_t i = 0; i < kBlockSlots; ++i) {
+                Slot& slot = block[i];
+                if (slot.live) reinterpret_cast<Base*>(slot.storage)->~Base();
+            }
+        }
+        blocks.clear();
+        freeList = nullptr;
+        nextUnused = kBlockSlots;
+        liveCount = 0;
+    }
+
+    size_t size() const { return liveCount; }
+    size_t capacity() const { return blocks.size() * kBlockSlots; }
+
+private:
+    static constexpr size_t kBlockSlots = 1024;
+    static constexpr size_t kSlotSize = std::max({ sizeof(Derived)... });
+    static constexpr size_t kSlotAlign = std::max({ alignof(Derived)... });
+
+    struct Slot {
+        alignas(kSlotAlign) unsigned char storage[kSlotSize];
+        Slot* nextFree = nullptr;
+        bool live = false;
+    };
+
+    Slot* acquire() {
+        if (freeList) {
+            Slot* slot = freeList;
+            freeList = slot->nextFree;
+            return slot;
+        }
+        if (nextUnused == kBlockSlots) {
+            blocks.push_back(std::make_unique<Slot[]>(kBlockSlots));
+            nextUnused = 0;
+        }
+        return &blocks.back()[nextUnused++];
+    }
+
+    std::vector<std::unique_ptr<Slot[]>> blocks;
+    Slot* freeList = nullptr;
+    size_t nextUnused = kBlockSlots;
+    size_t liveCount = 0;
+};
\ No newline at end of file
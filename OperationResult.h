@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <string_view>
+#include <vector>
+
+// 借阅 / 归还 / 缴费操作的结果。失败仍以异常报告（BookNotFoundException 等），
+// 这里只描述已完成的操作，由调用方决定如何展示。
+enum class OperationStatus : uint8_t {
+    Borrowed,          // 借出成功
+    ReturnedOnTime,    // 按时归还
+    ReturnedOverdue,   // 超期归还，罚款已计入读者欠款
+    FinePaid,          // 支付了部分欠款
+    FinePaidInFull,    // 欠款已结清
+    NoFineDue,         // 没有需要支付的罚款，未做修改
+    HoldPlaced,        // 已加入预约队列
+};
+
+struct OperationResult {
+    OperationStatus status = OperationStatus::Borrowed;
+    std::time_t dueDate = 0;
+    uint32_t copy = 0;             // 借出 / 归还的副本编号，从 0 开始
+    uint32_t copyCount = 1;        // 该书的总册数
+    int overdueDays = 0;
+    double fine = 0.0;             // 本次归还产生的罚款
+    double ratePerDay = 0.0;       // 计费标准（元/天）
+    double discount = 1.0;         // 读者折扣
+    std::string_view bookType;     // 驻留字符串，长期有效
+    double amountPaid = 0.0;
+    double outstandingFine = 0.0;  // 操作完成后读者的欠款
+    bool amountCapped = false;     // 支付金额超过欠款，按欠款结清
+    size_t queuePosition = 0;      // 预约在队列中的位次，从 1 开始
+    std::string_view heldFor;      // 归还的副本已为该预约读者保留（驻留字符串），没有预约时为空
+    std::time_t holdDeadline = 0;  // 保留副本的取书期限
+};
+
+// 超期 / 即将到期报表的一行。days 为超期天数或剩余天数，fine 只在超期报表中有值
+struct LoanReportEntry {
+    std::string_view title;   // 驻留字符串
+    std::string_view reader;
+    std::time_t dueDate = 0;
+    int days = 0;
+    double fine = 0.0;
+};
+
+struct LoanReport {
+    std::vector<LoanReportEntry> entries;  // 按应还日期排序
+    size_t count = 0;                      // 即 entries.size()，罚款合计为各行之和
+    double fineTotal = 0.0;
+};
\ No newline at end of file
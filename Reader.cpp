@@ -1,15 +1,48 @@
 #include "Reader.h"
 
-Reader::Reader(const std::string& name, int borrowPeriod, double fine)
-    : name(name), borrowPeriod(borrowPeriod), fine(fine) {}
+Reader::Reader(const std::string& name, int borrowPeriod, double fine, MemberTier tier)
+    : name(name), borrowPeriod(borrowPeriod), fine(fine), tier(tier) {}
 
 void Reader::addFine(double amount) {
     if (amount < 0) throw InvalidInputException("罚款金额不能为负数");
-    fine += amount;
+    fine.fetch_add(amount);
 }
 
 void Reader::payFine(double amount) {
     if (amount < 0) throw InvalidInputException("支付金额不能为负数");
-    if (amount > fine) throw InvalidInputException("支付金额不能超过欠款");
-    fine -= amount;
+    double current = fine.load();
+    do {
+        if (amount > current) throw InvalidInputException("支付金额不能超过欠款");
+    } while (!fine.compare_exchange_weak(current, current - amount));
+}
+
+AccountSummary Reader::account() const {
+    AccountSummary summary;
+    summary.activeLoans = activeLoans.load(std::memory_order_relaxed);
+    summary.overdueLoans = overdueLoans.load(std::memory_order_relaxed);
+    summary.accruedFine = accruedFine.load(std::memory_order_relaxed);
+    summary.outstandingFine = fine.load();
+    summary.lifetimeLoans = lifetimeLoans.load(std::memory_order_relaxed);
+    return summary;
+}
+
+void Reader::openLoan() {
+    activeLoans.fetch_add(1, std::memory_order_relaxed);
+    lifetimeLoans.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Reader::closeLoan(bool wasOverdue, double accrued) {
+    activeLoans.fetch_sub(1, std::memory_order_relaxed);
+    if (!wasOverdue) return;
+    // 最后一笔超期借阅归还时直接清零，避免浮点累减留下残差
+    if (overdueLoans.fetch_sub(1, std::memory_order_relaxed) == 1) {
+        accruedFine.store(0.0, std::memory_order_relaxed);
+    } else {
+        accruedFine.fetch_sub(accrued, std::memory_order_relaxed);
+    }
+}
+
+void Reader::setOverdue(int count, double accrued) {
+    overdueLoans.store(count, std::memory_order_relaxed);
+    accruedFine.store(accrued, std::memory_order_relaxed);
 }
\ No newline at end of file
@@ -1,31 +1,62 @@
 #pragma once
+#include <atomic>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 #include "Exceptions.h"
+#include "Symbol.h"
+#include "FinePolicy.h"
+
+// 读者账户汇总的一次读取结果
+struct AccountSummary {
+    int activeLoans = 0;
+    int overdueLoans = 0;
+    double accruedFine = 0.0;      // 未还超期借阅截至上次结转已产生、归还时才计入欠款的罚款
+    double outstandingFine = 0.0;  // 已计入的欠款
+    uint64_t lifetimeLoans = 0;
+};
 
 class Reader {
 public:
-    Reader(const std::string& name, int borrowPeriod, double fine = 0.0);
+    Reader(const std::string& name, int borrowPeriod, double fine = 0.0, MemberTier tier = MemberTier::Regular);
     virtual ~Reader() = default;
     
     // Getter方法
-    std::string getName() const { return name; }
+    std::string_view getName() const { return name.view(); }
+    Symbol getNameSymbol() const { return name; }
     int getBorrowPeriod() const { return borrowPeriod; }
-    double getFine() const { return fine; }
+    MemberTier getTier() const { return tier; }
+    double getFine() const { return fine.load(); }
     
-    // 罚款操作
+    // 罚款操作（原子更新，多个柜台线程可同时读写余额）
     void addFine(double amount);
     void payFine(double amount);
-    void payFullFine() { fine = 0.0; }
+    void payFullFine() { fine.store(0.0); }
+
+    // 账户汇总：由 Library 在借出 / 归还时 O(1) 增量维护，超期数和应计罚款由每日结转整体重算。
+    // 在借数只在持有该读者分片锁时修改，借阅上限据此检查
+    AccountSummary account() const;
+    int activeLoanCount() const { return activeLoans.load(std::memory_order_relaxed); }
+    void openLoan();
+    // wasOverdue / accrued：该借阅在上次结转时是否已超期及当时计入的应计罚款
+    void closeLoan(bool wasOverdue, double accrued);
+    void setOverdue(int count, double accrued);
+    void setLifetimeLoans(uint64_t count) { lifetimeLoans.store(count, std::memory_order_relaxed); }
     
-    // 虚函数
-    virtual double getFineDiscount() const { return 1.0; }
-    virtual std::string getTypeName() const { return "普通会员"; }
+    // 会员等级相关（查表，无虚函数调用）
+    double getFineDiscount() const { return FinePolicy::discount(tier); }
+    std::string_view getTypeName() const { return tierName(tier); }
 
 protected:
-    std::string name;
+    Symbol name;
     int borrowPeriod;
-    double fine;
+    std::atomic<double> fine;
+    MemberTier tier;
+    std::atomic<int> activeLoans{ 0 };
+    std::atomic<int> overdueLoans{ 0 };
+    std::atomic<double> accruedFine{ 0.0 };
+    std::atomic<uint64_t> lifetimeLoans{ 0 };
 };
 
 // 普通会员类
@@ -37,15 +68,11 @@ public:
 // VIP会员类
 class VIPMember : public Reader {
 public:
-    VIPMember(const std::string& name) : Reader(name, 60) {}
-    double getFineDiscount() const override { return 0.9; }
-    std::string getTypeName() const override { return "VIP会员"; }
+    VIPMember(const std::string& name) : Reader(name, 60, 0.0, MemberTier::VIP) {}
 };
 
 // 学生会员类
 class StudentMember : public Reader {
 public:
-    StudentMember(const std::string& name) : Reader(name, 45) {}
-    double getFineDiscount() const override { return 0.8; }
-    std::string getTypeName() const override { return "学生会员"; }
+    StudentMember(const std::string& name) : Reader(name, 45, 0.0, MemberTier::Student) {}
 };
\ No newline at end of file
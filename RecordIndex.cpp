@@ -0,0 +1,49 @@
+#include "RecordIndex.h"
+#include <algorithm>
+
+namespace {
+    const std::vector<size_t> emptyPositions;
+}
+
+void RecordIndex::add(size_t pos, const BorrowRecord& record) {
+    byBook[record.getBook()].push_back(pos);
+    byReader[record.getReader()].push_back(pos);
+    if (!record.getIsReturned()) openLoans[record.getBook()].push_back(pos);
+}
+
+void RecordIndex::markReturned(size_t pos, const BorrowRecord& record) {
+    auto it = openLoans.find(record.getBook());
+    if (it == openLoans.end()) return;
+    auto& positions = it->second;
+    auto found = std::find(positions.begin(), positions.end(), pos);
+    if (found == positions.end()) return;
+    *found = positions.back();
+    positions.pop_back();
+    if (positions.empty()) openLoans.erase(it);
+}
+
+void RecordIndex::rebuild(const RecordStore& records) {
+    clear();
+    for (size_t i = 0; i < records.size(); ++i) add(i, records[i]);
+}
+
+void RecordIndex::clear() {
+    byBook.clear();
+    byReader.clear();
+    openLoans.clear();
+}
+
+const std::vector<size_t>& RecordIndex::recordsOf(const Book* book) const {
+    auto it = byBook.find(book);
+    return it != byBook.end() ? it->second : emptyPositions;
+}
+
+const std::vector<size_t>& RecordIndex::recordsOf(const Reader* reader) const {
+    auto it = byReader.find(reader);
+    return it != byReader.end() ? it->second : emptyPositions;
+}
+
+const std::vector<size_t>& RecordIndex::openLoansOf(const Book* book) const {
+    auto it = openLoans.find(book);
+    return it != openLoans.end() ? it->second : emptyPositions;
+}
\ No newline at end of file
@@ -0,0 +1,28 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include <cstddef>
+#include "BorrowRecord.h"
+#include "RecordStore.h"
+
+// 借阅记录的二级索引：按图书、按读者记录其在 borrowRecords 中的下标。
+// 保存下标而不是指针，因此 vector 扩容后索引依然有效。
+class RecordIndex {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    void add(size_t pos, const BorrowRecord& record);
+    void markReturned(size_t pos, const BorrowRecord& record);
+    void rebuild(const RecordStore& records);
+    void clear();
+
+    const std::vector<size_t>& recordsOf(const Book* book) const;
+    const std::vector<size_t>& recordsOf(const Reader* reader) const;
+    // 该书各副本当前未归还的借阅记录下标（无序，条数不超过已借出的副本数）
+    const std::vector<size_t>& openLoansOf(const Book* book) const;
+
+private:
+    std::unordered_map<const Book*, std::vector<size_t>> byBook;
+    std::unordered_map<const Reader*, std::vector<size_t>> byReader;
+    std::unordered_map<const Book*, std::vector<size_t>> openLoans;
+};
\ No newline at end of file
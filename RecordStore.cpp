@@ -0,0 +1,209 @@
+#include "RecordStore.h"
+#include <cstring>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+static_assert(sizeof(std::time_t) == sizeof(int64_t), "时间戳列按 64 位存储");
+
+namespace {
+    constexpr int64_t kDay = 24 * 60 * 60;
+    constexpr size_t kTierCount = static_cast<size_t>(MemberTier::Count);
+    constexpr size_t kFineClassCount = static_cast<size_t>(BookCategory::Count) * kTierCount;
+
+    uint8_t fineClassOf(const Book* book, const Reader* reader) {
+        return static_cast<uint8_t>(static_cast<size_t>(book->getCategory()) * kTierCount
+            + static_cast<size_t>(reader->getTier()));
+    }
+
+    // 每个罚款类别对应的 每日费率 × 折扣，在扫描开始时按当前策略表生成
+    void fillFineFactors(double* factors) {
+        for (size_t i = 0; i < kFineClassCount; ++i) {
+            factors[i] = FinePolicy::ratePerDay(static_cast<BookCategory>(i / kTierCount))
+                * FinePolicy::discount(static_cast<MemberTier>(i % kTierCount));
+        }
+    }
+
+    inline uint64_t returnedBit(const uint64_t* bits, size_t pos) {
+        return (bits[pos >> 6] >> (pos & 63)) & 1;
+    }
+
+#if defined(__AVX2__)
+    // 4 条记录的归还位展开为 64 位掩码（已归还的通道全 1）；pos 为 4 的倍数，4 位不会跨字
+    inline __m256i returnedMask(const uint64_t* bits, size_t pos) {
+        const __m256i select = _mm256_set_epi64x(8, 4, 2, 1);
+        __m256i nibble = _mm256_set1_epi64x(static_cast<int64_t>((bits[pos >> 6] >> (pos & 63)) & 0xF));
+        return _mm256_cmpeq_epi64(_mm256_and_si256(nibble, select), select);
+    }
+
+    // AVX2 没有 int64 -> double 指令，借助 1.5 * 2^52 的尾数对齐完成转换，要求 |x| < 2^51
+    inline __m256d toDouble(__m256i x) {
+        const __m256d magic = _mm256_set1_pd(6755399441055744.0);
+        return _mm256_sub_pd(_mm256_castsi256_pd(_mm256_add_epi64(x, _mm256_castpd_si256(magic))), magic);
+    }
+
+    inline int64_t horizontalSum(__m256i v) {
+        alignas(32) int64_t lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), v);
+        return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    }
+#endif
+}
+
+size_t RecordStore::append(Book* book, uint32_t copy, Reader* reader, std::time_t borrowDate, std::time_t dueDate) {
+    size_t pos = size();
+    books.push_back(book);
+    copies.push_back(static_cast<uint16_t>(copy));
+    readers.push_back(reader);
+    borrowDates.push_back(borrowDate);
+    dueDates.push_back(dueDate);
+    returnDates.push_back(0);
+    fineClasses.push_back(fineClassOf(book, reader));
+    if ((pos & 63) == 0) returnedBits.push_back(0);
+    return pos;
+}
+
+void RecordStore::markReturned(size_t pos, std::time_t returnDate) {
+    returnDates[pos] = returnDate;
+    returnedBits[pos >> 6] |= uint64_t(1) << (pos & 63);
+}
+
+BorrowRecord RecordStore::operator[](size_t pos) const {
+    return BorrowRecord(books[pos], readers[pos], borrowDates[pos], dueDates[pos], returnDates[pos], isReturned(pos), copies[pos]);
+}
+
+size_t RecordStore::eraseIf(const std::function<bool(const BorrowRecord&)>& match) {
+    size_t kept = 0;
+    std::vector<uint64_t> bits;
+    for (size_t i = 0; i < size(); ++i) {
+        if (match((*this)[i])) continue;
+        bool returned = isReturned(i);
+        books[kept] = books[i];
+        copies[kept] = copies[i];
+        readers[kept] = readers[i];
+        borrowDates[kept] = borrowDates[i];
+        dueDates[kept] = dueDates[i];
+        returnDates[kept] = returnDates[i];
+        fineClasses[kept] = fineClasses[i];
+        if ((kept & 63) == 0) bits.push_back(0);
+        if (returned) bits.back() |= uint64_t(1) << (kept & 63);
+        ++kept;
+    }
+    size_t removed = size() - kept;
+    books.resize(kept);
+    copies.resize(kept);
+    readers.resize(kept);
+    borrowDates.resize(kept);
+    dueDates.resize(kept);
+    returnDates.resize(kept);
+    fineClasses.resize(kept);
+    returnedBits.swap(bits);
+    return removed;
+}
+
+void RecordStore::reserve(size_t count) {
+    books.reserve(count);
+    copies.reserve(count);
+    readers.reserve(count);
+    borrowDates.reserve(count);
+    dueDates.reserve(count);
+    returnDates.reserve(count);
+    fineClasses.reserve(count);
+    returnedBits.reserve((count + 63) / 64);
+}
+
+void RecordStore::clear() {
+    books.clear();
+    copies.clear();
+    readers.clear();
+    borrowDates.clear();
+    dueDates.clear();
+    returnDates.clear();
+    fineClasses.clear();
+    returnedBits.clear();
+}
+
+// 应还日期 <= now - 1天 即超期满一天
+size_t RecordStore::countOverdue(std::time_t now) const {
+    const int64_t* due = dueDates.data();
+    const uint64_t* bits = returnedBits.data();
+    const int64_t threshold = static_cast<int64_t>(now) - kDay + 1;
+    size_t n = size();
+    size_t i = 0;
+    size_t count = 0;
+#if defined(__AVX2__)
+    const __m256i limit = _mm256_set1_epi64x(threshold);
+    __m256i acc = _mm256_setzero_si256();
+    for (; i + 4 <= n; i += 4) {
+        __m256i late = _mm256_cmpgt_epi64(limit, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(due + i)));
+        // 掩码通道为 -1，相减即计数
+        acc = _mm256_sub_epi64(acc, _mm256_andnot_si256(returnedMask(bits, i), late));
+    }
+    count = static_cast<size_t>(horizontalSum(acc));
+#endif
+    for (; i < n; ++i) {
+        count += (returnedBit(bits, i) ^ 1) & static_cast<uint64_t>(due[i] < threshold);
+    }
+    return count;
+}
+
+double RecordStore::overdueFineTotal(std::time_t now) const {
+    double factors[kFineClassCount];
+    fillFineFactors(factors);
+    const int64_t* due = dueDates.data();
+    const uint8_t* classes = fineClasses.data();
+    const uint64_t* bits = returnedBits.data();
+    size_t n = size();
+    size_t i = 0;
+    double total = 0.0;
+#if defined(__AVX2__)
+    const __m256i nowV = _mm256_set1_epi64x(now);
+    const __m256i minLate = _mm256_set1_epi64x(kDay - 1);
+    const __m256d dayV = _mm256_set1_pd(static_cast<double>(kDay));
+    __m256d acc = _mm256_setzero_pd();
+    for (; i + 4 <= n; i += 4) {
+        __m256i diff = _mm256_sub_epi64(nowV, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(due + i)));
+        __m256i late = _mm256_andnot_si256(returnedMask(bits, i), _mm256_cmpgt_epi64(diff, minLate));
+        __m256d days = _mm256_floor_pd(_mm256_div_pd(toDouble(diff), dayV));
+        int32_t packed;
+        std::memcpy(&packed, classes + i, sizeof(packed));
+        __m128i index = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(packed));
+        // 未超期的通道不取费率，保持为 0
+        __m256d factor = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), factors, index, _mm256_castsi256_pd(late), 8);
+        acc = _mm256_add_pd(acc, _mm256_mul_pd(days, factor));
+    }
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, acc);
+    total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+    for (; i < n; ++i) {
+        int64_t diff = static_cast<int64_t>(now) - due[i];
+        int64_t days = diff / kDay;
+        double open = static_cast<double>(returnedBit(bits, i) ^ 1);
+        total += static_cast<double>(days > 0 ? days : 0) * factors[classes[i]] * open;
+    }
+    return total;
+}
+
+size_t RecordStore::countDueBetween(std::time_t from, std::time_t to) const {
+    const int64_t* due = dueDates.data();
+    const uint64_t* bits = returnedBits.data();
+    size_t n = size();
+    size_t i = 0;
+    size_t count = 0;
+#if defined(__AVX2__)
+    const __m256i lower = _mm256_set1_epi64x(static_cast<int64_t>(from) - 1);
+    const __m256i upper = _mm256_set1_epi64x(to);
+    __m256i acc = _mm256_setzero_si256();
+    for (; i + 4 <= n; i += 4) {
+        __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(due + i));
+        __m256i inside = _mm256_and_si256(_mm256_cmpgt_epi64(value, lower), _mm256_cmpgt_epi64(upper, value));
+        acc = _mm256_sub_epi64(acc, _mm256_andnot_si256(returnedMask(bits, i), inside));
+    }
+    count = static_cast<size_t>(horizontalSum(acc));
+#endif
+    for (; i < n; ++i) {
+        count += (returnedBit(bits, i) ^ 1) & static_cast<uint64_t>(due[i] >= from && due[i] < to);
+    }
+    return count;
+}
\ No newline at end of file
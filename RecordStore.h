@@ -0,0 +1,60 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <vector>
+#include "BorrowRecord.h"
+
+// 借阅记录的列式存储：图书、副本编号、读者、三个时间戳和罚款类别各占一列，归还状态为位图。
+// 报表类扫描只读取需要的列（应还日期 + 归还位图），AVX2 可用时按 4 条一组向量化，否则退回标量循环。
+// 逐条访问时由各列组装出 BorrowRecord 视图。
+class RecordStore {
+public:
+    class const_iterator {
+    public:
+        const_iterator(const RecordStore* store, size_t pos) : store(store), pos(pos) {}
+        BorrowRecord operator*() const { return (*store)[pos]; }
+        const_iterator& operator++() { ++pos; return *this; }
+        bool operator!=(const const_iterator& other) const { return pos != other.pos; }
+
+    private:
+        const RecordStore* store;
+        size_t pos;
+    };
+
+    size_t append(Book* book, uint32_t copy, Reader* reader, std::time_t borrowDate, std::time_t dueDate);
+    void markReturned(size_t pos, std::time_t returnDate);
+    // 删除满足条件的记录并压缩各列，返回删除条数
+    size_t eraseIf(const std::function<bool(const BorrowRecord&)>& match);
+    void reserve(size_t count);
+    void clear();
+
+    size_t size() const { return dueDates.size(); }
+    bool empty() const { return dueDates.empty(); }
+    BorrowRecord operator[](size_t pos) const;
+    Book* bookAt(size_t pos) const { return books[pos]; }
+    uint32_t copyAt(size_t pos) const { return copies[pos]; }
+    Reader* readerAt(size_t pos) const { return readers[pos]; }
+    std::time_t dueDateAt(size_t pos) const { return dueDates[pos]; }
+    bool isReturned(size_t pos) const { return (returnedBits[pos >> 6] >> (pos & 63)) & 1; }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+
+    // 扫描内核：只针对未归还的记录，超期口径与 BorrowRecord::getOverdueDays 一致（满一整天才算超期）。
+    // 会扫描整列，供基准和批处理使用；在线报表走到期索引
+    size_t countOverdue(std::time_t now) const;
+    double overdueFineTotal(std::time_t now) const;
+    // 应还日期位于 [from, to) 的未还记录数
+    size_t countDueBetween(std::time_t from, std::time_t to) const;
+
+private:
+    std::vector<Book*> books;
+    std::vector<uint16_t> copies;  // CopySet::kMaxCopies 以内
+    std::vector<Reader*> readers;
+    std::vector<int64_t> borrowDates;
+    std::vector<int64_t> dueDates;
+    std::vector<int64_t> returnDates;
+    std::vector<uint8_t> fineClasses;    // 图书类别 × 会员等级，罚款内核据此查费率表
+    std::vector<uint64_t> returnedBits;  // 每条记录一位，1 表示已归还
+};
\ No newline at end of file
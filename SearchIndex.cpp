@@ -0,0 +1,184 @@
+#include "SearchIndex.h"
+#include <algorithm>
+#include "Utf8.h"
+
+namespace {
+    // 单字的键低 32 位为 0（码位 0 不会出现在文本中），相邻两字的键为 (前字 << 32) | 后字
+    uint64_t unigramKey(uint32_t c) { return static_cast<uint64_t>(c) << 32; }
+    uint64_t bigramKey(uint32_t a, uint32_t b) { return (static_cast<uint64_t>(a) << 32) | b; }
+
+    template <typename F>
+    void forEachGram(std::string_view text, F&& emit) {
+        size_t pos = 0;
+        uint32_t previous = 0;
+        while (pos < text.size()) {
+            uint32_t c = utf8::next(text, pos);
+            emit(unigramKey(c));
+            if (previous != 0) emit(bigramKey(previous, c));
+            previous = c;
+        }
+    }
+
+    // 查询词所需的 n-gram：单字词用单字键，否则用全部相邻两字键
+    std::vector<uint64_t> queryGrams(std::string_view term) {
+        std::vector<uint32_t> chars;
+        for (size_t pos = 0; pos < term.size();) chars.push_back(utf8::next(term, pos));
+        std::vector<uint64_t> grams;
+        if (chars.size() == 1) grams.push_back(unigramKey(chars[0]));
+        for (size_t i = 1; i < chars.size(); ++i) grams.push_back(bigramKey(chars[i - 1], chars[i]));
+        std::sort(grams.begin(), grams.end());
+        grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+        return grams;
+    }
+
+    // 按 ASCII 空格和全角空格切分查询词
+    std::vector<std::string> splitTerms(std::string_view query) {
+        std::vector<std::string> terms;
+        std::string current;
+        for (size_t pos = 0; pos < query.size();) {
+            size_t start = pos;
+            uint32_t c = utf8::next(query, pos);
+            if (c == ' ' || c == '\t' || c == 0x3000) {
+                if (!current.empty()) terms.push_back(utf8::foldCase(current));
+                current.clear();
+            } else {
+                current.append(query.substr(start, pos - start));
+            }
+        }
+        if (!current.empty()) terms.push_back(utf8::foldCase(current));
+        return terms;
+    }
+
+    int scoreField(std::string_view field, std::string_view term, SearchMode mode, int exact, int prefix, int contains) {
+        if (field == term) return exact;
+        if (field.substr(0, term.size()) == term) return prefix;
+        if (mode == SearchMode::Substring && field.find(term) != std::string_view::npos) return contains;
+        return 0;
+    }
+}
+
+SearchMode parseSearchQuery(std::string_view& query) {
+    if (!query.empty() && query.back() == '*') {
+        query.remove_suffix(1);
+        return SearchMode::Prefix;
+    }
+    return SearchMode::Substring;
+}
+
+uint32_t SearchIndex::addDocument(Book* book) {
+    uint32_t id = static_cast<uint32_t>(documents.size());
+    documents.push_back({ book, utf8::foldCase(book->getTitle()), utf8::foldCase(book->getAuthor()) });
+    documentIds[book] = id;
+    const Document& document = documents.back();
+    auto emit = [&](uint64_t key) {
+        std::vector<uint32_t>& list = postings[key];
+        if (list.empty() || list.back() != id) list.push_back(id);
+    };
+    forEachGram(document.title, emit);
+    forEachGram(document.author, emit);
+    ++liveCount;
+    return id;
+}
+
+void SearchIndex::add(Book* book) {
+    if (documentIds.count(book)) return;
+    addDocument(book);
+}
+
+// 删除只做标记，倒排表中的失效编号在已删除文档过半时统一清理
+void SearchIndex::remove(const Book* book) {
+    auto it = documentIds.find(book);
+    if (it == documentIds.end()) return;
+    documents[it->second].book = nullptr;
+    documents[it->second].title.clear();
+    documents[it->second].author.clear();
+    documentIds.erase(it);
+    --liveCount;
+    if (documents.size() > 1024 && liveCount * 2 < documents.size()) compact();
+}
+
+void SearchIndex::clear() {
+    documents.clear();
+    documentIds.clear();
+    postings.clear();
+    liveCount = 0;
+}
+
+void SearchIndex::build(const std::vector<Book*>& books) {
+    clear();
+    documents.reserve(books.size());
+    documentIds.reserve(books.size());
+    for (Book* book : books) add(book);
+}
+
+void SearchIndex::compact() {
+    std::vector<Book*> live;
+    live.reserve(liveCount);
+    for (const Document& document : documents) {
+        if (document.book) live.push_back(document.book);
+    }
+    build(live);
+}
+
+std::vector<SearchHit> SearchIndex::search(std::string_view query, SearchMode mode, size_t limit) const {
+    std::vector<SearchHit> hits;
+    std::vector<std::string> terms = splitTerms(query);
+    if (terms.empty()) return hits;
+
+    // 所有词的 n-gram 倒排表，从最短的开始求交集
+    std::vector<const std::vector<uint32_t>*> lists;
+    for (const std::string& term : terms) {
+        for (uint64_t gram : queryGrams(term)) {
+            auto it = postings.find(gram);
+            if (it == postings.end()) return hits;
+            lists.push_back(&it->second);
+        }
+    }
+    std::sort(lists.begin(), lists.end(), [](auto* a, auto* b) { return a->size() < b->size(); });
+    std::vector<uint32_t> candidates = *lists.front();
+    for (size_t i = 1; i < lists.size() && !candidates.empty(); ++i) {
+        const std::vector<uint32_t>& list = *lists[i];
+        auto cursor = list.begin();
+        size_t kept = 0;
+        for (uint32_t id : candidates) {
+            cursor = std::lower_bound(cursor, list.end(), id);
+            if (cursor == list.end()) break;
+            if (*cursor == id) candidates[kept++] = id;
+        }
+        candidates.resize(kept);
+    }
+
+    // n-gram 全部出现不代表连续出现，逐个核对并打分
+    struct Ranked {
+        int score;
+        uint32_t id;
+    };
+    std::vector<Ranked> ranked;
+    for (uint32_t id : candidates) {
+        const Document& document = documents[id];
+        if (!document.book) continue;
+        int total = 0;
+        for (const std::string& term : terms) {
+            int score = std::max(scoreField(document.title, term, mode, 100, 80, 50),
+                scoreField(document.author, term, mode, 40, 30, 20));
+            if (score == 0) {
+                total = 0;
+                break;
+            }
+            total += score;
+        }
+        if (total > 0) ranked.push_back({ total, id });
+    }
+    // 同分时书名较短的优先，再按加入顺序
+    auto better = [this](const Ranked& a, const Ranked& b) {
+        if (a.score != b.score) return a.score > b.score;
+        size_t lengthA = documents[a.id].title.size(), lengthB = documents[b.id].title.size();
+        if (lengthA != lengthB) return lengthA < lengthB;
+        return a.id < b.id;
+    };
+    size_t count = std::min(limit, ranked.size());
+    std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end(), better);
+    hits.reserve(count);
+    for (size_t i = 0; i < count; ++i) hits.push_back({ documents[ranked[i].id].book, ranked[i].score });
+    return hits;
+}
\ No newline at end of file
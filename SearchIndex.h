@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "Book.h"
+
+enum class SearchMode { Substring, Prefix };
+
+struct SearchHit {
+    Book* book;
+    int score;
+};
+
+// 菜单和服务端共用的查询写法：末尾加 * 表示按前缀匹配，返回时去掉 *
+SearchMode parseSearchQuery(std::string_view& query);
+
+// 书名 / 作者的倒排索引。按 UTF-8 字符切分，索引单字和相邻两字（中文书名以字为单位检索），
+// 查询时先对各词的 n-gram 倒排表求交集得到候选，再在候选上逐个核对并打分。
+// 多个词以空格分隔，需全部命中（AND）。ASCII 字母不区分大小写。
+class SearchIndex {
+public:
+    void add(Book* book);
+    void remove(const Book* book);
+    void clear();
+    // 批量建立索引（loadData 结束时调用），替换现有内容
+    void build(const std::vector<Book*>& books);
+
+    // 按得分降序返回至多 limit 条结果：书名完全相同 > 书名前缀 > 书名包含 > 作者完全相同 > 作者前缀 > 作者包含
+    std::vector<SearchHit> search(std::string_view query, SearchMode mode = SearchMode::Substring, size_t limit = 20) const;
+    size_t size() const { return liveCount; }
+
+private:
+    struct Document {
+        Book* book;        // 已删除的文档为 nullptr
+        std::string title;   // 规范化后的文本
+        std::string author;
+    };
+
+    uint32_t addDocument(Book* book);
+    void compact();
+
+    std::vector<Document> documents;
+    std::unordered_map<const Book*, uint32_t> documentIds;
+    // n-gram -> 按文档编号升序的倒排表；编号只增不减，追加即有序
+    std::unordered_map<uint64_t, std::vector<uint32_t>> postings;
+    size_t liveCount = 0;
+};
\ No newline at end of file
@@ -0,0 +1,404 @@
+#include "Server.h"
+#include <charconv>
+#include <iostream>
+#include <stdexcept>
+#include "TextParsing.h"
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    template <typename T>
+    void appendNumber(std::string& out, T value) {
+        char buffer[32];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out.append(buffer, result.ptr);
+    }
+
+    void appendError(std::string& out, std::string_view kind, std::string_view message) {
+        out.append("ERR,").append(kind).append(",").append(message).append("\n");
+    }
+
+    void appendReportEntry(std::string& out, const LoanReportEntry& entry, bool withFine) {
+        out.append(entry.title).append(",").append(entry.reader).append(",");
+        appendNumber(out, static_cast<int64_t>(entry.dueDate));
+        out.append(",");
+        appendNumber(out, entry.days);
+        if (withFine) {
+            out.append(",");
+            appendNumber(out, entry.fine);
+        }
+        out.append("\n");
+    }
+}
+
+void LibraryServer::handleRequest(std::string_view line, std::string& out) {
+    std::string_view command = textparse::nextField(line);
+    try {
+        if (command == "ping") {
+            out.append("OK\n");
+        } else if (command == "book") {
+            Book* book = library.findBook(line);
+            if (!book) throw BookNotFoundException("未找到图书: " + std::string(line));
+            out.append("OK,").append(book->getTitle()).append(",").append(book->getAuthor()).append(",")
+                .append(book->getType()).append(book->isBorrowedStatus() ? ",1," : ",0,");
+            appendNumber(out, static_cast<int64_t>(book->getAvailableCopies()));
+            out.append(",");
+            appendNumber(out, static_cast<int64_t>(book->getCopyCount()));
+            out.append("\n");
+        } else if (command == "reader") {
+            Reader* reader = library.findReader(line);
+            if (!reader) throw ReaderNotFoundException("未找到读者: " + std::string(line));
+            out.append("OK,").append(reader->getName()).append(",").append(tierTag(reader->getTier())).append(",");
+            appendNumber(out, reader->getFine());
+            out.append("\n");
+        } else if (command == "account") {
+            AccountSummary account = library.readerAccount(std::string(line));
+            out.append("OK,");
+            appendNumber(out, account.activeLoans);
+            out.append(",");
+            appendNumber(out, account.overdueLoans);
+            out.append(",");
+            appendNumber(out, account.accruedFine);
+            out.append(",");
+            appendNumber(out, account.outstandingFine);
+            out.append(",");
+            appendNumber(out, account.lifetimeLoans);
+            out.append("\n");
+        } else if (command == "borrow") {
+            std::string title(textparse::nextField(line));
+            OperationResult result = library.borrowBook(title, std::string(line));
+            out.append("OK,");
+            appendNumber(out, static_cast<int64_t>(result.dueDate));
+            out.append("\n");
+        } else if (command == "return") {
+            std::string title(textparse::nextField(line));
+            OperationResult result = library.returnBook(title, std::string(line));
+            out.append("OK,");
+            appendNumber(out, result.overdueDays);
+            out.append(",");
+            appendNumber(out, result.fine);
+            out.append(",").append(result.heldFor).append("\n");
+        } else if (command == "hold") {
+            std::string title(textparse::nextField(line));
+            OperationResult result = library.placeHold(title, std::string(line));
+            out.append("OK,");
+            appendNumber(out, result.queuePosition);
+            out.append("\n");
+        } else if (command == "unhold") {
+            std::string title(textparse::nextField(line));
+            library.cancelHold(title, std::string(line));
+            out.append("OK\n");
+        } else if (command == "pay") {
+            std::string name(textparse::nextField(line));
+            double amount = -1;
+            if (!line.empty() && !textparse::parseNumber(line, amount)) {
+                throw InvalidInputException("无效的支付金额: " + std::string(line));
+            }
+            OperationResult result = library.payFine(name, amount);
+            out.append("OK,");
+            appendNumber(out, result.amountPaid);
+            out.append(",");
+            appendNumber(out, result.outstandingFine);
+            out.append("\n");
+        } else if (command == "overdue") {
+            LoanReport report = library.overdueReport(DateUtils::getCurrentTime());
+            out.append("OK,");
+            appendNumber(out, report.entries.size());
+            out.append(",");
+            appendNumber(out, report.fineTotal);
+            out.append("\n");
+            for (const auto& entry : report.entries) appendReportEntry(out, entry, true);
+        } else if (command == "duesoon") {
+            int days = 3;
+            if (!line.empty() && (!textparse::parseNumber(line, days) || days < 0)) {
+                throw InvalidInputException("无效的天数: " + std::string(line));
+            }
+            LoanReport report = library.dueSoonReport(days, DateUtils::getCurrentTime());
+            out.append("OK,");
+            appendNumber(out, report.entries.size());
+            out.append("\n");
+            for (const auto& entry : report.entries) appendReportEntry(out, entry, false);
+        } else if (command == "search") {
+            SearchMode mode = parseSearchQuery(line);
+            std::vector<SearchHit> hits = library.searchBooks(line, mode);
+            out.append("OK,");
+            appendNumber(out, hits.size());
+            out.append("\n");
+            for (const SearchHit& hit : hits) {
+                out.append(hit.book->getTitle()).append(",").append(hit.book->getAuthor()).append(",");
+                appendNumber(out, hit.score);
+                out.append("\n");
+            }
+        } else {
+            throw InvalidInputException("未知请求: " + std::string(command));
+        }
+    } catch (const BookNotFoundException& ex) {
+        appendError(out, "BOOK_NOT_FOUND", ex.what());
+    } catch (const ReaderNotFoundException& ex) {
+        appendError(out, "READER_NOT_FOUND", ex.what());
+    } catch (const BookBorrowedException& ex) {
+        appendError(out, "BOOK_BORROWED", ex.what());
+    } catch (const BookNotBorrowedException& ex) {
+        appendError(out, "NOT_BORROWED", ex.what());
+    } catch (const LoanLimitException& ex) {
+        appendError(out, "LOAN_LIMIT", ex.what());
+    } catch (const InvalidInputException& ex) {
+        appendError(out, "INVALID", ex.what());
+    } catch (const std::exception& ex) {
+        appendError(out, "INTERNAL", ex.what());
+    }
+}
+
+#ifdef __linux__
+
+namespace {
+    constexpr int kMaxEvents = 256;
+    constexpr size_t kReadChunk = 16 * 1024;
+
+    std::runtime_error systemError(const std::string& what) {
+        return std::runtime_error(what + ": " + std::strerror(errno));
+    }
+
+    sigset_t shutdownSignals() {
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGINT);
+        sigaddset(&signals, SIGTERM);
+        return signals;
+    }
+
+    // 大量空闲连接需要足够的文件描述符，把软上限提高到硬上限
+    void raiseFileLimit() {
+        rlimit limit{};
+        if (::getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+            limit.rlim_cur = limit.rlim_max;
+            ::setrlimit(RLIMIT_NOFILE, &limit);
+        }
+    }
+}
+
+LibraryServer::LibraryServer(Library& library, ServerOptions options)
+    : library(library), options(std::move(options)) {}
+
+LibraryServer::~LibraryServer() {
+    for (auto& item : connections) ::close(item.first);
+    if (listenFd >= 0) ::close(listenFd);
+    if (epollFd >= 0) ::close(epollFd);
+    if (signalFd >= 0) ::close(signalFd);
+    if (options.endpoint.rfind("tcp:", 0) != 0) ::unlink(options.endpoint.c_str());
+}
+
+void LibraryServer::blockShutdownSignals() {
+    sigset_t signals = shutdownSignals();
+    ::pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+}
+
+void LibraryServer::openListener() {
+    if (options.endpoint.rfind("tcp:", 0) == 0) {
+        int port = 0;
+        if (!textparse::parseNumber(std::string_view(options.endpoint).substr(4), port) || port <= 0 || port > 65535) {
+            throw InvalidInputException("无效的端口: " + options.endpoint);
+        }
+        listenFd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listenFd < 0) throw systemError("无法创建套接字");
+        int enable = 1;
+        ::setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(port));
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            throw systemError("无法绑定端口 " + std::to_string(port));
+        }
+    } else {
+        sockaddr_un address{};
+        if (options.endpoint.size() >= sizeof(address.sun_path)) throw InvalidInputException("套接字路径过长: " + options.endpoint);
+        listenFd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listenFd < 0) throw systemError("无法创建套接字");
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, options.endpoint.c_str(), options.endpoint.size() + 1);
+        // 上次异常退出可能留下套接字文件
+        ::unlink(options.endpoint.c_str());
+        if (::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            throw systemError("无法绑定套接字 " + options.endpoint);
+        }
+    }
+    if (::listen(listenFd, SOMAXCONN) != 0) throw systemError("无法监听 " + options.endpoint);
+}
+
+void LibraryServer::run() {
+    raiseFileLimit();
+    openListener();
+    epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0) throw systemError("无法创建 epoll");
+
+    // SIGINT / SIGTERM 改由 signalfd 在事件循环中处理，退出时正常析构 Library。
+    // 这里只能屏蔽本线程，其他线程由调用方事先通过 blockShutdownSignals 保证
+    blockShutdownSignals();
+    sigset_t signals = shutdownSignals();
+    signalFd = ::signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (signalFd < 0) throw systemError("无法创建 signalfd");
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = listenFd;
+    ::epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event);
+    event.data.fd = signalFd;
+    ::epoll_ctl(epollFd, EPOLL_CTL_ADD, signalFd, &event);
+    std::cout << "\033[1;32m[成功] ✔ 服务已启动: " << options.endpoint << "\033[0m\n" << std::flush;
+
+    epoll_event events[kMaxEvents];
+    while (true) {
+        int count = ::epoll_wait(epollFd, events, kMaxEvents, -1);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            throw systemError("epoll_wait 失败");
+        }
+        for (int i = 0; i < count; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == signalFd) {
+                std::cout << "\033[1;33m收到退出信号，服务停止\033[0m\n";
+                return;
+            }
+            if (fd == listenFd) {
+                acceptConnections();
+                continue;
+            }
+            auto it = connections.find(fd);
+            if (it == connections.end()) continue;
+            if (events[i].events & (EPOLLHUP | EPOLLERR)) {
+                closeConnection(fd);
+                continue;
+            }
+            if ((events[i].events & EPOLLOUT) && !flush(fd, it->second)) continue;
+            if (events[i].events & EPOLLIN) handleReadable(fd, it->second);
+        }
+    }
+}
+
+void LibraryServer::acceptConnections() {
+    while (true) {
+        int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            // EMFILE 等错误时留在队列中，下次可读时再试
+            return;
+        }
+        if (options.endpoint.rfind("tcp:", 0) == 0) {
+            int enable = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+        }
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (::epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            ::close(fd);
+            continue;
+        }
+        connections[fd].interest = EPOLLIN;
+    }
+}
+
+// 读到 EAGAIN 为止，处理缓冲区中所有完整的请求行，再一次性写回响应
+void LibraryServer::handleReadable(int fd, Connection& connection) {
+    char buffer[kReadChunk];
+    bool peerClosed = false;
+    while (true) {
+        ssize_t bytes = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (bytes > 0) {
+            connection.input.append(buffer, static_cast<size_t>(bytes));
+            continue;
+        }
+        if (bytes == 0) peerClosed = true;
+        else if (errno == EINTR) continue;
+        else if (errno != EAGAIN && errno != EWOULDBLOCK) peerClosed = true;
+        break;
+    }
+    std::string_view pending(connection.input);
+    size_t consumed = 0;
+    while (true) {
+        size_t end = pending.find('\n', consumed);
+        if (end == std::string_view::npos) break;
+        std::string_view line = pending.substr(consumed, end - consumed);
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        if (!line.empty()) handleRequest(line, connection.output);
+        consumed = end + 1;
+    }
+    connection.input.erase(0, consumed);
+    if (connection.input.size() > options.maxLineLength) {
+        closeConnection(fd);
+        return;
+    }
+    // 对端只关闭了写端时仍要把已处理请求的响应写完
+    connection.closing = peerClosed;
+    flush(fd, connection);
+}
+
+// 尽量写出缓冲的响应；写不完时关注 EPOLLOUT。连接已关闭时返回 false
+bool LibraryServer::flush(int fd, Connection& connection) {
+    size_t written = 0;
+    while (written < connection.output.size()) {
+        ssize_t bytes = ::send(fd, connection.output.data() + written, connection.output.size() - written, MSG_NOSIGNAL);
+        if (bytes > 0) {
+            written += static_cast<size_t>(bytes);
+            continue;
+        }
+        if (bytes < 0 && errno == EINTR) continue;
+        if (bytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        closeConnection(fd);
+        return false;
+    }
+    connection.output.erase(0, written);
+    if (connection.closing && connection.output.empty()) {
+        closeConnection(fd);
+        return false;
+    }
+    updateInterest(fd, connection);
+    return true;
+}
+
+// 有未写完的响应时关注可写；响应积压过多或对端已关闭写端时不再读取新请求
+void LibraryServer::updateInterest(int fd, Connection& connection) {
+    uint32_t interest = 0;
+    if (!connection.closing && connection.output.size() < options.maxPendingOutput) interest |= EPOLLIN;
+    if (!connection.output.empty()) interest |= EPOLLOUT;
+    if (interest == connection.interest) return;
+    epoll_event event{};
+    event.events = interest;
+    event.data.fd = fd;
+    ::epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event);
+    connection.interest = interest;
+}
+
+void LibraryServer::closeConnection(int fd) {
+    ::epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    connections.erase(fd);
+}
+
+#else
+
+LibraryServer::LibraryServer(Library& library, ServerOptions options)
+    : library(library), options(std::move(options)) {}
+
+LibraryServer::~LibraryServer() = default;
+
+void LibraryServer::run() {
+    throw std::runtime_error("服务器模式仅支持 Linux");
+}
+
+void LibraryServer::blockShutdownSignals() {}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "Library.h"
+
+// 服务器模式：单线程 epoll 事件循环，监听 Unix 域套接字或回环 TCP 端口（仅 Linux）。
+// 请求为按行的文本，字段以逗号分隔；同一连接可以连续发送多条请求，响应按请求顺序返回：
+//   ping                     -> OK
+//   book,<书名>              -> OK,<书名>,<作者>,<类型>,<是否全部借出 0/1>,<在架册数>,<总册数>
+//   reader,<姓名>            -> OK,<姓名>,<会员类型>,<欠款>
+//   account,<姓名>           -> OK,<在借数>,<超期数>,<应计罚款>,<欠款>,<累计借阅数>
+//   borrow,<书名>,<读者>      -> OK,<应还日期>
+//   return,<书名>,<读者>      -> OK,<超期天数>,<罚款>,<为其保留该册的预约读者，没有时为空>
+//   hold,<书名>,<读者>        -> OK,<排队位次>
+//   unhold,<书名>,<读者>      -> OK
+//   pay,<读者>[,<金额>]       -> OK,<支付金额>,<剩余欠款>
+//   overdue                  -> OK,<行数>,<罚款合计>，随后每行 <书名>,<读者>,<应还日期>,<超期天数>,<罚款>
+//   duesoon[,<天数>]         -> OK,<行数>，随后每行 <书名>,<读者>,<应还日期>,<剩余天数>
+//   search,<关键词>[*]       -> OK,<行数>，随后每行 <书名>,<作者>,<得分>；末尾 * 为前缀匹配
+// 失败时返回 ERR,<错误类型>,<原因>；日期均为 Unix 时间戳。
+struct ServerOptions {
+    std::string endpoint = "library.sock";  // Unix 域套接字路径，或 tcp:<端口>（只绑定 127.0.0.1）
+    size_t maxLineLength = 64 * 1024;       // 单条请求超过该长度时断开连接
+    size_t maxPendingOutput = 4 << 20;      // 未读走的响应超过该大小时暂停读取该连接的请求
+};
+
+class LibraryServer {
+public:
+    explicit LibraryServer(Library& library, ServerOptions options = {});
+    ~LibraryServer();
+    LibraryServer(const LibraryServer&) = delete;
+    LibraryServer& operator=(const LibraryServer&) = delete;
+
+    // 阻塞运行，收到 SIGINT / SIGTERM 后关闭所有连接并返回
+    void run();
+    // 在主线程中屏蔽 SIGINT / SIGTERM，改由 run() 的 signalfd 接收。须在创建任何线程（包括构造 Library）之前调用：
+    // 之后的线程继承屏蔽字，信号不会落到未屏蔽的线程上按默认动作直接终止进程
+    static void blockShutdownSignals();
+
+    // 处理一条请求并把响应追加到 out（不涉及套接字，便于脚本和测试直接调用）
+    void handleRequest(std::string_view line, std::string& out);
+
+private:
+    struct Connection {
+        std::string input;
+        std::string output;
+        uint32_t interest = 0;  // 当前在 epoll 中关注的事件
+        bool closing = false;   // 对端已关闭写端，响应写完后关闭
+    };
+
+    void openListener();
+    void acceptConnections();
+    void handleReadable(int fd, Connection& connection);
+    bool flush(int fd, Connection& connection);
+    void updateInterest(int fd, Connection& connection);
+    void closeConnection(int fd);
+
+    Library& library;
+    ServerOptions options;
+    int listenFd = -1;
+    int epollFd = -1;
+    int signalFd = -1;
+    std::unordered_map<int, Connection> connections;
+};
\ No newline at end of file
@@ -0,0 +1,171 @@
+#include "Snapshot.h"
+#include "Exceptions.h"
+#include "FileSync.h"
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+namespace {
+    constexpr uint64_t kAlignment = 8;
+    constexpr size_t kVersion1HeaderSize = offsetof(snapshot::Header, journalGeneration);
+    constexpr size_t kVersion3HeaderSize = offsetof(snapshot::Header, loanBlocks);
+    constexpr size_t kVersion4HeaderSize = offsetof(snapshot::Header, readerLoans);
+    constexpr size_t kVersion6HeaderSize = offsetof(snapshot::Header, holds);
+
+    uint64_t alignUp(uint64_t value) {
+        return (value + kAlignment - 1) & ~(kAlignment - 1);
+    }
+
+    template <typename T>
+    snapshot::Section place(uint64_t& cursor, size_t count) {
+        snapshot::Section s{ cursor, count };
+        cursor = alignUp(cursor + count * sizeof(T));
+        return s;
+    }
+
+    bool writeAt(std::FILE* out, uint64_t& cursor, uint64_t offset, const void* data, size_t bytes) {
+        static const char padding[kAlignment] = {};
+        size_t gap = static_cast<size_t>(offset - cursor);
+        cursor = offset + bytes;
+        return std::fwrite(padding, 1, gap, out) == gap && (bytes == 0 || std::fwrite(data, 1, bytes, out) == bytes);
+    }
+
+    template <typename T>
+    void checkSection(const snapshot::Section& s, size_t fileSize) {
+        if (s.offset % alignof(T) != 0 || s.offset > fileSize || s.count > (fileSize - s.offset) / sizeof(T)) {
+            throw DataFormatException("快照文件已损坏: 数据区越界");
+        }
+    }
+}
+
+uint32_t SnapshotWriter::addString(std::string_view value) {
+    auto it = stringIds.find(value);
+    if (it != stringIds.end()) return it->second;
+    uint32_t id = static_cast<uint32_t>(strings.size());
+    strings.push_back({ stringData.size(), static_cast<uint32_t>(value.size()), 0 });
+    stringData.append(value);
+    stringIds.emplace(value, id);
+    return id;
+}
+
+void SnapshotWriter::write(const std::string& path) {
+    std::string loanData;
+    std::vector<loanarchive::BlockInfo> loanBlocks;
+    loanarchive::encode(records, loanData, loanBlocks);
+
+    snapshot::Header header{};
+    std::memcpy(header.magic, snapshot::kMagic, sizeof(header.magic));
+    header.version = snapshot::kVersion;
+    header.headerSize = sizeof(header);
+    header.journalGeneration = journalGeneration;
+
+    uint64_t cursor = alignUp(sizeof(header));
+    header.strings = place<snapshot::StringRef>(cursor, strings.size());
+    header.stringData = place<char>(cursor, stringData.size());
+    header.books = place<snapshot::BookEntry>(cursor, books.size());
+    header.readers = place<snapshot::ReaderEntry>(cursor, readers.size());
+    header.readerLoans = place<uint64_t>(cursor, readerLoans.size());
+    header.records = place<snapshot::RecordEntry>(cursor, 0);
+    header.loanBlocks = place<loanarchive::BlockInfo>(cursor, loanBlocks.size());
+    header.loanData = place<char>(cursor, loanData.size());
+    header.users = place<snapshot::UserEntry>(cursor, users.size());
+    header.holds = place<snapshot::HoldEntry>(cursor, holds.size());
+
+    std::string tempPath = path + ".tmp";
+    std::FILE* out = std::fopen(tempPath.c_str(), "wb");
+    if (!out) throw std::runtime_error("无法写入快照文件: " + tempPath);
+    uint64_t written = 0;
+    bool ok = writeAt(out, written, 0, &header, sizeof(header))
+        && writeAt(out, written, header.strings.offset, strings.data(), strings.size() * sizeof(snapshot::StringRef))
+        && writeAt(out, written, header.stringData.offset, stringData.data(), stringData.size())
+        && writeAt(out, written, header.books.offset, books.data(), books.size() * sizeof(snapshot::BookEntry))
+        && writeAt(out, written, header.readers.offset, readers.data(), readers.size() * sizeof(snapshot::ReaderEntry))
+        && writeAt(out, written, header.readerLoans.offset, readerLoans.data(), readerLoans.size() * sizeof(uint64_t))
+        && writeAt(out, written, header.loanBlocks.offset, loanBlocks.data(), loanBlocks.size() * sizeof(loanarchive::BlockInfo))
+        && writeAt(out, written, header.loanData.offset, loanData.data(), loanData.size())
+        && writeAt(out, written, header.users.offset, users.data(), users.size() * sizeof(snapshot::UserEntry))
+        && writeAt(out, written, header.holds.offset, holds.data(), holds.size() * sizeof(snapshot::HoldEntry))
+        && syncFile(out);
+    std::fclose(out);
+    if (!ok) throw std::runtime_error("无法写入快照文件: " + tempPath);
+    std::filesystem::rename(tempPath, path);
+}
+
+SnapshotReader::SnapshotReader(const std::string& path) : file(path) {
+    if (!file.isOpen()) return;
+    if (file.size() < kVersion1HeaderSize) throw DataFormatException("快照文件已损坏: 文件头不完整");
+    header = reinterpret_cast<const snapshot::Header*>(file.begin());
+    if (std::memcmp(header->magic, snapshot::kMagic, sizeof(header->magic)) != 0) {
+        throw DataFormatException("不是有效的快照文件: " + path);
+    }
+    // 版本 1 的文件头没有日志代号字段，其余布局相同；版本 3 只启用了 BookEntry 的类别字节；
+    // 版本 4 在文件头末尾增加了列式借阅记录的两个区，版本 5 增加了读者累计借阅数区，版本 6 的文件头与 5 相同，版本 7 增加了预约区
+    bool knownLayout = (header->version == 1 && header->headerSize == kVersion1HeaderSize)
+        || (header->version >= 2 && header->version <= 3 && header->headerSize == kVersion3HeaderSize)
+        || (header->version == 4 && header->headerSize == kVersion4HeaderSize)
+        || (header->version >= 5 && header->version <= 6 && header->headerSize == kVersion6HeaderSize)
+        || (header->version == snapshot::kVersion && header->headerSize == sizeof(snapshot::Header));
+    if (!knownLayout || file.size() < header->headerSize) {
+        throw DataFormatException("不支持的快照版本: " + std::to_string(header->version));
+    }
+    checkSection<snapshot::StringRef>(header->strings, file.size());
+    checkSection<char>(header->stringData, file.size());
+    checkSection<snapshot::BookEntry>(header->books, file.size());
+    checkSection<snapshot::ReaderEntry>(header->readers, file.size());
+    checkSection<snapshot::RecordEntry>(header->records, file.size());
+    checkSection<snapshot::UserEntry>(header->users, file.size());
+    if (header->version >= 4) {
+        checkSection<loanarchive::BlockInfo>(header->loanBlocks, file.size());
+        checkSection<char>(header->loanData, file.size());
+    }
+    if (header->version >= 5) {
+        checkSection<uint64_t>(header->readerLoans, file.size());
+        if (header->readerLoans.count != header->readers.count) throw DataFormatException("快照文件已损坏: 读者统计区长度不符");
+    }
+    if (header->version >= 7) checkSection<snapshot::HoldEntry>(header->holds, file.size());
+}
+
+const uint64_t* SnapshotReader::readerLoans() const {
+    return header->version >= 5 ? section<uint64_t>(header->readerLoans) : nullptr;
+}
+
+size_t SnapshotReader::recordCount() const {
+    if (header->version < 4) return header->records.count;
+    size_t count = 0;
+    const auto* blocks = section<loanarchive::BlockInfo>(header->loanBlocks);
+    for (size_t i = 0; i < header->loanBlocks.count; ++i) count += blocks[i].count;
+    return count;
+}
+
+void SnapshotReader::forEachRecord(const std::function<void(const LoanRow&)>& visit) const {
+    if (header->version < 4) {
+        const snapshot::RecordEntry* entries = section<snapshot::RecordEntry>(header->records);
+        for (size_t i = 0; i < header->records.count; ++i) {
+            const snapshot::RecordEntry& entry = entries[i];
+            visit({ entry.book, entry.reader, entry.borrowDate, entry.dueDate, entry.returnDate, entry.returned != 0 });
+        }
+        return;
+    }
+    const auto* blocks = section<loanarchive::BlockInfo>(header->loanBlocks);
+    const char* data = section<char>(header->loanData);
+    std::vector<LoanRow> rows;
+    for (size_t i = 0; i < header->loanBlocks.count; ++i) {
+        rows.clear();
+        loanarchive::decodeBlock(data, header->loanData.count, blocks[i], rows);
+        for (const LoanRow& row : rows) visit(row);
+    }
+}
+
+uint64_t SnapshotReader::journalGeneration() const {
+    return header->version >= 2 ? header->journalGeneration : 0;
+}
+
+std::string_view SnapshotReader::string(uint32_t id) const {
+    if (id >= header->strings.count) throw DataFormatException("快照文件已损坏: 字符串编号越界");
+    const snapshot::StringRef& ref = section<snapshot::StringRef>(header->strings)[id];
+    if (ref.offset > header->stringData.count || ref.length > header->stringData.count - ref.offset) {
+        throw DataFormatException("快照文件已损坏: 字符串越界");
+    }
+    return std::string_view(file.begin() + header->stringData.offset + ref.offset, ref.length);
+}
\ No newline at end of file
@@ -0,0 +1,155 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "LoanArchive.h"
+#include "MappedFile.h"
+#include "StringHash.h"
+
+// 二进制快照格式：文件头 + 字符串表 + 定长记录区。
+// 各区按 8 字节对齐，加载时直接在映射内存上读取，不做逐字段文本解析。
+// 版本 4 起借阅记录改为列式分块编码（见 LoanArchive.h），图书 / 读者编号即 books / readers 区下标。
+// 版本 5 起另存各读者的累计借阅数（含已移入历史文件的记录）。
+// 版本 6 起每个书名只有一条图书记录，带副本数；借阅记录带副本编号。更早的版本中同名图书各占一条，加载时合并为副本。
+// 版本 7 起另存预约队列，同一书名的预约按排队顺序排列。
+namespace snapshot {
+    constexpr char kMagic[8] = { 'L', 'I', 'B', 'S', 'N', 'A', 'P', '\0' };
+    constexpr uint32_t kVersion = 7;
+    constexpr uint32_t kNoIndex = 0xFFFFFFFFu;
+
+    enum UserType : uint8_t { AdministratorUser = 0, ReaderAccount = 1 };
+
+    struct Section {
+        uint64_t offset;
+        uint64_t count;
+    };
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t headerSize;
+        Section strings;     // StringRef[count]
+        Section stringData;  // count 为字节数
+        Section books;
+        Section readers;
+        Section records;
+        Section users;
+        uint64_t journalGeneration;  // 版本 2 起：与之配套的日志代号
+        // 版本 4 起：借阅记录的块索引（BlockInfo[count]）和块数据（count 为字节数），records 区为空
+        Section loanBlocks;
+        Section loanData;
+        // 版本 5 起：与 readers 区一一对应的累计借阅数（uint64_t[count]）
+        Section readerLoans;
+        // 版本 7 起：预约（HoldEntry[count]）
+        Section holds;
+    };
+
+    struct StringRef {
+        uint64_t offset;
+        uint32_t length;
+        uint32_t reserved;
+    };
+
+    struct BookEntry {
+        uint32_t title;
+        uint32_t author;
+        uint32_t type;
+        uint8_t borrowed;  // 版本 6 起只作参考（全部副本借出），在架状态由未还借阅记录恢复
+        uint8_t category;  // 版本 3 起：BookCategory，更早的版本为 0，需按类型名推断
+        uint16_t copies;   // 版本 6 起：副本数，更早的版本为 0（即 1 册）
+    };
+
+    struct ReaderEntry {
+        uint32_t name;
+        uint8_t type;  // MemberTier
+        uint8_t reserved[3];
+        double fine;
+    };
+
+    // 版本 3 及以前的定长借阅记录
+    struct RecordEntry {
+        uint32_t book;    // books 区下标
+        uint32_t reader;  // readers 区下标
+        int64_t borrowDate;
+        int64_t dueDate;
+        int64_t returnDate;
+        uint8_t returned;
+        uint8_t reserved[7];
+    };
+
+    // 预约：deadline 为 0 表示仍在排队，否则已为该读者保留 copy 号副本
+    struct HoldEntry {
+        uint32_t book;    // books 区下标
+        uint32_t reader;  // readers 区下标
+        int64_t placed;
+        int64_t deadline;
+        uint32_t copy;
+        uint32_t reserved;
+    };
+
+    struct UserEntry {
+        uint32_t username;
+        uint32_t password;
+        uint32_t reader;  // readers 区下标，管理员为 kNoIndex
+        uint8_t type;
+        uint8_t reserved[3];
+    };
+}
+
+// 快照写入：先写临时文件并刷盘再替换，写入中途崩溃不会破坏旧快照
+class SnapshotWriter {
+public:
+    uint32_t addString(std::string_view value);
+    // 写入时借阅记录按借阅时间排序
+    void write(const std::string& path);
+
+    uint64_t journalGeneration = 0;
+    std::vector<snapshot::BookEntry> books;
+    std::vector<snapshot::ReaderEntry> readers;
+    std::vector<uint64_t> readerLoans;
+    std::vector<LoanRow> records;
+    std::vector<snapshot::UserEntry> users;
+    std::vector<snapshot::HoldEntry> holds;
+
+private:
+    std::vector<snapshot::StringRef> strings;
+    std::string stringData;
+    StringMap<uint32_t> stringIds;
+};
+
+// 快照读取：映射整个文件并校验文件头和各区边界，格式错误时抛出 DataFormatException
+class SnapshotReader {
+public:
+    explicit SnapshotReader(const std::string& path);
+
+    bool isOpen() const { return file.isOpen(); }
+    std::string_view string(uint32_t id) const;
+    uint64_t journalGeneration() const;
+    uint32_t version() const { return header->version; }
+
+    const snapshot::BookEntry* books() const { return section<snapshot::BookEntry>(header->books); }
+    const snapshot::ReaderEntry* readers() const { return section<snapshot::ReaderEntry>(header->readers); }
+    const snapshot::UserEntry* users() const { return section<snapshot::UserEntry>(header->users); }
+    size_t bookCount() const { return header->books.count; }
+    size_t readerCount() const { return header->readers.count; }
+    // 版本 5 以前没有该区，返回 nullptr
+    const uint64_t* readerLoans() const;
+    size_t recordCount() const;
+    // 逐条读出借阅记录，各版本格式统一转换为 LoanRow；块数据损坏时抛出 DataFormatException
+    void forEachRecord(const std::function<void(const LoanRow&)>& visit) const;
+    size_t userCount() const { return header->users.count; }
+    // 版本 7 以前没有预约，返回 0
+    const snapshot::HoldEntry* holds() const { return section<snapshot::HoldEntry>(header->holds); }
+    size_t holdCount() const { return header->version >= 7 ? header->holds.count : 0; }
+
+private:
+    template <typename T>
+    const T* section(const snapshot::Section& s) const {
+        return reinterpret_cast<const T*>(file.begin() + s.offset);
+    }
+
+    MappedFile file;
+    const snapshot::Header* header = nullptr;
+};
\ No newline at end of file
@@ -0,0 +1,15 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <functional>
+#include <unordered_map>
+
+// 透明字符串哈希：允许用 std::string_view / const char* 直接查找，不构造临时 std::string
+struct StringHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view key) const { return std::hash<std::string_view>{}(key); }
+};
+
+// 以字符串为键、支持异构查找的哈希表
+template <typename T>
+using StringMap = std::unordered_map<std::string, T, StringHash, std::equal_to<>>;
\ No newline at end of file
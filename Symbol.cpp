@@ -0,0 +1,103 @@
+#include "Symbol.h"
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    // 全局驻留表。字符内容存放在只追加的内存块里，编号到内容的映射是定长分页表，
+    // 两者都不会搬移已有数据，所以 view() 读取时无需加锁。
+    class SymbolTable {
+    public:
+        static SymbolTable& instance() {
+            static SymbolTable table;
+            return table;
+        }
+
+        uint32_t intern(std::string_view text) {
+            {
+                std::shared_lock<std::shared_mutex> lock(mutex);
+                auto it = ids.find(text);
+                if (it != ids.end()) return it->second;
+            }
+            std::unique_lock<std::shared_mutex> lock(mutex);
+            auto it = ids.find(text);
+            if (it != ids.end()) return it->second;
+            return insert(text);
+        }
+
+        std::optional<uint32_t> find(std::string_view text) const {
+            std::shared_lock<std::shared_mutex> lock(mutex);
+            auto it = ids.find(text);
+            if (it == ids.end()) return std::nullopt;
+            return it->second;
+        }
+
+        std::string_view view(uint32_t id) const {
+            return pages[id >> kPageBits][id & (kPageSize - 1)];
+        }
+
+    private:
+        static constexpr uint32_t kPageBits = 12;
+        static constexpr uint32_t kPageSize = 1u << kPageBits;
+        static constexpr uint32_t kMaxPages = 1u << 16;
+        static constexpr size_t kArenaBlock = 64 * 1024;
+
+        SymbolTable() : pages(std::make_unique<std::unique_ptr<std::string_view[]>[]>(kMaxPages)) {
+            insert(std::string_view());  // 编号 0 固定为空字符串
+        }
+
+        uint32_t insert(std::string_view text) {
+            if (count == kPageSize * kMaxPages) throw std::length_error("驻留字符串数量超出上限");
+            std::string_view stored = store(text);
+            uint32_t id = count;
+            auto& page = pages[id >> kPageBits];
+            if (!page) page = std::make_unique<std::string_view[]>(kPageSize);
+            page[id & (kPageSize - 1)] = stored;
+            ids.emplace(stored, id);
+            ++count;
+            return id;
+        }
+
+        std::string_view store(std::string_view text) {
+            if (text.empty()) return std::string_view();
+            if (arenaFree < text.size()) {
+                size_t size = std::max(kArenaBlock, text.size());
+                arena.push_back(std::make_unique<char[]>(size));
+                arenaCursor = arena.back().get();
+                arenaFree = size;
+            }
+            std::memcpy(arenaCursor, text.data(), text.size());
+            std::string_view stored(arenaCursor, text.size());
+            arenaCursor += text.size();
+            arenaFree -= text.size();
+            return stored;
+        }
+
+        mutable std::shared_mutex mutex;
+        std::unordered_map<std::string_view, uint32_t> ids;
+        std::unique_ptr<std::unique_ptr<std::string_view[]>[]> pages;
+        std::vector<std::unique_ptr<char[]>> arena;
+        char* arenaCursor = nullptr;
+        size_t arenaFree = 0;
+        uint32_t count = 0;
+    };
+}
+
+uint32_t Symbol::intern(std::string_view text) {
+    return SymbolTable::instance().intern(text);
+}
+
+std::optional<Symbol> Symbol::find(std::string_view text) {
+    auto id = SymbolTable::instance().find(text);
+    if (!id) return std::nullopt;
+    return Symbol(*id);
+}
+
+std::string_view Symbol::view() const {
+    return SymbolTable::instance().view(index);
+}
\ No newline at end of file
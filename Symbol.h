@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string_view>
+
+// 驻留字符串句柄：相同内容的字符串在全局驻留表中只存一份，
+// 句柄相等即内容相等。驻留的内容在进程生命周期内不释放，view() 始终有效。
+class Symbol {
+public:
+    Symbol() = default;  // 空字符串
+    explicit Symbol(std::string_view text) : index(intern(text)) {}
+
+    // 查找已驻留的字符串，不存在时不插入
+    static std::optional<Symbol> find(std::string_view text);
+
+    std::string_view view() const;
+    uint32_t id() const { return index; }
+
+    bool operator==(Symbol other) const { return index == other.index; }
+    bool operator!=(Symbol other) const { return index != other.index; }
+
+private:
+    explicit Symbol(uint32_t index) : index(index) {}
+    static uint32_t intern(std::string_view text);
+
+    uint32_t index = 0;
+};
+
+template <>
+struct std::hash<Symbol> {
+    size_t operator()(Symbol symbol) const noexcept { return std::hash<uint32_t>{}(symbol.id()); }
+};
\ No newline at end of file
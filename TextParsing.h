@@ -0,0 +1,44 @@
+#pragma once
+#include <charconv>
+#include <string_view>
+#include <vector>
+
+// 文本数据文件的零拷贝解析工具，所有结果都是指向原缓冲区的 string_view
+namespace textparse {
+    // 取出下一行（去掉行尾 \r\n），text 前移到下一行开头
+    inline std::string_view nextLine(std::string_view& text) {
+        size_t end = text.find('\n');
+        std::string_view line = text.substr(0, end);
+        text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        return line;
+    }
+
+    // 取出下一个字段，line 前移到分隔符之后；没有分隔符时返回剩余全部内容
+    inline std::string_view nextField(std::string_view& line, char separator = ',') {
+        size_t end = line.find(separator);
+        std::string_view field = line.substr(0, end);
+        line.remove_prefix(end == std::string_view::npos ? line.size() : end + 1);
+        return field;
+    }
+
+    template <typename T>
+    inline bool parseNumber(std::string_view text, T& value) {
+        auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+        return result.ec == std::errc() && result.ptr == text.data() + text.size();
+    }
+
+    // 按行边界把文本切成大致均匀的若干块
+    inline std::vector<std::string_view> splitLines(std::string_view text, size_t chunkCount) {
+        std::vector<std::string_view> chunks;
+        if (chunkCount == 0) chunkCount = 1;
+        size_t target = text.size() / chunkCount + 1;
+        while (!text.empty()) {
+            size_t end = text.size() <= target ? std::string_view::npos : text.find('\n', target);
+            size_t length = end == std::string_view::npos ? text.size() : end + 1;
+            chunks.push_back(text.substr(0, length));
+            text.remove_prefix(length);
+        }
+        return chunks;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+#include "TimingWheel.h"
+#include <algorithm>
+
+TimingWheel::TimingWheel(std::time_t tickSeconds, size_t slotCount)
+    : tick(std::max<std::time_t>(tickSeconds, 1)), heads(std::max<size_t>(slotCount, 1), npos) {}
+
+void TimingWheel::schedule(uint32_t id, std::time_t deadline) {
+    if (id >= nodes.size()) nodes.resize(id + 1);
+    if (nodes[id].scheduled) unlink(id);
+    Node& node = nodes[id];
+    node.due = std::max<int64_t>((deadline + tick - 1) / tick, current + 1);
+    uint32_t& head = heads[static_cast<size_t>(node.due) % heads.size()];
+    node.prev = npos;
+    node.next = head;
+    if (head != npos) nodes[head].prev = id;
+    head = id;
+    node.scheduled = true;
+    ++count;
+}
+
+void TimingWheel::cancel(uint32_t id) {
+    if (isScheduled(id)) unlink(id);
+}
+
+void TimingWheel::advance(std::time_t now, std::vector<uint32_t>& expired) {
+    int64_t target = now / tick;
+    if (target <= current) return;
+    // 间隔超过一整圈时每个槽只需走一遍
+    if (count > 0) {
+        if (target - current >= static_cast<int64_t>(heads.size())) {
+            for (size_t slot = 0; slot < heads.size(); ++slot) collect(slot, target, expired);
+        } else {
+            for (int64_t t = current + 1; t <= target; ++t) collect(static_cast<size_t>(t) % heads.size(), target, expired);
+        }
+    }
+    current = target;
+}
+
+void TimingWheel::clear() {
+    std::fill(heads.begin(), heads.end(), npos);
+    nodes.clear();
+    current = 0;
+    count = 0;
+}
+
+void TimingWheel::unlink(uint32_t id) {
+    Node& node = nodes[id];
+    if (node.prev != npos) {
+        nodes[node.prev].next = node.next;
+    } else {
+        heads[static_cast<size_t>(node.due) % heads.size()] = node.next;
+    }
+    if (node.next != npos) nodes[node.next].prev = node.prev;
+    node.prev = node.next = npos;
+    node.scheduled = false;
+    --count;
+}
+
+void TimingWheel::collect(size_t slot, int64_t upTo, std::vector<uint32_t>& expired) {
+    uint32_t id = heads[slot];
+    while (id != npos) {
+        uint32_t next = nodes[id].next;
+        if (nodes[id].due <= upTo) {
+            unlink(id);
+            expired.push_back(id);
+        }
+        id = next;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <vector>
+
+// 散列时间轮：到期时间按刻度取整后落在 (刻度序号 % 槽数) 的槽里，同槽条目以编号为链接的双向链表相连。
+// 登记、撤销都是 O(1)；推进时只走过经过的刻度对应的槽，取出其中已到期的条目，
+// 尚未到期的（相差整圈以上）留在原槽。条目编号由调用方分配，建议连续复用以免节点表变大。
+class TimingWheel {
+public:
+    static constexpr uint32_t npos = UINT32_MAX;
+
+    explicit TimingWheel(std::time_t tickSeconds = 60 * 60, size_t slotCount = 256);
+
+    // 登记 / 改期：到期时间向上取整到刻度，早于已推进到的刻度时在下一刻度到期
+    void schedule(uint32_t id, std::time_t deadline);
+    void cancel(uint32_t id);
+    bool isScheduled(uint32_t id) const { return id < nodes.size() && nodes[id].scheduled; }
+    // 推进到 now，到期条目的编号追加到 expired 并撤销登记
+    void advance(std::time_t now, std::vector<uint32_t>& expired);
+    // 下一次推进可能取出条目的时刻，早于此时调用 advance 不会有结果
+    std::time_t nextCheck() const { return (current + 1) * tick; }
+    // 刻度取整后的到期时间
+    std::time_t roundUp(std::time_t deadline) const { return (deadline + tick - 1) / tick * tick; }
+    size_t size() const { return count; }
+    void clear();
+
+private:
+    struct Node {
+        int64_t due = 0;  // 到期的刻度序号
+        uint32_t prev = npos;
+        uint32_t next = npos;
+        bool scheduled = false;
+    };
+
+    void unlink(uint32_t id);
+    void collect(size_t slot, int64_t upTo, std::vector<uint32_t>& expired);
+
+    std::time_t tick;
+    std::vector<uint32_t> heads;
+    std::vector<Node> nodes;
+    int64_t current = 0;  // 已推进到的刻度序号
+    size_t count = 0;
+};
\ No newline at end of file
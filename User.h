@@ -1,17 +1,21 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <vector>
-#include "Reader.h" 
+#include "Reader.h"
+#include "Symbol.h"
 class User {
 public:
     User(const std::string& username, const std::string& password);
     virtual ~User() = default;
-    std::string getUsername() const { return username; }
+    std::string_view getUsername() const { return username.view(); }
+    Symbol getUsernameSymbol() const { return username; }
+    const std::string& getPassword() const { return password; }
     bool verifyPassword(const std::string& inputPassword) const;
     virtual bool isAdmin() const { return false; }
 
 private:
-    std::string username;
+    Symbol username;
     std::string password;
 };
 
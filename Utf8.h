@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// 检索用的 UTF-8 小工具：按字符切分文本，ASCII 字母统一为小写
+namespace utf8 {
+    // 解码一个 UTF-8 字符；非法字节按单字节处理，映射到码位范围之外以免与正常字符冲突
+    inline uint32_t next(std::string_view text, size_t& pos) {
+        unsigned char lead = static_cast<unsigned char>(text[pos]);
+        size_t length = lead < 0x80 ? 1 : (lead >> 5) == 0x6 ? 2 : (lead >> 4) == 0xE ? 3 : (lead >> 3) == 0x1E ? 4 : 0;
+        if (length == 0 || pos + length > text.size()) {
+            ++pos;
+            return 0x110000u + lead;
+        }
+        uint32_t value = length == 1 ? lead : lead & (0x7F >> length);
+        for (size_t i = 1; i < length; ++i) {
+            unsigned char next = static_cast<unsigned char>(text[pos + i]);
+            if ((next & 0xC0) != 0x80) {
+                ++pos;
+                return 0x110000u + lead;
+            }
+            value = (value << 6) | (next & 0x3F);
+        }
+        pos += length;
+        return value;
+    }
+
+    inline std::string foldCase(std::string_view text) {
+        std::string result(text);
+        for (char& c : result) {
+            if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+        }
+        return result;
+    }
+
+    // 解码为码位序列并统一大小写，供按字符计算编辑距离
+    inline std::u32string decodeFolded(std::string_view text) {
+        std::u32string result;
+        result.reserve(text.size());
+        for (size_t pos = 0; pos < text.size();) {
+            uint32_t c = next(text, pos);
+            if (c >= 'A' && c <= 'Z') c += 'a' - 'A';
+            result.push_back(c);
+        }
+        return result;
+    }
+}
\ No newline at end of file
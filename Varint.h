@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "Exceptions.h"
+
+// LEB128 变长整数；有符号数先做 zigzag 变换，绝对值小的负数也只占 1～2 字节
+namespace varint {
+    inline void put(std::string& out, uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<char>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+
+    inline void putSigned(std::string& out, int64_t value) {
+        put(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+    }
+
+    // 顺序读取一段缓冲区，越界时抛出 DataFormatException
+    class Reader {
+    public:
+        Reader(const char* data, size_t length) : cursor(data), end(data + length) {}
+
+        uint64_t next() {
+            uint64_t value = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                if (cursor == end) break;
+                uint8_t byte = static_cast<uint8_t>(*cursor++);
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) return value;
+            }
+            throw DataFormatException("数据已损坏: 变长整数不完整");
+        }
+
+        int64_t nextSigned() {
+            uint64_t value = next();
+            return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+        }
+
+        std::string_view bytes(size_t length) {
+            if (remaining() < length) throw DataFormatException("数据已损坏: 内容不完整");
+            std::string_view value(cursor, length);
+            cursor += length;
+            return value;
+        }
+
+        size_t remaining() const { return static_cast<size_t>(end - cursor); }
+
+    private:
+        const char* cursor;
+        const char* end;
+    };
+}
\ No newline at end of file
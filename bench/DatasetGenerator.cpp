@@ -0,0 +1,182 @@
+#include "DatasetGenerator.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+    const char* const kTitleWords[] = {
+        "数据", "结构", "算法", "导论", "计算机", "系统", "网络", "原理", "设计", "模式",
+        "深入", "理解", "编程", "实践", "分析", "历史", "世界", "中国", "文学", "经济",
+        "哲学", "心理学", "艺术", "音乐", "科学", "物理", "化学", "生物", "数学", "统计",
+        "Modern", "Advanced", "Introduction", "Practical", "Systems", "Theory", "Guide", "Essential",
+        "C++", "Rust", "Python", "Java", "Linux", "Database", "Compiler", "Network",
+    };
+    const char* const kSurnames[] = { "张", "王", "李", "赵", "刘", "陈", "杨", "黄", "周", "吴", "徐", "孙", "马", "朱", "胡" };
+    const char* const kGivenNames[] = {
+        "伟", "芳", "娜", "敏", "静", "丽", "强", "磊", "军", "洋", "勇", "艳", "杰", "娟", "涛", "明", "超", "秀", "霞", "平",
+    };
+    const char* const kBookTypes[] = { "普通图书", "教科书", "小说", "杂志" };
+    const char* const kTierTags[] = { "RegularMember", "VIPMember", "StudentMember" };
+    const int kBorrowPeriods[] = { 30, 60, 45 };
+    constexpr std::time_t kDay = 24 * 60 * 60;
+
+    template <size_t N>
+    constexpr size_t countOf(const char* const (&)[N]) { return N; }
+
+    // 编号的确定性散列，书名 / 姓名只由编号决定
+    uint64_t mix(uint64_t value) {
+        value += 0x9E3779B97F4A7C15ull;
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+        return value ^ (value >> 31);
+    }
+
+    // Zipf 抽样：预先计算累积分布，抽样时二分查找；排名经打乱后映射到编号，热门对象不集中在文件开头
+    class ZipfSampler {
+    public:
+        ZipfSampler(size_t count, double skew, std::mt19937_64& rng) : cumulative(count), ranks(count) {
+            double total = 0.0;
+            for (size_t i = 0; i < count; ++i) {
+                total += 1.0 / std::pow(static_cast<double>(i + 1), skew);
+                cumulative[i] = total;
+            }
+            for (double& value : cumulative) value /= total;
+            for (size_t i = 0; i < count; ++i) ranks[i] = i;
+            std::shuffle(ranks.begin(), ranks.end(), rng);
+        }
+
+        size_t operator()(std::mt19937_64& rng) const {
+            double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+            size_t rank = std::lower_bound(cumulative.begin(), cumulative.end(), u) - cumulative.begin();
+            return ranks[std::min(rank, ranks.size() - 1)];
+        }
+
+    private:
+        std::vector<double> cumulative;
+        std::vector<size_t> ranks;
+    };
+
+    struct FileCloser {
+        void operator()(FILE* file) const { std::fclose(file); }
+    };
+    using File = std::unique_ptr<FILE, FileCloser>;
+
+    File openOutput(const std::string& path) {
+        File file(std::fopen(path.c_str(), "wb"));
+        if (!file) throw std::runtime_error("无法写入数据集文件: " + path);
+        std::setvbuf(file.get(), nullptr, _IOFBF, 1 << 20);
+        return file;
+    }
+
+    uint64_t finish(File& file, const std::string& path) {
+        long size = std::ftell(file.get());
+        if (std::fflush(file.get()) != 0 || std::ferror(file.get())) throw std::runtime_error("写入数据集文件失败: " + path);
+        return size > 0 ? static_cast<uint64_t>(size) : 0;
+    }
+
+    // 会员等级按 7:1:2 分布
+    size_t tierOf(size_t reader) {
+        uint64_t bucket = mix(reader ^ 0x5EED) % 10;
+        return bucket < 7 ? 0 : bucket < 8 ? 1 : 2;
+    }
+    size_t typeOf(size_t book) { return mix(book ^ 0x7E57) % 4; }
+}
+
+std::string datasetBookTitle(size_t index) {
+    uint64_t hash = mix(index);
+    size_t words = 2 + hash % 3;
+    std::string title;
+    for (size_t i = 0; i < words; ++i) {
+        hash = mix(hash);
+        title += kTitleWords[hash % countOf(kTitleWords)];
+    }
+    // 编号后缀保证书名唯一
+    char suffix[24];
+    std::snprintf(suffix, sizeof(suffix), " 第%zu卷", index);
+    return title + suffix;
+}
+
+std::string datasetReaderName(size_t index) {
+    uint64_t hash = mix(index ^ 0xA11CE);
+    std::string name = kSurnames[hash % countOf(kSurnames)];
+    name += kGivenNames[(hash >> 8) % countOf(kGivenNames)];
+    if ((hash >> 16) & 1) name += kGivenNames[(hash >> 24) % countOf(kGivenNames)];
+    return name + std::to_string(index);
+}
+
+DatasetSummary generateDataset(const std::string& directory, const DatasetOptions& options) {
+    if (options.books == 0 || options.readers == 0) throw std::runtime_error("图书和读者数量必须大于 0");
+    DatasetSummary summary;
+    std::mt19937_64 rng(options.seed);
+    std::time_t now = std::time(nullptr);
+
+    // 先决定哪些图书处于借出状态，其未还记录放在最后写出
+    std::vector<bool> open(options.books, false);
+    size_t openTarget = std::min(options.records, static_cast<size_t>(options.books * options.openFraction));
+    for (size_t i = 0; i < openTarget; ++i) open[mix(i ^ options.seed) % options.books] = true;
+
+    std::string bookPath = directory + "/books.txt";
+    File bookFile = openOutput(bookPath);
+    for (size_t i = 0; i < options.books; ++i) {
+        std::fprintf(bookFile.get(), "%s,%s,%s,%d\n", kBookTypes[typeOf(i)], datasetBookTitle(i).c_str(),
+            datasetReaderName(mix(i) % 5000).c_str(), open[i] ? 1 : 0);
+        summary.openLoans += open[i];
+    }
+    summary.bytes += finish(bookFile, bookPath);
+    summary.books = options.books;
+
+    std::string readerPath = directory + "/readers.txt";
+    File readerFile = openOutput(readerPath);
+    for (size_t i = 0; i < options.readers; ++i) {
+        size_t tier = tierOf(i);
+        double fine = mix(i) % 20 == 0 ? static_cast<double>(mix(i) % 50) : 0.0;
+        std::fprintf(readerFile.get(), "%s,%s,%d,%g\n", kTierTags[tier], datasetReaderName(i).c_str(), kBorrowPeriods[tier], fine);
+    }
+    summary.bytes += finish(readerFile, readerPath);
+    summary.readers = options.readers;
+
+    ZipfSampler bookSampler(options.books, options.skew, rng);
+    ZipfSampler readerSampler(options.readers, options.skew, rng);
+    std::string recordPath = directory + "/records.txt";
+    File recordFile = openOutput(recordPath);
+    // 已还记录：借阅日期在两年前到两个月前之间，归还时间在借期内外随机
+    size_t returned = options.records - summary.openLoans;
+    std::uniform_int_distribution<std::time_t> borrowOffset(60 * kDay, 730 * kDay);
+    for (size_t i = 0; i < returned; ++i) {
+        size_t reader = readerSampler(rng);
+        int period = kBorrowPeriods[tierOf(reader)];
+        std::time_t borrowDate = now - borrowOffset(rng);
+        std::time_t dueDate = borrowDate + period * kDay;
+        std::time_t returnDate = borrowDate + static_cast<std::time_t>(rng() % (period + 15)) * kDay + kDay / 2;
+        std::fprintf(recordFile.get(), "%s,%s,%lld,%lld,%lld,1\n", datasetBookTitle(bookSampler(rng)).c_str(),
+            datasetReaderName(reader).c_str(), static_cast<long long>(borrowDate), static_cast<long long>(dueDate),
+            static_cast<long long>(returnDate));
+    }
+    // 未还记录：借阅日期在最近 90 天内，约一半已超期
+    for (size_t book = 0; book < options.books; ++book) {
+        if (!open[book]) continue;
+        size_t reader = readerSampler(rng);
+        std::time_t borrowDate = now - static_cast<std::time_t>(rng() % (90 * kDay));
+        std::time_t dueDate = borrowDate + kBorrowPeriods[tierOf(reader)] * kDay;
+        std::fprintf(recordFile.get(), "%s,%s,%lld,%lld,0,0\n", datasetBookTitle(book).c_str(),
+            datasetReaderName(reader).c_str(), static_cast<long long>(borrowDate), static_cast<long long>(dueDate));
+    }
+    summary.bytes += finish(recordFile, recordPath);
+    summary.records = options.records;
+
+    std::string userPath = directory + "/users.txt";
+    File userFile = openOutput(userPath);
+    std::fprintf(userFile.get(), "Administrator,admin,admin123\n");
+    size_t users = std::min(options.users, options.readers);
+    for (size_t i = 0; i < users; ++i) {
+        std::fprintf(userFile.get(), "ReaderUser,user%zu,pass%zu,%s\n", i, i, datasetReaderName(i).c_str());
+    }
+    summary.bytes += finish(userFile, userPath);
+    summary.users = users;
+    return summary;
+}
\ No newline at end of file
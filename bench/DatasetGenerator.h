@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 合成数据集：按 Library::importText 的格式写出 books.txt / readers.txt / records.txt / users.txt。
+// 图书热度和读者活跃度服从 Zipf 分布（skew 越大越集中），借阅日期分布在最近两年内；
+// 每本图书至多一条未还记录，其余记录均已归还，与图书的借出状态一致。
+struct DatasetOptions {
+    size_t books = 100000;
+    size_t readers = 20000;
+    size_t records = 2000000;
+    size_t users = 10000;          // 绑定读者的账号数（另有一个 admin）
+    double skew = 1.0;             // Zipf 指数，0 为均匀分布
+    double openFraction = 0.05;    // 处于借出状态的图书比例
+    uint64_t seed = 20240601;
+};
+
+struct DatasetSummary {
+    size_t books = 0;
+    size_t readers = 0;
+    size_t records = 0;
+    size_t openLoans = 0;
+    size_t users = 0;
+    uint64_t bytes = 0;
+};
+
+// 在 directory 下生成数据集（覆盖同名文件），失败时抛出 std::runtime_error
+DatasetSummary generateDataset(const std::string& directory, const DatasetOptions& options);
+
+// 生成规则与 generateDataset 一致，供基准程序按编号构造书名 / 读者名
+std::string datasetBookTitle(size_t index);
+std::string datasetReaderName(size_t index);
\ No newline at end of file
@@ -0,0 +1,692 @@
+// Library 核心的基准程序与数据集生成器，由 CMake 目标 library_bench 构建（见 README.md）；
+// 配置时加 -DLIBRARY_AVX2=ON 则扫描内核走 AVX2 路径。
+// 用法：
+//   library_bench generate <目录> [--books N] [--readers N] [--records N] [--users N] [--skew S] [--seed N]
+//   library_bench run <目录> [--ops N] [--threads N] [--filter 子串] [--json 文件] [--label 标签]
+//   library_bench compare <基线.jsonl> <本次.jsonl> [--threshold 百分比]
+// run 在数据集目录中工作（会写出快照和日志），每项结果输出一行表格；指定 --json 时另写一行 JSON，
+// 字段为 name / ops / ns_per_op / ops_per_sec / allocs_per_op / bytes_per_op / max_rss_kb / label。
+// compare 按名称对比两次结果的 ns_per_op，任一项变慢超过阈值（默认 10%）时返回 1。
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+#include "DatasetGenerator.h"
+#include "CommandRunner.h"
+#include "FinePolicy.h"
+#include "Library.h"
+#include "MappedFile.h"
+#include "RecordStore.h"
+#include "TextParsing.h"
+
+// 分配计数：替换全局 operator new，统计次数和字节数
+namespace {
+    std::atomic<uint64_t> allocationCount{ 0 };
+    std::atomic<uint64_t> allocationBytes{ 0 };
+
+    void* countedAllocate(size_t size) {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        allocationBytes.fetch_add(size, std::memory_order_relaxed);
+        if (void* pointer = std::malloc(size ? size : 1)) return pointer;
+        throw std::bad_alloc();
+    }
+
+    void* countedAllocateAligned(size_t size, std::align_val_t alignment) {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        allocationBytes.fetch_add(size, std::memory_order_relaxed);
+        size_t align = static_cast<size_t>(alignment);
+        size_t rounded = (size + align - 1) / align * align;
+        if (void* pointer = std::aligned_alloc(align, rounded ? rounded : align)) return pointer;
+        throw std::bad_alloc();
+    }
+}
+
+void* operator new(size_t size) { return countedAllocate(size); }
+void* operator new[](size_t size) { return countedAllocate(size); }
+void* operator new(size_t size, std::align_val_t alignment) { return countedAllocateAligned(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment) { return countedAllocateAligned(size, alignment); }
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept { std::free(pointer); }
+
+namespace {
+    using SteadyClock = std::chrono::steady_clock;
+
+    struct BenchResult {
+        std::string name;
+        uint64_t ops = 0;
+        double seconds = 0.0;
+        uint64_t allocations = 0;
+        uint64_t bytes = 0;
+        long maxRssKb = 0;
+
+        double nsPerOp() const { return ops ? seconds * 1e9 / ops : 0.0; }
+        double opsPerSecond() const { return seconds > 0 ? ops / seconds : 0.0; }
+    };
+
+    long maxRssKb() {
+#if defined(__unix__) || defined(__APPLE__)
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+        return usage.ru_maxrss / 1024;
+#else
+        return usage.ru_maxrss;
+#endif
+#else
+        return 0;
+#endif
+    }
+
+    // 防止被测结果被优化掉
+    template <typename T>
+    void keep(const T& value) {
+        asm volatile("" : : "g"(&value) : "memory");
+    }
+
+    class BenchSession {
+    public:
+        BenchSession(std::string filter, std::string jsonPath, std::string label)
+            : filter(std::move(filter)), label(std::move(label)) {
+            if (!jsonPath.empty()) {
+                json.open(jsonPath);
+                if (!json) throw std::runtime_error("无法写入结果文件: " + jsonPath);
+                json.precision(12);
+            }
+            std::printf("%-36s %12s %14s %14s %12s %12s %10s\n", "name", "ops", "ns/op", "ops/s", "allocs/op", "bytes/op", "rss(MB)");
+        }
+
+        bool enabled(const std::string& name) const { return filter.empty() || name.find(filter) != std::string::npos; }
+
+        // body 内执行 ops 次操作；计时和分配计数覆盖整个 body
+        void measure(const std::string& name, uint64_t ops, const std::function<void()>& body) {
+            if (!enabled(name)) return;
+            BenchResult result;
+            result.name = name;
+            result.ops = ops;
+            uint64_t allocationsBefore = allocationCount.load();
+            uint64_t bytesBefore = allocationBytes.load();
+            auto start = SteadyClock::now();
+            body();
+            result.seconds = std::chrono::duration<double>(SteadyClock::now() - start).count();
+            result.allocations = allocationCount.load() - allocationsBefore;
+            result.bytes = allocationBytes.load() - bytesBefore;
+            result.maxRssKb = maxRssKb();
+            report(result);
+        }
+
+    private:
+        void report(const BenchResult& result) {
+            double allocsPerOp = result.ops ? static_cast<double>(result.allocations) / result.ops : 0.0;
+            double bytesPerOp = result.ops ? static_cast<double>(result.bytes) / result.ops : 0.0;
+            std::printf("%-36s %12llu %14.1f %14.0f %12.2f %12.1f %10.1f\n", result.name.c_str(),
+                static_cast<unsigned long long>(result.ops), result.nsPerOp(), result.opsPerSecond(), allocsPerOp, bytesPerOp,
+                result.maxRssKb / 1024.0);
+            std::fflush(stdout);
+            if (json.is_open()) {
+                json << "{\"name\":\"" << result.name << "\",\"ops\":" << result.ops << ",\"ns_per_op\":" << result.nsPerOp()
+                    << ",\"ops_per_sec\":" << result.opsPerSecond() << ",\"allocs_per_op\":" << allocsPerOp
+                    << ",\"bytes_per_op\":" << bytesPerOp << ",\"max_rss_kb\":" << result.maxRssKb
+                    << ",\"label\":\"" << label << "\"}\n";
+                json.flush();
+            }
+        }
+
+        std::string filter;
+        std::string label;
+        std::ofstream json;
+    };
+
+    // 菜单类显示函数的输出重定向到空设备
+    class SilenceStdout {
+    public:
+        SilenceStdout() : saved(std::cout.rdbuf(nullptr)) {}
+        ~SilenceStdout() {
+            std::cout.rdbuf(saved);
+            std::cout.clear();
+        }
+
+    private:
+        std::streambuf* saved;
+    };
+
+    size_t countLines(const std::string& path) {
+        MappedFile file(path);
+        if (!file.isOpen()) throw std::runtime_error("缺少数据集文件: " + path);
+        return std::count(file.begin(), file.begin() + file.size(), '\n');
+    }
+
+    struct RunOptions {
+        uint64_t ops = 200000;
+        size_t threads = std::max(1u, std::thread::hardware_concurrency());
+        std::string filter;
+        std::string jsonPath;
+        std::string label;
+    };
+
+    // 罚款计算：逐条查表与批量内核
+    void benchFines(BenchSession& session, uint64_t ops) {
+        size_t count = 1 << 20;
+        std::mt19937_64 rng(1);
+        std::vector<int32_t> days(count);
+        std::vector<BookCategory> categories(count);
+        std::vector<MemberTier> tiers(count);
+        std::vector<double> fines(count);
+        for (size_t i = 0; i < count; ++i) {
+            days[i] = static_cast<int32_t>(rng() % 60) - 20;
+            categories[i] = static_cast<BookCategory>(rng() % static_cast<size_t>(BookCategory::Count));
+            tiers[i] = static_cast<MemberTier>(rng() % static_cast<size_t>(MemberTier::Count));
+        }
+        size_t passes = std::max<uint64_t>(1, ops * 20 / count);
+        session.measure("fine_per_record", passes * count, [&] {
+            for (size_t pass = 0; pass < passes; ++pass) {
+                for (size_t i = 0; i < count; ++i) fines[i] = FinePolicy::fine(days[i], categories[i], tiers[i]);
+                keep(fines);
+            }
+        });
+        session.measure("fine_batch_kernel", passes * count, [&] {
+            for (size_t pass = 0; pass < passes; ++pass) {
+                FinePolicy::computeFines(count, days.data(), categories.data(), tiers.data(), fines.data());
+                keep(fines);
+            }
+        });
+    }
+
+    // 列式记录表的扫描内核，与逐条组装记录视图的扫描对比
+    void benchRecordScans(BenchSession& session, size_t recordCount) {
+        std::vector<std::unique_ptr<Book>> books;
+        std::vector<std::unique_ptr<Reader>> readers;
+        for (size_t category = 0; category < static_cast<size_t>(BookCategory::Count); ++category) {
+            books.push_back(std::make_unique<Book>("扫描样本" + std::to_string(category), "作者", "普通图书",
+                static_cast<BookCategory>(category)));
+        }
+        readers.push_back(std::make_unique<RegularMember>("扫描读者0"));
+        readers.push_back(std::make_unique<VIPMember>("扫描读者1"));
+        readers.push_back(std::make_unique<StudentMember>("扫描读者2"));
+
+        RecordStore store;
+        store.reserve(recordCount);
+        std::mt19937_64 rng(2);
+        std::time_t now = DateUtils::getCurrentTime();
+        for (size_t i = 0; i < recordCount; ++i) {
+            std::time_t borrowDate = now - static_cast<std::time_t>(rng() % (400 * 24 * 60 * 60));
+            size_t pos = store.append(books[rng() % books.size()].get(), 0, readers[rng() % readers.size()].get(), borrowDate,
+                borrowDate + 30 * 24 * 60 * 60);
+            if (rng() % 10 != 0) store.markReturned(pos, borrowDate + 10 * 24 * 60 * 60);
+        }
+        session.measure("scan_overdue_rowwise", recordCount, [&] {
+            size_t overdue = 0;
+            double total = 0.0;
+            for (const BorrowRecord record : store) {
+                if (record.getIsReturned()) continue;
+                int days = record.getOverdueDays(now);
+                if (days > 0) {
+                    ++overdue;
+                    total += record.calculateFine(now);
+                }
+            }
+            keep(overdue);
+            keep(total);
+        });
+        session.measure("scan_count_overdue_kernel", recordCount, [&] { keep(store.countOverdue(now)); });
+        session.measure("scan_overdue_fine_kernel", recordCount, [&] { keep(store.overdueFineTotal(now)); });
+        session.measure("scan_due_between_kernel", recordCount, [&] {
+            keep(store.countDueBetween(now, now + 3 * 24 * 60 * 60));
+        });
+    }
+
+    // 多个柜台线程各自在互不重叠的图书 / 读者上借还
+    void benchConcurrency(BenchSession& session, Library& library, const std::vector<std::string>& freeTitles,
+        const std::vector<std::string>& readerNames, uint64_t ops, size_t maxThreads) {
+        // 线程数取 1, 2, 4, ... 直到 maxThreads
+        std::vector<size_t> threadCounts;
+        for (size_t threads = 1; threads < maxThreads; threads *= 2) threadCounts.push_back(threads);
+        threadCounts.push_back(maxThreads);
+        for (size_t threads : threadCounts) {
+            std::string name = "concurrent_borrow_return/t" + std::to_string(threads);
+            uint64_t perThread = std::max<uint64_t>(1, ops / 4 / threads);
+            session.measure(name, perThread * threads * 2, [&] {
+                std::vector<std::thread> workers;
+                for (size_t t = 0; t < threads; ++t) {
+                    workers.emplace_back([&, t] {
+                        size_t bookSlice = freeTitles.size() / threads;
+                        size_t readerSlice = readerNames.size() / threads;
+                        for (uint64_t i = 0; i < perThread; ++i) {
+                            const std::string& title = freeTitles[t * bookSlice + i % bookSlice];
+                            const std::string& reader = readerNames[t * readerSlice + i % readerSlice];
+                            library.borrowBook(title, reader);
+                            library.returnBook(title, reader);
+                        }
+                    });
+                }
+                for (auto& worker : workers) worker.join();
+            });
+        }
+    }
+
+    // 模拟时钟推进一年：每天借出一批图书，并归还 40 天前借出的那批（普通会员已超期），
+    // 超期和罚款都按模拟时间计算，结果与运行当天的日期无关
+    void benchSimulatedYear(BenchSession& session, Library& library, const std::vector<std::string>& freeTitles,
+        const std::vector<std::string>& readerNames, uint64_t ops) {
+        constexpr int kDays = 365;
+        constexpr int kLoanDays = 40;
+        size_t perDay = std::min<size_t>(freeTitles.size() / (kLoanDays + 1), std::max<uint64_t>(1, ops / kDays / 2));
+        if (perDay == 0) return;
+        FakeClock clock(DateUtils::getCurrentTime());
+        DateUtils::setClock(&clock);
+        auto slot = [&](int day, size_t k) { return static_cast<size_t>(day % (kLoanDays + 1)) * perDay + k; };
+        session.measure("simulated_year", static_cast<uint64_t>(perDay) * kDays * 2, [&] {
+            for (int day = 0; day < kDays + kLoanDays; ++day) {
+                for (size_t k = 0; k < perDay; ++k) {
+                    if (day >= kLoanDays) {
+                        size_t index = slot(day - kLoanDays, k);
+                        library.returnBook(freeTitles[index], readerNames[index % readerNames.size()]);
+                    }
+                    if (day < kDays) {
+                        size_t index = slot(day, k);
+                        library.borrowBook(freeTitles[index], readerNames[index % readerNames.size()]);
+                    }
+                }
+                clock.advanceDays(1);
+            }
+        });
+        DateUtils::setClock(nullptr);
+    }
+
+    // 日期格式化：写入调用方缓冲区，日期集中在最近两年
+    void benchFormatTime(BenchSession& session, uint64_t ops) {
+        std::vector<std::time_t> times(4096);
+        std::mt19937_64 rng(4);
+        std::time_t now = DateUtils::getCurrentTime();
+        for (std::time_t& time : times) time = now - static_cast<std::time_t>(rng() % (730 * DateUtils::kSecondsPerDay));
+        session.measure("format_time", ops, [&] {
+            char text[DateUtils::kTimeTextSize];
+            size_t total = 0;
+            for (uint64_t i = 0; i < ops; ++i) total += DateUtils::formatTime(times[i % times.size()], text, sizeof(text));
+            keep(total);
+        });
+    }
+
+    // 多册图书的内存：同一批书名分别按 "每册一个 Book 对象" 和 "每个书名一个条目 + 副本位图" 建立，
+    // ops 为书名数，bytes/op 即每个书名占用的堆内存（书名已预先驻留，不计入）。
+    // 之后在一个 4096 册的书名上轮流借出 / 归还，测位图找在架副本的开销。
+    void benchCopyInventory(BenchSession& session, uint64_t ops) {
+        const std::string author = "某作者";
+        auto buildTitles = [&](size_t count, uint32_t copies) {
+            std::vector<std::string> titles;
+            for (size_t i = 0; i < count; ++i) titles.push_back("多册教材（" + std::to_string(copies) + " 册）第" + std::to_string(i) + "种");
+            for (const std::string& title : titles) keep(Symbol(title));
+            return titles;
+        };
+        for (uint32_t copies : { 40u, 1000u }) {
+            size_t titleCount = std::max<uint64_t>(1, ops / copies);
+            std::vector<std::string> titles = buildTitles(titleCount, copies);
+            std::vector<std::unique_ptr<Book>> objects;
+            objects.reserve(titleCount * copies);
+            session.measure("copies_x" + std::to_string(copies) + "_object_per_copy", titleCount, [&] {
+                for (const std::string& title : titles) {
+                    for (uint32_t i = 0; i < copies; ++i) objects.push_back(std::make_unique<Textbook>(title, author));
+                }
+            });
+            objects.clear();
+            objects.reserve(titleCount);
+            session.measure("copies_x" + std::to_string(copies) + "_bitmap_per_title", titleCount, [&] {
+                for (const std::string& title : titles) {
+                    objects.push_back(std::make_unique<Textbook>(title, author));
+                    objects.back()->addCopies(copies - 1);
+                }
+            });
+        }
+
+        // 一半副本始终在外，每次借出编号最小的在架副本并归还最早借出的一本
+        Textbook book("多册教材（借还）", author);
+        book.addCopies(CopySet::kMaxCopies - 1);
+        std::vector<uint32_t> held(CopySet::kMaxCopies / 2);
+        for (uint32_t& copy : held) copy = book.borrowCopy();
+        session.measure("copy_checkout_return", ops, [&] {
+            for (uint64_t i = 0; i < ops; ++i) {
+                uint32_t& slot = held[i % held.size()];
+                book.returnCopy(slot);
+                slot = book.borrowCopy();
+            }
+        });
+        keep(held);
+    }
+
+    // 预约队列：队列长 10 和 10000 时每次 "副本交给队首 + 取书 + 该读者重新排队" 的开销应相同（按等级分的链表，O(1)），
+    // 对照组把预约放在一个数组里，每次线性扫描找等级最高、最早的一条。最后测取书期限在时间轮上的登记和到期
+    void benchHolds(BenchSession& session, uint64_t ops) {
+        Textbook book("预约测试教材", "某作者");
+        std::vector<std::unique_ptr<Reader>> readers;
+        for (size_t i = 0; i < 10000; ++i) {
+            std::string name = "预约读者" + std::to_string(i);
+            switch (i % 3) {
+                case 0: readers.push_back(std::make_unique<RegularMember>(name)); break;
+                case 1: readers.push_back(std::make_unique<StudentMember>(name)); break;
+                default: readers.push_back(std::make_unique<VIPMember>(name)); break;
+            }
+        }
+        std::time_t now = DateUtils::getCurrentTime();
+        std::time_t deadline = now + HoldQueue::kPickupDays * DateUtils::kSecondsPerDay;
+        for (size_t length : { size_t(10), readers.size() }) {
+            HoldQueue holds;
+            for (size_t i = 0; i < length; ++i) holds.place(&book, readers[i].get(), now);
+            session.measure("hold_handoff_q" + std::to_string(length), ops, [&] {
+                for (uint64_t i = 0; i < ops; ++i) {
+                    uint32_t id = holds.assign(&book, 0, deadline);
+                    Reader* reader = holds[id].reader;
+                    holds.remove(id);
+                    holds.place(&book, reader, now);
+                }
+            });
+
+            struct Waiting {
+                Reader* reader;
+                uint8_t rank;
+                uint64_t sequence;
+            };
+            std::vector<Waiting> waiting;
+            uint64_t sequence = 0;
+            for (size_t i = 0; i < length; ++i) waiting.push_back({ readers[i].get(), HoldQueue::rankOf(readers[i].get()), sequence++ });
+            uint64_t scanOps = std::max<uint64_t>(1, std::min<uint64_t>(ops, 10000000 / length));
+            session.measure("hold_handoff_scan_q" + std::to_string(length), scanOps, [&] {
+                for (uint64_t i = 0; i < scanOps; ++i) {
+                    auto first = std::min_element(waiting.begin(), waiting.end(), [](const Waiting& a, const Waiting& b) {
+                        return a.rank != b.rank ? a.rank < b.rank : a.sequence < b.sequence;
+                    });
+                    Reader* reader = first->reader;
+                    waiting.erase(first);
+                    waiting.push_back({ reader, HoldQueue::rankOf(reader), sequence++ });
+                }
+            });
+        }
+
+        // ops 条取书期限均匀分布在三天内，逐小时推进直到全部到期
+        std::mt19937_64 rng(5);
+        TimingWheel wheel;
+        std::vector<uint32_t> expired;
+        expired.reserve(ops);
+        session.measure("hold_deadline_wheel", ops, [&] {
+            for (uint64_t i = 0; i < ops; ++i) {
+                wheel.schedule(static_cast<uint32_t>(i), now + static_cast<std::time_t>(rng() % (HoldQueue::kPickupDays * DateUtils::kSecondsPerDay)));
+            }
+            for (std::time_t time = now; wheel.size() > 0; time += 60 * 60) wheel.advance(time, expired);
+        });
+        keep(expired.size());
+    }
+
+    void runBenchmarks(const std::string& directory, const RunOptions& options) {
+        std::filesystem::current_path(directory);
+        size_t bookCount = countLines("books.txt");
+        size_t readerCount = countLines("readers.txt");
+        std::printf("数据集 %s: %zu 本图书, %zu 位读者, %zu 条借阅记录\n", directory.c_str(), bookCount, readerCount,
+            countLines("records.txt"));
+        BenchSession session(options.filter, options.jsonPath, options.label);
+
+        // 冷启动：第一次从文本导入并写出快照，第二次从快照加载
+        std::filesystem::remove("library.snap");
+        std::filesystem::remove("library.journal");
+        std::filesystem::remove("library.history");
+        std::unique_ptr<Library> library;
+        session.measure("load_text", 1, [&] { library = std::make_unique<Library>(); });
+        library.reset();
+        session.measure("load_snapshot", 1, [&] { library = std::make_unique<Library>(); });
+        if (!library) library = std::make_unique<Library>();
+        // 数据集中的读者借阅量偏斜，借还基准只测吞吐，不受按会员等级的在借上限限制
+        FineTable fineTable = FinePolicy::table();
+        for (int& limit : fineTable.loanLimit) limit = 0;
+        FinePolicy::configure(fineTable);
+
+        std::mt19937_64 rng(3);
+        size_t sampleSize = std::min<size_t>(100000, bookCount);
+        std::vector<std::string> titles;
+        std::vector<std::string> readerNames;
+        for (size_t i = 0; i < sampleSize; ++i) titles.push_back(datasetBookTitle(rng() % bookCount));
+        for (size_t i = 0; i < std::min<size_t>(100000, readerCount); ++i) readerNames.push_back(datasetReaderName(rng() % readerCount));
+
+        session.measure("find_book", options.ops, [&] {
+            for (uint64_t i = 0; i < options.ops; ++i) keep(library->findBook(titles[i % titles.size()]));
+        });
+        std::vector<std::string> missing;
+        for (size_t i = 0; i < std::min<size_t>(titles.size(), 10000); ++i) missing.push_back(titles[i] + "（缺）");
+        session.measure("find_book_miss", options.ops, [&] {
+            for (uint64_t i = 0; i < options.ops; ++i) keep(library->findBook(missing[i % missing.size()]));
+        });
+        session.measure("find_reader", options.ops, [&] {
+            for (uint64_t i = 0; i < options.ops; ++i) keep(library->findReader(readerNames[i % readerNames.size()]));
+        });
+
+        // 借阅 / 归还：只用当前未借出的图书，同一批图书先全部借出再全部归还
+        std::vector<std::string> freeTitles;
+        for (size_t i = 0; i < bookCount && freeTitles.size() < 200000; ++i) {
+            std::string title = datasetBookTitle(i);
+            Book* book = library->findBook(title);
+            if (book && !book->isBorrowedStatus()) freeTitles.push_back(std::move(title));
+        }
+        uint64_t loans = std::min<uint64_t>(options.ops / 2, freeTitles.size());
+        session.measure("borrow_book", loans, [&] {
+            for (uint64_t i = 0; i < loans; ++i) library->borrowBook(freeTitles[i], readerNames[i % readerNames.size()]);
+        });
+        session.measure("return_book", loans, [&] {
+            for (uint64_t i = 0; i < loans; ++i) library->returnBook(freeTitles[i], readerNames[i % readerNames.size()]);
+        });
+
+        {
+            SilenceStdout silence;
+            uint64_t searches = std::max<uint64_t>(1, options.ops / 100);
+            session.measure("search_reader", searches, [&] {
+                for (uint64_t i = 0; i < searches; ++i) library->searchReader(readerNames[i % readerNames.size()]);
+            });
+            session.measure("display_overdue_books", 3, [&] {
+                for (int i = 0; i < 3; ++i) library->displayOverdueBooks();
+            });
+        }
+        std::time_t now = DateUtils::getCurrentTime();
+        session.measure("overdue_report", 10, [&] {
+            for (int i = 0; i < 10; ++i) keep(library->overdueReport(now).fineTotal);
+        });
+        session.measure("due_soon_report", 10, [&] {
+            for (int i = 0; i < 10; ++i) keep(library->dueSoonReport(3, now).count);
+        });
+        // 罚款预估批处理：ops 为每轮处理的未还借阅数
+        size_t openLoans = library->metricsGauges().openLoans;
+        session.measure("fine_accrual", std::max<size_t>(1, openLoans) * 10, [&] {
+            for (int i = 0; i < 10; ++i) keep(library->accrueFines(now, options.threads).total.fine);
+        });
+
+        const char* const queries[] = { "数据结构", "Linux", "深入理解", "心理学 历史", "第12345卷", "Compiler 设计", "Modern*" };
+        uint64_t searchOps = std::max<uint64_t>(1, options.ops / 200);
+        session.measure("search_books", searchOps, [&] {
+            for (uint64_t i = 0; i < searchOps; ++i) {
+                std::string_view query = queries[i % std::size(queries)];
+                SearchMode mode = parseSearchQuery(query);
+                keep(library->searchBooks(query, mode).size());
+            }
+        });
+        // 拼写错误：把名称末尾的编号数字改掉一位
+        std::vector<std::string> typos;
+        for (size_t i = 0; i < std::min<size_t>(readerNames.size(), 1000); ++i) {
+            std::string name = readerNames[i];
+            name.back() = name.back() == '9' ? '0' : name.back() + 1;
+            name.insert(name.size() - 1, "x");
+            typos.push_back(std::move(name));
+        }
+        session.measure("suggest_readers", searchOps, [&] {
+            for (uint64_t i = 0; i < searchOps; ++i) keep(library->suggestReaders(typos[i % typos.size()]).size());
+        });
+        session.measure("suggest_books", searchOps, [&] {
+            for (uint64_t i = 0; i < searchOps; ++i) keep(library->suggestBooks(missing[i % missing.size()]).size());
+        });
+
+        // 批量命令执行器
+        std::string commands;
+        uint64_t batchLoans = std::min<uint64_t>(options.ops / 4, freeTitles.size());
+        for (uint64_t i = 0; i < batchLoans; ++i) {
+            const std::string& reader = readerNames[i % readerNames.size()];
+            commands += "borrow," + freeTitles[i] + "," + reader + "\nreturn," + freeTitles[i] + "," + reader + "\n";
+        }
+        session.measure("batch_runner", batchLoans * 2, [&] { keep(CommandRunner(*library).run(commands).failed); });
+
+        if (freeTitles.size() >= options.threads && readerNames.size() >= options.threads) {
+            benchConcurrency(session, *library, freeTitles, readerNames, options.ops, options.threads);
+        }
+        benchSimulatedYear(session, *library, freeTitles, readerNames, options.ops);
+        session.measure("save_snapshot", 3, [&] {
+            for (int i = 0; i < 3; ++i) library->saveData();
+        });
+        // 批量导入：ops 行新书名，每 10 行混入一本目录中已有的书，计时含解析、去重、插入、重建索引和写快照
+        if (session.enabled("bulk_import_books")) {
+            const char* const importFile = "bulk_import.csv";
+            {
+                std::ofstream out(importFile);
+                const char* const types[] = { "教科书", "小说", "杂志", "普通图书" };
+                for (uint64_t i = 0; i < options.ops; ++i) {
+                    if (i % 10 == 9) {
+                        out << types[i % 4] << ',' << titles[i % titles.size()] << ",某作者\n";
+                    } else {
+                        out << types[i % 4] << ",批量导入图书 第" << i << "卷,作者" << i % 997 << '\n';
+                    }
+                }
+            }
+            session.measure("bulk_import_books", options.ops, [&] {
+                keep(library->bulkImport(ImportTarget::Books, importFile).imported);
+            });
+            std::filesystem::remove(importFile);
+        }
+        library.reset();
+
+        benchFines(session, options.ops);
+        benchFormatTime(session, options.ops);
+        benchCopyInventory(session, options.ops);
+        benchHolds(session, options.ops);
+        benchRecordScans(session, countLines("records.txt"));
+    }
+
+    // 从 JSON 行中取出字符串 / 数值字段（只处理本程序写出的格式）
+    std::string jsonField(const std::string& line, const std::string& key) {
+        std::string pattern = "\"" + key + "\":";
+        size_t start = line.find(pattern);
+        if (start == std::string::npos) return {};
+        start += pattern.size();
+        if (line[start] == '"') {
+            size_t end = line.find('"', start + 1);
+            return line.substr(start + 1, end - start - 1);
+        }
+        size_t end = line.find_first_of(",}", start);
+        return line.substr(start, end - start);
+    }
+
+    std::map<std::string, double> loadResults(const std::string& path) {
+        std::ifstream in(path);
+        if (!in) throw std::runtime_error("无法读取结果文件: " + path);
+        std::map<std::string, double> results;
+        std::string line;
+        while (std::getline(in, line)) {
+            std::string name = jsonField(line, "name");
+            if (!name.empty()) results[name] = std::atof(jsonField(line, "ns_per_op").c_str());
+        }
+        return results;
+    }
+
+    int compareResults(const std::string& basePath, const std::string& currentPath, double threshold) {
+        auto base = loadResults(basePath);
+        auto current = loadResults(currentPath);
+        int regressions = 0;
+        std::printf("%-36s %14s %14s %9s\n", "name", "base ns/op", "ns/op", "change");
+        for (const auto& [name, nsPerOp] : current) {
+            auto it = base.find(name);
+            if (it == base.end() || it->second <= 0) {
+                std::printf("%-36s %14s %14.1f %9s\n", name.c_str(), "-", nsPerOp, "new");
+                continue;
+            }
+            double change = (nsPerOp - it->second) / it->second * 100.0;
+            bool regressed = change > threshold;
+            regressions += regressed;
+            std::printf("%-36s %14.1f %14.1f %+8.1f%%%s\n", name.c_str(), it->second, nsPerOp, change, regressed ? "  <-- 变慢" : "");
+        }
+        return regressions == 0 ? 0 : 1;
+    }
+
+    int usage() {
+        std::cerr << "用法: library_bench generate <目录> [--books N] [--readers N] [--records N] [--users N] [--skew S] [--seed N]\n"
+                  << "      library_bench run <目录> [--ops N] [--threads N] [--filter 子串] [--json 文件] [--label 标签]\n"
+                  << "      library_bench compare <基线.jsonl> <本次.jsonl> [--threshold 百分比]\n";
+        return 2;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) return usage();
+    std::string command = argv[1];
+    std::vector<std::string> args(argv + 2, argv + argc);
+    auto option = [&](const std::string& name) -> const std::string* {
+        for (size_t i = 0; i + 1 < args.size(); ++i) {
+            if (args[i] == name) return &args[i + 1];
+        }
+        return nullptr;
+    };
+    auto number = [&](const std::string& name, auto fallback) {
+        const std::string* value = option(name);
+        if (!value) return fallback;
+        decltype(fallback) parsed{};
+        if (!textparse::parseNumber(*value, parsed)) throw std::runtime_error("无效的参数值: " + name + " " + *value);
+        return parsed;
+    };
+    try {
+        if (command == "generate") {
+            DatasetOptions options;
+            options.books = number("--books", options.books);
+            options.readers = number("--readers", options.readers);
+            options.records = number("--records", options.records);
+            options.users = number("--users", options.users);
+            options.skew = number("--skew", options.skew);
+            options.seed = number("--seed", options.seed);
+            std::filesystem::create_directories(args[0]);
+            auto start = SteadyClock::now();
+            DatasetSummary summary = generateDataset(args[0], options);
+            double seconds = std::chrono::duration<double>(SteadyClock::now() - start).count();
+            std::printf("已生成 %zu 本图书（%zu 本借出）、%zu 位读者、%zu 条借阅记录、%zu 个读者账号，共 %.1f MB，耗时 %.1f 秒\n",
+                summary.books, summary.openLoans, summary.readers, summary.records, summary.users, summary.bytes / 1048576.0, seconds);
+            return 0;
+        }
+        if (command == "run") {
+            RunOptions options;
+            options.ops = number("--ops", options.ops);
+            options.threads = number("--threads", options.threads);
+            if (const std::string* value = option("--filter")) options.filter = *value;
+            if (const std::string* value = option("--json")) options.jsonPath = std::filesystem::absolute(*value).string();
+            if (const std::string* value = option("--label")) options.label = *value;
+            if (options.ops == 0 || options.threads == 0) return usage();
+            runBenchmarks(args[0], options);
+            return 0;
+        }
+        if (command == "compare" && args.size() >= 2) {
+            return compareResults(args[0], args[1], number("--threshold", 10.0));
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << "\033[1;31m[错误] " << ex.what() << "\033[0m\n";
+        return 1;
+    }
+    return usage();
+}
\ No newline at end of file
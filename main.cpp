@@ -1,7 +1,74 @@
 #include "Library.h"
+#include "CommandRunner.h"
+#include "Server.h"
+#include <iostream>
+#include <string>
+#include <thread>
 
-int main() {
+// 用法：library                  交互菜单
+//       library --batch <文件>    批量执行命令文件，文件为 - 时读取标准输入
+//       library --serve [地址]    服务器模式，地址为 Unix 套接字路径（默认 library.sock）或 tcp:<端口>
+//       library --import-books <文件> / --import-readers <文件>
+//                                 从 CSV / TSV 批量导入图书或读者（格式见 BulkImport.h），输出导入报告
+// 各模式下运行指标每分钟写入 metrics.txt，退出时再写一次；服务器模式启动时在后台生成罚款预估报表 fine_report.txt
+int main(int argc, char* argv[]) {
+    bool serve = argc >= 2 && std::string(argv[1]) == "--serve";
+    // 服务器模式下先屏蔽退出信号再创建线程（指标输出、罚款预估等），信号只由服务的 signalfd 接收
+    if (serve) LibraryServer::blockShutdownSignals();
     Library library;
+    library.startMetricsDump("metrics.txt", std::chrono::seconds(60));
+    if (serve) {
+        ServerOptions options;
+        if (argc >= 3) options.endpoint = argv[2];
+        // 批处理与请求处理并行，不阻塞服务启动；该线程及其线程池在屏蔽退出信号之后创建，信号不会落到它们上面
+        std::thread accrual([&library] {
+            try {
+                FineAccrualReport report = library.runFineAccrualJob();
+                std::cout << "罚款预估: " << report.total.loans << " 笔未还借阅, 预估罚款 " << report.total.fine << " 元, "
+                    << static_cast<long long>(report.loansPerSecond()) << " 笔/秒\n";
+            } catch (const std::exception& ex) {
+                std::cerr << "\033[1;31m[错误] " << ex.what() << "\033[0m\n";
+            }
+        });
+        int status = 0;
+        try {
+            LibraryServer server(library, options);
+            server.run();
+        } catch (const std::exception& ex) {
+            std::cerr << "\033[1;31m[错误] " << ex.what() << "\033[0m\n";
+            status = 1;
+        }
+        accrual.join();
+        return status;
+    }
+    if (argc >= 3 && (std::string(argv[1]) == "--import-books" || std::string(argv[1]) == "--import-readers")) {
+        ImportTarget target = std::string(argv[1]) == "--import-books" ? ImportTarget::Books : ImportTarget::Readers;
+        try {
+            ImportReport report = library.bulkImport(target, argv[2]);
+            writeImportReport(std::cout, report);
+            return report.rejected == 0 ? 0 : 1;
+        } catch (const std::exception& ex) {
+            std::cerr << "\033[1;31m[错误] " << ex.what() << "\033[0m\n";
+            return 1;
+        }
+    }
+    if (argc >= 3 && std::string(argv[1]) == "--batch") {
+        std::string path = argv[2];
+        CommandRunner runner(library);
+        BatchReport report;
+        try {
+            report = path == "-" ? runner.runStream(std::cin) : runner.runFile(path);
+        } catch (const std::exception& ex) {
+            std::cerr << "\033[1;31m[错误] " << ex.what() << "\033[0m\n";
+            return 1;
+        }
+        for (const auto& error : report.errors) {
+            std::cerr << "\033[1;31m[错误] " << error << "\033[0m\n";
+        }
+        std::cout << "执行 " << report.executed << " 条命令，失败 " << report.failed << " 条，耗时 "
+            << report.seconds << " 秒，" << static_cast<long long>(report.opsPerSecond()) << " 条/秒\n";
+        return report.failed == 0 ? 0 : 1;
+    }
     library.mainMenu();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,187 @@
+// 多个柜台线程同时借还、支付和查询，检查结束后的在架状态、欠款和重新加载后的数据一致；
+// 罚款预估批处理与柜台借还同时运行时，每次的汇总自洽，柜台停下后与超期报表相同。
+// 数据竞争由 ThreadSanitizer 发现：cmake -DLIBRARY_SANITIZE=thread 构建后运行 ctest（见 README.md）
+#include "Library.h"
+#include "TestSupport.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+namespace {
+    constexpr int kDesks = 4;
+    constexpr int kBooksPerDesk = 15;  // VIP 会员的借阅上限以内
+    constexpr int kRounds = 25;
+    constexpr double kSharedFine = 1000.0;
+
+    std::string deskBook(int desk, int book) { return "书" + std::to_string(desk) + "_" + std::to_string(book); }
+    std::string deskReader(int desk) { return "柜台读者" + std::to_string(desk); }
+
+    JournalOptions timerJournal() {
+        JournalOptions options;
+        options.policy = FsyncPolicy::Timer;
+        options.interval = std::chrono::milliseconds(5);
+        return options;
+    }
+
+    // 每个柜台有自己的读者和图书；另有一本所有柜台争抢的单册图书和一位共同支付欠款的读者
+    void populate(Library& library) {
+        for (int desk = 0; desk < kDesks; ++desk) {
+            library.addReader(library.makeReader<VIPMember>(deskReader(desk)));
+            for (int book = 0; book < kBooksPerDesk; ++book) library.addBook(library.makeBook<Novel>(deskBook(desk, book), "作者"));
+        }
+        library.addBook(library.makeBook<Textbook>("争抢的书", "作者"));
+        Reader* shared = library.makeReader<RegularMember>("共同读者");
+        shared->addFine(kSharedFine);
+        library.addReader(shared);
+    }
+
+    // 测试期间安装模拟时钟，结束（包括断言抛出异常）时恢复系统时钟
+    struct ClockGuard {
+        explicit ClockGuard(const Clock* clock) { DateUtils::setClock(clock); }
+        ~ClockGuard() { DateUtils::setClock(nullptr); }
+    };
+
+    bool nearlyEqual(double a, double b) { return std::fabs(a - b) <= 1e-6 * std::max(1.0, std::fabs(b)); }
+
+    // 汇总自洽：按类别和按读者的合计都等于总计（按读者只含有超期借阅的读者）
+    void checkConsistent(const FineAccrualReport& report) {
+        size_t loans = 0;
+        double categoryFine = 0.0;
+        for (const FineExposure& category : report.byCategory) {
+            loans += category.loans;
+            categoryFine += category.fine;
+        }
+        CHECK_EQ(loans, report.total.loans);
+        CHECK(nearlyEqual(categoryFine, report.total.fine));
+        double readerFine = 0.0;
+        size_t overdue = 0;
+        for (const auto& [reader, exposure] : report.byReader) {
+            readerFine += exposure.fine;
+            overdue += exposure.overdueLoans;
+        }
+        CHECK_EQ(overdue, report.total.overdueLoans);
+        CHECK(nearlyEqual(readerFine, report.total.fine));
+    }
+
+    uint64_t lifetimeLoans(Library& library) {
+        uint64_t loans = 0;
+        for (int desk = 0; desk < kDesks; ++desk) loans += library.readerAccount(deskReader(desk)).lifetimeLoans;
+        return loans;
+    }
+}
+
+int main() {
+    test::run("多个柜台同时借还、支付和查询", [] {
+        test::ScratchDir dir("concurrency_desks");
+        std::atomic<int> contended{ 0 };
+        {
+            Library library(1.0, timerJournal());
+            populate(library);
+            std::atomic<bool> stop{ false };
+            std::thread reporter([&] {
+                while (!stop.load()) {
+                    library.overdueReport(DateUtils::getCurrentTime());
+                    library.readerAccount("共同读者");
+                    library.searchBooks("书1");
+                    library.countBorrowedBooks();
+                }
+            });
+            std::vector<std::thread> desks;
+            for (int desk = 0; desk < kDesks; ++desk) {
+                desks.emplace_back([&, desk] {
+                    std::string reader = deskReader(desk);
+                    for (int round = 0; round < kRounds; ++round) {
+                        for (int book = 0; book < kBooksPerDesk; ++book) library.borrowBook(deskBook(desk, book), reader);
+                        for (int book = 0; book < kBooksPerDesk; ++book) library.returnBook(deskBook(desk, book), reader);
+                        try {
+                            library.borrowBook("争抢的书", reader);
+                            library.returnBook("争抢的书", reader);
+                            ++contended;
+                        } catch (const BookBorrowedException&) {
+                        }
+                        library.payFine("共同读者", 1.0);
+                    }
+                });
+            }
+            for (std::thread& desk : desks) desk.join();
+            stop = true;
+            reporter.join();
+
+            CHECK(contended.load() > 0);
+            CHECK_EQ(library.countBorrowedBooks(), 0);
+            CHECK_EQ(library.findBook("争抢的书")->getAvailableCopies(), 1u);
+            CHECK_EQ(library.findReader("共同读者")->getFine(), kSharedFine - kDesks * kRounds);
+            CHECK_EQ(lifetimeLoans(library), uint64_t(kDesks * kRounds * kBooksPerDesk + contended.load()));
+        }
+        // 各柜台交错写入的日志重放后状态相同
+        Library reloaded(1.0, timerJournal());
+        CHECK_EQ(reloaded.countBorrowedBooks(), 0);
+        CHECK_EQ(reloaded.countBooks(), kDesks * kBooksPerDesk + 1);
+        CHECK_EQ(reloaded.findReader("共同读者")->getFine(), kSharedFine - kDesks * kRounds);
+        CHECK_EQ(lifetimeLoans(reloaded), uint64_t(kDesks * kRounds * kBooksPerDesk + contended.load()));
+    });
+    test::run("罚款预估与柜台借还同时进行", [] {
+        test::ScratchDir dir("concurrency_accrual");
+        constexpr int kReaders = 40;
+        constexpr int kBooks = 320;  // 每位读者 8 本，普通会员上限以内
+        FakeClock clock(DateUtils::getCurrentTime() - 200 * 24 * 60 * 60);
+        ClockGuard guard(&clock);
+        Library library(1.0, timerJournal());
+        for (int i = 0; i < kReaders; ++i) {
+            std::string name = "读者" + std::to_string(i);
+            if (i % 2) library.addReader(library.makeReader<VIPMember>(name));
+            else library.addReader(library.makeReader<RegularMember>(name));
+        }
+        for (int i = 0; i < kBooks; ++i) {
+            std::string title = "书" + std::to_string(i);
+            if (i % 3 == 0) library.addBook(library.makeBook<Textbook>(title, "作者"));
+            else if (i % 3 == 1) library.addBook(library.makeBook<Magazine>(title, "作者"));
+            else library.addBook(library.makeBook<Novel>(title, "作者"));
+        }
+        // 借出时间分散在 80 天内，之后再过 40 天，应还日期有的已过、有的未到
+        for (int i = 0; i < kBooks; ++i) {
+            library.borrowBook("书" + std::to_string(i), "读者" + std::to_string(i % kReaders));
+            if (i % 4 == 3) clock.advanceDays(1);
+        }
+        clock.advanceDays(40);
+        std::time_t now = clock.now();
+
+        FineAccrualReport before = library.accrueFines(now, 3);
+        LoanReport overdue = library.overdueReport(now);
+        CHECK_EQ(before.total.loans, size_t(kBooks));
+        CHECK(before.total.overdueLoans > 0 && before.total.overdueLoans < size_t(kBooks));
+        CHECK_EQ(before.total.overdueLoans, overdue.count);
+        CHECK(nearlyEqual(before.total.fine, overdue.fineTotal));
+        checkConsistent(before);
+
+        // 两个柜台各自反复归还再借出一半的图书，任一时刻最多各有一本不在借
+        std::atomic<bool> stop{ false };
+        std::vector<std::thread> desks;
+        for (int desk = 0; desk < 2; ++desk) {
+            desks.emplace_back([&, desk] {
+                for (int i = desk; !stop.load(); i = (i + 2) % kBooks) {
+                    std::string title = "书" + std::to_string(i);
+                    std::string reader = "读者" + std::to_string(i % kReaders);
+                    library.returnBook(title, reader);
+                    library.borrowBook(title, reader);
+                }
+            });
+        }
+        for (int run = 0; run < 20; ++run) {
+            FineAccrualReport report = library.accrueFines(now, 3);
+            CHECK(report.total.loans + 2 >= size_t(kBooks) && report.total.loans <= size_t(kBooks));
+            checkConsistent(report);
+        }
+        stop = true;
+        for (std::thread& desk : desks) desk.join();
+
+        FineAccrualReport after = library.accrueFines(now, 3);
+        LoanReport overdueAfter = library.overdueReport(now);
+        CHECK_EQ(after.total.loans, size_t(kBooks));
+        CHECK_EQ(after.total.overdueLoans, overdueAfter.count);
+        CHECK(nearlyEqual(after.total.fine, overdueAfter.fineTotal));
+        checkConsistent(after);
+    });
+    return test::finish();
+}
\ No newline at end of file
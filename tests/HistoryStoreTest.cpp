@@ -0,0 +1,215 @@
+// 历史层文件：段的往返、按快照代号截断未提交的段、残缺尾部、清除标记，以及没有快照时改名保留
+#include "Exceptions.h"
+#include "HistoryStore.h"
+#include "TestSupport.h"
+#include <algorithm>
+#include <fstream>
+
+namespace {
+    constexpr std::time_t kStart = 1700000000;
+    constexpr std::time_t kDay = 24 * 60 * 60;
+
+    // 名称由调用方保存，HistoryRecord 只持有视图
+    struct Batch {
+        std::vector<std::string> names;
+        std::vector<HistoryRecord> records;
+    };
+
+    // readers 位读者轮流借 books 本书，共 count 条
+    Batch makeBatch(size_t count, size_t books, size_t readers, const std::string& prefix) {
+        Batch batch;
+        for (size_t i = 0; i < books; ++i) batch.names.push_back(prefix + "书" + std::to_string(i));
+        for (size_t i = 0; i < readers; ++i) batch.names.push_back(prefix + "读者" + std::to_string(i));
+        for (size_t i = 0; i < count; ++i) {
+            std::time_t borrowed = kStart + static_cast<std::time_t>(i) * 3600;
+            batch.records.push_back({ batch.names[i % books], batch.names[books + i % readers], borrowed, borrowed + 30 * kDay,
+                borrowed + static_cast<std::time_t>(i % 45) * kDay });
+        }
+        return batch;
+    }
+
+    size_t countOf(const HistoryStore& store, HistoryKey key, std::string_view name) {
+        return store.forEach(key, name, [](const HistoryRecord&) {});
+    }
+}
+
+int main() {
+    test::run("追加后按书名 / 读者读出，与写入的记录相同", [] {
+        test::ScratchDir dir("history_round_trip");
+        Batch batch = makeBatch(3000, 40, 25, "");
+        HistoryStore store;
+        store.open("library.history", 0);
+        store.append(batch.records, 1);
+        CHECK_EQ(store.recordCount(), batch.records.size());
+        CHECK(store.segmentCount() >= 3);
+        for (HistoryKey key : { HistoryKey::Book, HistoryKey::Reader }) {
+            std::string_view name = key == HistoryKey::Book ? batch.names[7] : batch.names[40 + 3];
+            std::vector<HistoryRecord> expected;
+            for (const HistoryRecord& record : batch.records) {
+                if ((key == HistoryKey::Book ? record.book : record.reader) == name) expected.push_back(record);
+            }
+            std::vector<std::tuple<std::time_t, std::time_t, std::time_t, std::string, std::string>> seen, wanted;
+            store.forEach(key, name, [&](const HistoryRecord& record) {
+                seen.emplace_back(record.borrowDate, record.dueDate, record.returnDate, std::string(record.book), std::string(record.reader));
+            });
+            for (const HistoryRecord& record : expected) {
+                wanted.emplace_back(record.borrowDate, record.dueDate, record.returnDate, std::string(record.book), std::string(record.reader));
+            }
+            std::sort(seen.begin(), seen.end());
+            std::sort(wanted.begin(), wanted.end());
+            CHECK(!wanted.empty() && seen == wanted);
+        }
+        CHECK_EQ(countOf(store, HistoryKey::Book, "不存在的书"), size_t(0));
+        CHECK_EQ(store.forEach([](const HistoryRecord&) {}), batch.records.size());
+    });
+
+    test::run("重新打开时截掉已提交快照下一代的段", [] {
+        test::ScratchDir dir("history_generation");
+        Batch first = makeBatch(500, 10, 5, "甲");
+        Batch second = makeBatch(300, 10, 5, "乙");
+        uint64_t committedSize = 0;
+        {
+            HistoryStore store;
+            store.open("library.history", 0);
+            store.append(first.records, 1);
+            committedSize = store.fileSize();
+            // 模拟"追加历史段 → 写快照"在写快照前崩溃：第 2 代的段没有对应的快照
+            store.append(second.records, 2);
+        }
+        HistoryStore store;
+        store.open("library.history", 1);
+        CHECK_EQ(store.recordCount(), first.records.size());
+        CHECK_EQ(store.fileSize(), committedSize);
+        CHECK_EQ(std::filesystem::file_size("library.history"), committedSize);
+        CHECK_EQ(countOf(store, HistoryKey::Reader, "乙读者0"), size_t(0));
+        CHECK_EQ(countOf(store, HistoryKey::Reader, "甲读者0"), size_t(100));
+    });
+
+    test::run("段的代号比快照晚两代以上时不修改文件", [] {
+        test::ScratchDir dir("history_mismatch");
+        {
+            HistoryStore store;
+            store.open("library.history", 0);
+            store.append(makeBatch(100, 5, 5, "").records, 1);
+            store.append(makeBatch(100, 5, 5, "").records, 2);
+            store.append(makeBatch(100, 5, 5, "").records, 3);
+        }
+        auto size = std::filesystem::file_size("library.history");
+        HistoryStore store;
+        CHECK_THROWS(DataFormatException, store.open("library.history", 1));
+        CHECK(!store.isOpen());
+        CHECK_EQ(std::filesystem::file_size("library.history"), size);
+        store.open("library.history", 3);
+        CHECK_EQ(store.recordCount(), size_t(300));
+    });
+
+    test::run("残缺的尾部在打开时截掉", [] {
+        test::ScratchDir dir("history_torn");
+        uint64_t size = 0;
+        {
+            HistoryStore store;
+            store.open("library.history", 0);
+            store.append(makeBatch(200, 5, 5, "").records, 1);
+            size = store.fileSize();
+            store.append(makeBatch(200, 5, 5, "").records, 1);
+        }
+        // 第二段只写了一部分
+        std::filesystem::resize_file("library.history", size + 30);
+        HistoryStore store;
+        store.open("library.history", 1);
+        CHECK_EQ(store.recordCount(), size_t(200));
+        CHECK_EQ(std::filesystem::file_size("library.history"), size);
+        // 截断后照常追加
+        store.append(makeBatch(50, 5, 5, "").records, 2);
+        CHECK_EQ(store.recordCount(), size_t(250));
+    });
+
+    test::run("rollback 撤销追加的段", [] {
+        test::ScratchDir dir("history_rollback");
+        HistoryStore store;
+        store.open("library.history", 0);
+        store.append(makeBatch(100, 5, 5, "").records, 1);
+        uint64_t mark = store.fileSize();
+        store.append(makeBatch(100, 5, 5, "新").records, 2);
+        store.purge(HistoryKey::Book, "书0", 2);
+        store.rollback(mark);
+        CHECK_EQ(store.recordCount(), size_t(100));
+        CHECK_EQ(std::filesystem::file_size("library.history"), mark);
+        CHECK_EQ(countOf(store, HistoryKey::Book, "书0"), size_t(20));
+        CHECK_EQ(countOf(store, HistoryKey::Book, "新书0"), size_t(0));
+    });
+
+    test::run("清除标记之前的记录不再读出，之后追加的同名记录照常读出", [] {
+        test::ScratchDir dir("history_purge");
+        HistoryStore store;
+        store.open("library.history", 0);
+        store.append(makeBatch(100, 5, 5, "").records, 1);
+        store.purge(HistoryKey::Reader, "读者1", 1);
+        CHECK_EQ(countOf(store, HistoryKey::Reader, "读者1"), size_t(0));
+        CHECK_EQ(countOf(store, HistoryKey::Reader, "读者2"), size_t(20));
+        // 按书名读取时同样跳过该读者的记录
+        CHECK_EQ(countOf(store, HistoryKey::Book, "书1"), size_t(0));
+        store.append(makeBatch(10, 5, 5, "").records, 1);
+        CHECK_EQ(countOf(store, HistoryKey::Reader, "读者1"), size_t(2));
+        store.close();
+        store.open("library.history", 1);
+        CHECK_EQ(countOf(store, HistoryKey::Reader, "读者1"), size_t(2));
+    });
+
+    test::run("损坏的文件头和段内容", [] {
+        test::ScratchDir dir("history_corrupt");
+        {
+            std::ofstream out("library.history", std::ios::binary);
+            out << "NOTHIST!0000";
+        }
+        HistoryStore store;
+        CHECK_THROWS(DataFormatException, store.open("library.history", 0));
+        CHECK_EQ(std::filesystem::file_size("library.history"), uintmax_t(12));
+        std::filesystem::remove("library.history");
+
+        store.open("library.history", 0);
+        store.append(makeBatch(100, 5, 5, "").records, 1);
+        uint64_t size = store.fileSize();
+        store.close();
+        {
+            // 改写最后一段负载末尾的一个字节：段头完整，读到该段时校验和不符
+            std::fstream file("library.history", std::ios::in | std::ios::out | std::ios::binary);
+            file.seekp(static_cast<std::streamoff>(size - 2));
+            file.put('\x7f');
+        }
+        store.open("library.history", 1);
+        CHECK_THROWS(DataFormatException, store.forEach([](const HistoryRecord&) {}));
+    });
+
+    test::run("没有快照时改名保留，不截断", [] {
+        test::ScratchDir dir("history_move_aside");
+        CHECK(HistoryStore::moveAside("library.history").empty());
+        {
+            HistoryStore store;
+            store.open("library.history", 0);
+        }
+        // 只有文件头时不必保留
+        CHECK(HistoryStore::moveAside("library.history").empty());
+        {
+            HistoryStore store;
+            store.open("library.history", 0);
+            store.append(makeBatch(100, 5, 5, "").records, 1);
+        }
+        auto size = std::filesystem::file_size("library.history");
+        CHECK(HistoryStore::moveAside("library.history") == "library.history.bak");
+        CHECK(!std::filesystem::exists("library.history"));
+        CHECK_EQ(std::filesystem::file_size("library.history.bak"), size);
+        {
+            HistoryStore store;
+            store.open("library.history", 0);
+            store.append(makeBatch(10, 5, 5, "").records, 1);
+        }
+        // 已有的备份不覆盖
+        CHECK(HistoryStore::moveAside("library.history") == "library.history.bak.1");
+        CHECK_EQ(std::filesystem::file_size("library.history.bak"), size);
+        HistoryStore store;
+        store.open("library.history.bak", 1);
+        CHECK_EQ(store.recordCount(), size_t(100));
+    });
+    return test::finish();
+}
\ No newline at end of file
@@ -0,0 +1,122 @@
+// 写日志失败时借还、支付、删除图书和预约都不生效：先写日志再修改状态，调用方收到异常后重试不会重复生效。
+// 用 RLIMIT_FSIZE 把日志文件限制在当前大小之后几个字节，write 先写入一部分、再以 EFBIG 失败，
+// 同时检查写了一半的记录被截掉，恢复后追加的记录重新加载时全部重放
+#include "Library.h"
+#include "TestSupport.h"
+#include <csignal>
+#include <sys/resource.h>
+
+namespace {
+    JournalOptions perOperation() {
+        JournalOptions options;
+        options.policy = FsyncPolicy::PerOperation;
+        return options;
+    }
+
+    uint64_t journalSize() {
+        return std::filesystem::file_size("library.journal");
+    }
+
+    // 期间本进程写文件最多写到日志当前大小之后 kSlack 字节，析构时恢复
+    class JournalLimit {
+    public:
+        static constexpr rlim_t kSlack = 5;
+
+        JournalLimit() {
+            ::getrlimit(RLIMIT_FSIZE, &previous);
+            previousHandler = std::signal(SIGXFSZ, SIG_IGN);
+            rlimit limit = previous;
+            limit.rlim_cur = static_cast<rlim_t>(journalSize()) + kSlack;
+            ::setrlimit(RLIMIT_FSIZE, &limit);
+        }
+        ~JournalLimit() {
+            ::setrlimit(RLIMIT_FSIZE, &previous);
+            std::signal(SIGXFSZ, previousHandler);
+        }
+        JournalLimit(const JournalLimit&) = delete;
+        JournalLimit& operator=(const JournalLimit&) = delete;
+
+    private:
+        rlimit previous{};
+        void (*previousHandler)(int) = SIG_DFL;
+    };
+
+    // 操作因写日志失败而抛出，日志文件仍停在原来的大小
+    template <typename Operation>
+    void checkJournalFails(Operation operation) {
+        uint64_t before = journalSize();
+        bool failed = false;
+        try {
+            operation();
+        } catch (const std::runtime_error& ex) {
+            failed = std::string(ex.what()).find("写入日志失败") != std::string::npos;
+        }
+        CHECK(failed);
+        CHECK_EQ(journalSize(), before);
+    }
+
+    // 图书：在架的书、借出的书（读者甲借走，读者乙排队）、待删的书；读者甲欠款 10
+    void populate(Library& library) {
+        library.addBook(library.makeBook<Novel>("在架的书", "作者"));
+        library.addBook(library.makeBook<Novel>("借出的书", "作者"));
+        library.addBook(library.makeBook<Novel>("待删的书", "作者"));
+        Reader* owing = library.makeReader<RegularMember>("读者甲");
+        owing->addFine(10.0);
+        library.addReader(owing);
+        library.addReader(library.makeReader<RegularMember>("读者乙"));
+        library.addReader(library.makeReader<RegularMember>("读者丙"));
+        library.borrowBook("借出的书", "读者甲");
+        library.placeHold("借出的书", "读者乙");
+    }
+}
+
+int main() {
+    test::run("写日志失败的操作不生效，重试只生效一次", [] {
+        test::ScratchDir dir("journal_failure");
+        {
+            Library library(1.0, perOperation());
+            populate(library);
+            {
+                JournalLimit limit;
+                checkJournalFails([&] { library.borrowBook("在架的书", "读者甲"); });
+                checkJournalFails([&] { library.returnBook("借出的书", "读者甲"); });
+                checkJournalFails([&] { library.payFine("读者甲", 4.0); });
+                checkJournalFails([&] { library.removeBook("待删的书"); });
+                checkJournalFails([&] { library.placeHold("借出的书", "读者丙"); });
+                checkJournalFails([&] { library.cancelHold("借出的书", "读者乙"); });
+            }
+            CHECK_EQ(library.findBook("在架的书")->getAvailableCopies(), 1u);
+            CHECK_EQ(library.findBook("借出的书")->getAvailableCopies(), 0u);
+            CHECK_EQ(library.countBorrowedBooks(), 1);
+            CHECK_EQ(library.countBooks(), 3);
+            AccountSummary account = library.readerAccount("读者甲");
+            CHECK_EQ(account.activeLoans, 1);
+            CHECK_EQ(account.lifetimeLoans, uint64_t(1));
+            CHECK_EQ(account.outstandingFine, 10.0);
+
+            // 恢复后重试：每个操作都按第一次执行（已生效的预约会被拒绝，已删除的图书会找不到）
+            library.borrowBook("在架的书", "读者甲");
+            library.returnBook("借出的书", "读者甲");
+            CHECK_EQ(library.payFine("读者甲", 4.0).outstandingFine, 6.0);
+            library.removeBook("待删的书");
+            library.placeHold("借出的书", "读者丙");
+            library.cancelHold("借出的书", "读者乙");
+            CHECK_EQ(library.countBorrowedBooks(), 1);
+            CHECK_EQ(library.countBooks(), 2);
+            CHECK_EQ(library.readerAccount("读者甲").lifetimeLoans, uint64_t(2));
+        }
+        // 失败时写了一半的记录已截掉，之后的记录都能重放
+        Library reloaded(1.0, perOperation());
+        CHECK_EQ(reloaded.countBorrowedBooks(), 1);
+        CHECK_EQ(reloaded.countBooks(), 2);
+        CHECK(reloaded.findBook("待删的书") == nullptr);
+        AccountSummary account = reloaded.readerAccount("读者甲");
+        CHECK_EQ(account.activeLoans, 1);
+        CHECK_EQ(account.lifetimeLoans, uint64_t(2));
+        CHECK_EQ(account.outstandingFine, 6.0);
+        // 读者乙取消后，归还的副本转给读者丙
+        CHECK_THROWS(InvalidInputException, reloaded.cancelHold("借出的书", "读者乙"));
+        CHECK(reloaded.borrowBook("借出的书", "读者丙").status == OperationStatus::Borrowed);
+    });
+    return test::finish();
+}
\ No newline at end of file
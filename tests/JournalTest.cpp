@@ -0,0 +1,198 @@
+// 操作日志：记录编解码、按代号重放、残缺尾部和损坏记录的恢复
+#include "Exceptions.h"
+#include "Journal.h"
+#include "TestSupport.h"
+#include <fstream>
+#include <thread>
+#include <vector>
+
+namespace {
+    struct Replayed {
+        std::vector<std::string> titles;
+        uint64_t validBytes = 0;
+    };
+
+    Replayed replay(uint64_t generation) {
+        Replayed result;
+        result.validBytes = Journal::replay("library.journal", generation, [&](JournalEntry& entry) {
+            CHECK(entry.op() == JournalOp::AddBook);
+            result.titles.push_back(entry.getString());
+            CHECK_EQ(entry.getInt(), int64_t(result.titles.size()));
+            CHECK(entry.atEnd());
+        });
+        return result;
+    }
+
+    void appendBooks(Journal& journal, int first, int last) {
+        for (int i = first; i <= last; ++i) {
+            journal.append(JournalEntry(JournalOp::AddBook).putString("书" + std::to_string(i)).putInt(i));
+        }
+    }
+
+    JournalOptions options(FsyncPolicy policy) {
+        JournalOptions result;
+        result.policy = policy;
+        result.interval = std::chrono::milliseconds(5);
+        return result;
+    }
+}
+
+int main() {
+    test::run("记录字段的写入与读取", [] {
+        JournalEntry written(JournalOp::Borrow);
+        written.putString("三体").putString("").putInt(-42).putDouble(2.5).putByte(7);
+        JournalEntry entry(written.op(), written.payload());
+        CHECK(entry.getString() == "三体");
+        CHECK(entry.getString().empty());
+        CHECK_EQ(entry.getInt(), int64_t(-42));
+        CHECK_EQ(entry.getDouble(), 2.5);
+        CHECK_EQ(int(entry.getByte()), 7);
+        CHECK(entry.atEnd());
+        CHECK_THROWS(DataFormatException, entry.getByte());
+        // 字符串长度声明超过剩余负载
+        JournalEntry truncated(JournalOp::Borrow, written.payload().substr(0, 5));
+        CHECK_THROWS(DataFormatException, truncated.getString());
+    });
+
+    for (FsyncPolicy policy : { FsyncPolicy::PerOperation, FsyncPolicy::Batched, FsyncPolicy::Timer }) {
+        test::run(("按代号重放（刷盘策略 " + std::to_string(int(policy)) + "）").c_str(), [=] {
+            test::ScratchDir dir("journal_replay");
+            uint64_t size = 0;
+            {
+                Journal journal("library.journal", 5, 0, options(policy));
+                appendBooks(journal, 1, 100);
+                size = journal.size();
+            }
+            CHECK_EQ(std::filesystem::file_size("library.journal"), size);
+            Replayed replayed = replay(5);
+            CHECK_EQ(replayed.titles.size(), size_t(100));
+            CHECK(!replayed.titles.empty() && replayed.titles.back() == "书100");
+            CHECK_EQ(replayed.validBytes, size);
+            // 与快照代号不符的日志整体丢弃
+            Replayed stale = replay(4);
+            CHECK(stale.titles.empty() && stale.validBytes == 0);
+        });
+    }
+
+    // 刷盘在锁外进行，多个线程同时追加并各自等待刷盘，记录不丢失、不交错
+    for (FsyncPolicy policy : { FsyncPolicy::PerOperation, FsyncPolicy::Batched, FsyncPolicy::Timer }) {
+        test::run(("多线程追加（刷盘策略 " + std::to_string(int(policy)) + "）").c_str(), [=] {
+            test::ScratchDir dir("journal_threads");
+            constexpr int kThreads = 4;
+            constexpr int kPerThread = 150;
+            uint64_t size = 0;
+            {
+                Journal journal("library.journal", 1, 0, options(policy));
+                std::vector<std::thread> writers;
+                for (int t = 0; t < kThreads; ++t) {
+                    writers.emplace_back([&, t] {
+                        for (int i = 0; i < kPerThread; ++i) {
+                            journal.append(JournalEntry(JournalOp::PayFine).putString("读者" + std::to_string(t)).putInt(i));
+                            if (i % 50 == 0) journal.sync();
+                        }
+                    });
+                }
+                for (std::thread& writer : writers) writer.join();
+                size = journal.size();
+            }
+            std::vector<int64_t> next(kThreads, 0);
+            size_t count = 0;
+            uint64_t valid = Journal::replay("library.journal", 1, [&](JournalEntry& entry) {
+                int t = std::stoi(entry.getString().substr(std::string("读者").size()));
+                // 同一线程的记录按追加顺序出现
+                CHECK_EQ(entry.getInt(), next[t]++);
+                ++count;
+            });
+            CHECK_EQ(count, size_t(kThreads * kPerThread));
+            CHECK_EQ(valid, size);
+        });
+    }
+
+    test::run("代号不符的旧日志在重新打开时清空，之后不再重放", [] {
+        // 模拟快照改名完成、清空日志之前崩溃：日志仍是第 5 代，快照已是第 6 代
+        test::ScratchDir dir("journal_stale");
+        {
+            Journal journal("library.journal", 5, 0, options(FsyncPolicy::PerOperation));
+            appendBooks(journal, 1, 3);
+        }
+        for (int restart = 0; restart < 2; ++restart) {
+            Replayed replayed = replay(6);
+            CHECK(replayed.titles.empty());
+            // 第一次打开时旧日志整体不可用，第二次只剩新代号的文件头
+            CHECK_EQ(replayed.validBytes, uint64_t(restart == 0 ? 0 : 16));
+            Journal journal("library.journal", 6, replayed.validBytes, options(FsyncPolicy::PerOperation));
+            CHECK_EQ(journal.size(), std::filesystem::file_size("library.journal"));
+        }
+        CHECK(replay(5).titles.empty());
+        // 新代号下追加的记录照常重放
+        {
+            Journal journal("library.journal", 6, replay(6).validBytes, options(FsyncPolicy::PerOperation));
+            appendBooks(journal, 1, 2);
+        }
+        CHECK_EQ(replay(6).titles.size(), size_t(2));
+    });
+
+    test::run("残缺的尾部记录被截掉，之后继续追加", [] {
+        test::ScratchDir dir("journal_torn");
+        uint64_t size = 0;
+        {
+            Journal journal("library.journal", 1, 0, options(FsyncPolicy::PerOperation));
+            appendBooks(journal, 1, 10);
+            size = journal.size();
+        }
+        // 最后一条只写了一半；再截到只剩半个帧头
+        for (uint64_t cut : { uint64_t(5), uint64_t(25) }) {
+            std::filesystem::resize_file("library.journal", size - cut);
+            Replayed replayed = replay(1);
+            CHECK_EQ(replayed.titles.size(), size_t(9));
+            CHECK(replayed.validBytes < size - cut);
+        }
+        Replayed replayed = replay(1);
+        {
+            Journal journal("library.journal", 1, replayed.validBytes, options(FsyncPolicy::PerOperation));
+            CHECK_EQ(journal.size(), replayed.validBytes);
+            appendBooks(journal, 10, 12);
+        }
+        Replayed resumed = replay(1);
+        CHECK_EQ(resumed.titles.size(), size_t(12));
+        CHECK_EQ(resumed.validBytes, std::filesystem::file_size("library.journal"));
+    });
+
+    test::run("校验和不符的记录及其之后的内容不重放", [] {
+        test::ScratchDir dir("journal_corrupt");
+        uint64_t afterFive = 0;
+        {
+            Journal journal("library.journal", 2, 0, options(FsyncPolicy::Batched));
+            appendBooks(journal, 1, 5);
+            afterFive = journal.size();
+            appendBooks(journal, 6, 10);
+        }
+        {
+            // 第 6 条记录的负载（帧头 8 字节之后）改写一个字节
+            std::fstream file("library.journal", std::ios::in | std::ios::out | std::ios::binary);
+            file.seekp(static_cast<std::streamoff>(afterFive + 10));
+            file.put('#');
+        }
+        Replayed replayed = replay(2);
+        CHECK_EQ(replayed.titles.size(), size_t(5));
+        CHECK_EQ(replayed.validBytes, afterFive);
+    });
+
+    test::run("清空日志后切换代号", [] {
+        test::ScratchDir dir("journal_reset");
+        {
+            Journal journal("library.journal", 7, 0, options(FsyncPolicy::Timer));
+            appendBooks(journal, 1, 3);
+            journal.reset(8);
+            appendBooks(journal, 1, 2);
+        }
+        CHECK(replay(7).titles.empty());
+        CHECK_EQ(replay(8).titles.size(), size_t(2));
+        // 文件头不完整或文件不存在时没有可重放的内容
+        std::filesystem::resize_file("library.journal", 6);
+        CHECK_EQ(replay(8).validBytes, uint64_t(0));
+        std::filesystem::remove("library.journal");
+        CHECK_EQ(replay(8).validBytes, uint64_t(0));
+    });
+    return test::finish();
+}
\ No newline at end of file
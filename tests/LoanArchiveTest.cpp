@@ -0,0 +1,218 @@
+// 借阅记录列式分块编码（LoanArchive）的往返与兼容性测试
+#include "Exceptions.h"
+#include "LoanArchive.h"
+#include "TestSupport.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <random>
+
+namespace {
+    constexpr int64_t kStart = 1700000000;
+    constexpr int64_t kDay = 24 * 60 * 60;
+
+    bool sameRow(const LoanRow& a, const LoanRow& b) {
+        return a.book == b.book && a.reader == b.reader && a.borrowDate == b.borrowDate && a.dueDate == b.dueDate
+            && a.returnDate == b.returnDate && a.returned == b.returned && a.copy == b.copy;
+    }
+
+    // 编码后逐块解码，应与按借阅时间稳定排序后的输入逐条相同，块索引的范围与块内数据一致
+    void checkRoundTrip(std::vector<LoanRow> rows, uint32_t expectFlags) {
+        std::vector<LoanRow> expected = rows;
+        std::stable_sort(expected.begin(), expected.end(), [](const LoanRow& a, const LoanRow& b) { return a.borrowDate < b.borrowDate; });
+        std::string data;
+        std::vector<loanarchive::BlockInfo> blocks;
+        loanarchive::encode(rows, data, blocks);
+        CHECK_EQ(blocks.size(), (expected.size() + loanarchive::kBlockRows - 1) / loanarchive::kBlockRows);
+        std::vector<LoanRow> decoded;
+        for (const loanarchive::BlockInfo& block : blocks) {
+            size_t base = decoded.size();
+            loanarchive::decodeBlock(data.data(), data.size(), block, decoded);
+            CHECK_EQ(decoded.size() - base, size_t(block.count));
+            CHECK_EQ(decoded[base].borrowDate, block.minBorrow);
+            CHECK_EQ(decoded.back().borrowDate, block.maxBorrow);
+            auto [minDue, maxDue] = std::minmax_element(decoded.begin() + base, decoded.end(),
+                [](const LoanRow& a, const LoanRow& b) { return a.dueDate < b.dueDate; });
+            CHECK_EQ(minDue->dueDate, block.minDue);
+            CHECK_EQ(maxDue->dueDate, block.maxDue);
+            CHECK_EQ(block.flags, expectFlags);
+        }
+        CHECK_EQ(decoded.size(), expected.size());
+        size_t mismatched = 0;
+        for (size_t i = 0; i < std::min(decoded.size(), expected.size()); ++i) mismatched += !sameRow(decoded[i], expected[i]);
+        CHECK_EQ(mismatched, size_t(0));
+    }
+
+    std::vector<LoanRow> randomRows(size_t count, std::mt19937_64& rng, int64_t unit, uint32_t maxId, uint32_t maxCopy) {
+        std::vector<LoanRow> rows(count);
+        for (LoanRow& row : rows) {
+            row.book = static_cast<uint32_t>(rng() % (uint64_t(maxId) + 1));
+            row.reader = static_cast<uint32_t>(rng() % (uint64_t(maxId) + 1));
+            row.borrowDate = kStart + static_cast<int64_t>(rng() % 1000) * unit;
+            row.dueDate = row.borrowDate + static_cast<int64_t>(rng() % 60) * unit;
+            row.returned = rng() % 3 != 0;
+            row.returnDate = row.returned ? row.borrowDate + static_cast<int64_t>(rng() % 90) * unit : 0;
+            row.copy = maxCopy == 0 ? 0 : static_cast<uint32_t>(rng() % (maxCopy + 1));
+        }
+        return rows;
+    }
+
+    void writeArchive(const std::string& path, const std::vector<LoanRow>& rows, const std::vector<std::string>& names) {
+        LoanArchiveWriter writer;
+        for (const std::string& name : names) writer.addName(name);
+        for (const LoanRow& row : rows) {
+            writer.add(row.book, row.reader, row.borrowDate, row.dueDate, row.returnDate, row.returned, row.copy);
+        }
+        writer.write(path);
+    }
+
+    void patchByte(const std::string& path, std::streamoff offset, char value) {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(offset);
+        file.put(value);
+    }
+}
+
+int main() {
+    test::run("按天借期（公约数 86400）跨多块", [] {
+        std::mt19937_64 rng(1);
+        checkRoundTrip(randomRows(3 * loanarchive::kBlockRows + 17, rng, kDay, 5000, 0), 0);
+    });
+    test::run("任意秒数偏移（公约数为 1）", [] {
+        std::mt19937_64 rng(2);
+        checkRoundTrip(randomRows(loanarchive::kBlockRows + 1, rng, 7, 1000, 0), 0);
+    });
+    test::run("块边界的条数", [] {
+        std::mt19937_64 rng(3);
+        for (size_t count : { size_t(1), loanarchive::kBlockRows - 1, loanarchive::kBlockRows }) {
+            checkRoundTrip(randomRows(count, rng, kDay, 100, 0), 0);
+        }
+    });
+    test::run("编号位宽 0 与 32", [] {
+        std::mt19937_64 rng(4);
+        std::vector<LoanRow> zeros = randomRows(100, rng, kDay, 0, 0);
+        checkRoundTrip(zeros, 0);
+        std::vector<LoanRow> wide = randomRows(100, rng, kDay, 10, 0);
+        wide[0].book = UINT32_MAX;
+        wide[1].reader = UINT32_MAX;
+        checkRoundTrip(wide, 0);
+    });
+    test::run("副本编号列与负偏移", [] {
+        std::mt19937_64 rng(5);
+        std::vector<LoanRow> rows = randomRows(loanarchive::kBlockRows + 100, rng, kDay, 300, 40);
+        rows[0].copy = 40;
+        rows[1].dueDate = rows[1].borrowDate - kDay;
+        checkRoundTrip(rows, loanarchive::kHasCopies);
+    });
+    test::run("借阅时间相同的记录保持原有顺序", [] {
+        std::vector<LoanRow> rows;
+        for (uint32_t i = 0; i < 50; ++i) rows.push_back({ i, 49 - i, kStart + (i % 3) * kDay, kStart + 30 * kDay, 0, false, 0 });
+        checkRoundTrip(rows, 0);
+    });
+    test::run("全部已归还 / 全部未归还", [] {
+        std::mt19937_64 rng(6);
+        std::vector<LoanRow> rows = randomRows(200, rng, kDay, 50, 0);
+        for (LoanRow& row : rows) {
+            row.returned = true;
+            row.returnDate = row.borrowDate + 3 * kDay;
+        }
+        checkRoundTrip(rows, 0);
+        for (LoanRow& row : rows) {
+            row.returned = false;
+            row.returnDate = 0;
+        }
+        checkRoundTrip(rows, 0);
+    });
+
+    test::run("文件往返与按时间范围读取", [] {
+        test::ScratchDir dir("loan_archive");
+        std::mt19937_64 rng(7);
+        std::vector<LoanRow> rows = randomRows(2 * loanarchive::kBlockRows + 5, rng, kDay, 2, 3);
+        std::vector<std::string> names = { "数据结构", "张三", "李四" };
+        writeArchive("records.lar", rows, names);
+        LoanArchiveReader reader("records.lar");
+        CHECK(reader.isOpen());
+        CHECK_EQ(reader.rowCount(), rows.size());
+        CHECK(reader.names().size() == names.size() && reader.names()[1] == "张三");
+        size_t seen = 0;
+        CHECK_EQ(reader.forEach([&](const LoanRow&) { ++seen; }), rows.size());
+        CHECK_EQ(seen, rows.size());
+        int64_t from = kStart + 200 * kDay;
+        int64_t to = kStart + 260 * kDay;
+        size_t expected = std::count_if(rows.begin(), rows.end(), [&](const LoanRow& row) { return row.borrowDate >= from && row.borrowDate < to; });
+        size_t inRange = 0;
+        size_t returned = reader.forEachBorrowedBetween(from, to, [&](const LoanRow& row) {
+            inRange += row.borrowDate >= from && row.borrowDate < to;
+        });
+        CHECK_EQ(returned, expected);
+        CHECK_EQ(inRange, expected);
+        CHECK(!LoanArchiveReader("missing.lar").isOpen());
+    });
+    test::run("版本 1 文件（没有副本编号列）", [] {
+        // 由版本 1 的 LoanArchiveWriter 写出：300 条，第 i 条借阅时间 kStart + i 小时，
+        // 单数条为 数据结构、双数条为 三体，i % 5 == 0 时读者为 李四，否则为 张三，i % 3 != 0 时已归还（i % 40 天后）
+        LoanArchiveReader reader(test::fixture("loans_v1.lar"));
+        CHECK(reader.isOpen());
+        CHECK_EQ(reader.rowCount(), size_t(300));
+        CHECK(reader.names().size() == 4 && reader.names()[0] == "数据结构" && reader.names()[3] == "李四");
+        size_t i = 0;
+        size_t mismatched = 0;
+        reader.forEach([&](const LoanRow& row) {
+            LoanRow expected{ i % 2 ? 0u : 1u, i % 5 ? 2u : 3u, kStart + static_cast<int64_t>(i) * 3600, 0, 0, i % 3 != 0, 0 };
+            expected.dueDate = expected.borrowDate + 30 * kDay;
+            expected.returnDate = expected.returned ? expected.borrowDate + static_cast<int64_t>(i % 40) * kDay : 0;
+            mismatched += !sameRow(row, expected);
+            ++i;
+        });
+        CHECK_EQ(i, size_t(300));
+        CHECK_EQ(mismatched, size_t(0));
+    });
+
+    test::run("损坏的块：校验和、越界、记录数、标志", [] {
+        std::mt19937_64 rng(8);
+        std::vector<LoanRow> rows = randomRows(500, rng, kDay, 100, 0);
+        std::string data;
+        std::vector<loanarchive::BlockInfo> blocks;
+        loanarchive::encode(rows, data, blocks);
+        std::vector<LoanRow> out;
+        std::string flipped = data;
+        flipped[flipped.size() / 2] ^= 0x40;
+        CHECK_THROWS(DataFormatException, loanarchive::decodeBlock(flipped.data(), flipped.size(), blocks[0], out));
+        CHECK_THROWS(DataFormatException, loanarchive::decodeBlock(data.data(), data.size() - 1, blocks[0], out));
+        loanarchive::BlockInfo wrongCount = blocks[0];
+        wrongCount.count += 1;
+        CHECK_THROWS(DataFormatException, loanarchive::decodeBlock(data.data(), data.size(), wrongCount, out));
+        loanarchive::BlockInfo unknownFlag = blocks[0];
+        unknownFlag.flags = 0x80;
+        CHECK_THROWS(DataFormatException, loanarchive::decodeBlock(data.data(), data.size(), unknownFlag, out));
+    });
+    test::run("损坏的文件：截断、文件头、数据区", [] {
+        test::ScratchDir dir("loan_archive_corrupt");
+        std::mt19937_64 rng(9);
+        writeArchive("records.lar", randomRows(100, rng, kDay, 1, 0), { "书", "读者" });
+        auto size = std::filesystem::file_size("records.lar");
+        std::filesystem::copy_file("records.lar", "original.lar");
+
+        std::filesystem::resize_file("records.lar", size - 8);
+        CHECK_THROWS(DataFormatException, LoanArchiveReader("records.lar"));
+        std::filesystem::resize_file("records.lar", 20);
+        CHECK_THROWS(DataFormatException, LoanArchiveReader("records.lar"));
+
+        std::filesystem::copy_file("original.lar", "records.lar", std::filesystem::copy_options::overwrite_existing);
+        patchByte("records.lar", 0, 'X');
+        CHECK_THROWS(DataFormatException, LoanArchiveReader("records.lar"));
+
+        // 数据区紧接在文件头之后（文件头在 magic 和版本号之后记录自身大小），改写块内第 4 字节：
+        // 打开时只检查边界，解码该块时校验和不符
+        std::filesystem::copy_file("original.lar", "records.lar", std::filesystem::copy_options::overwrite_existing);
+        std::ifstream in("records.lar", std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        in.close();
+        uint32_t headerSize;
+        std::memcpy(&headerSize, bytes.data() + 12, sizeof(headerSize));
+        patchByte("records.lar", headerSize + 3, static_cast<char>(bytes[headerSize + 3] ^ 0x01));
+        LoanArchiveReader reader("records.lar");
+        CHECK_THROWS(DataFormatException, reader.forEach([](const LoanRow&) {}));
+    });
+    return test::finish();
+}
\ No newline at end of file
@@ -0,0 +1,129 @@
+// 借阅记录扫描内核（countOverdue / overdueFineTotal / countDueBetween）与逐条参考实现的对比。
+// 同一份源文件编译两次：RecordStoreTest 随 library_core 的指令集，RecordStoreAvx2Test 将 RecordStore.cpp 按 AVX2 编译，
+// 覆盖 4 条一组的向量循环、不足 4 条的尾部和按罚款类别查费率的 gather
+#include "RecordStore.h"
+#include "Book.h"
+#include "Reader.h"
+#include "TestSupport.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+
+namespace {
+    constexpr std::time_t kNow = 1700000000;
+    constexpr std::time_t kDay = 24 * 60 * 60;
+
+    // 每个图书类别 × 会员等级各一个对象，记录随机落在其中之一
+    struct Owners {
+        std::vector<std::unique_ptr<Book>> books;
+        std::vector<std::unique_ptr<Reader>> readers;
+
+        Owners() {
+            for (size_t i = 0; i < static_cast<size_t>(BookCategory::Count); ++i) {
+                books.push_back(std::make_unique<Book>("书" + std::to_string(i), "作者", "普通图书", static_cast<BookCategory>(i)));
+            }
+            for (size_t i = 0; i < static_cast<size_t>(MemberTier::Count); ++i) {
+                readers.push_back(std::make_unique<Reader>("读者" + std::to_string(i), 30, 0.0, static_cast<MemberTier>(i)));
+            }
+        }
+    };
+
+    // 应还日期在 now 前后 100 天内，三分之一恰好落在整天边界附近（超期满一天与差一秒）
+    void fill(RecordStore& store, const Owners& owners, size_t count, std::mt19937_64& rng) {
+        store.clear();
+        for (size_t i = 0; i < count; ++i) {
+            std::time_t due = kNow + static_cast<std::time_t>(rng() % (200 * kDay)) - 100 * kDay;
+            if (rng() % 3 == 0) due = kNow - static_cast<std::time_t>(rng() % 4) * kDay + static_cast<std::time_t>(rng() % 3) - 1;
+            Book* book = owners.books[rng() % owners.books.size()].get();
+            Reader* reader = owners.readers[rng() % owners.readers.size()].get();
+            size_t pos = store.append(book, 0, reader, due - 30 * kDay, due);
+            if (rng() % 4 == 0) store.markReturned(pos, due);
+        }
+    }
+
+    struct Expected {
+        size_t overdue = 0;
+        double fines = 0.0;
+        size_t dueBetween = 0;
+    };
+
+    Expected reference(const RecordStore& store, std::time_t now, std::time_t from, std::time_t to) {
+        Expected expected;
+        for (size_t i = 0; i < store.size(); ++i) {
+            if (store.isReturned(i)) continue;
+            std::time_t due = store.dueDateAt(i);
+            int days = static_cast<int>((now - due) / kDay);
+            expected.overdue += days > 0;
+            expected.fines += FinePolicy::fine(days, store.bookAt(i)->getCategory(), store.readerAt(i)->getTier());
+            expected.dueBetween += due >= from && due < to;
+        }
+        return expected;
+    }
+
+    void checkKernels(const RecordStore& store, std::time_t now, std::time_t from, std::time_t to) {
+        Expected expected = reference(store, now, from, to);
+        CHECK_EQ(store.countOverdue(now), expected.overdue);
+        CHECK_EQ(store.countDueBetween(from, to), expected.dueBetween);
+        // 向量版按通道分别累加，求和顺序不同，只比较到相对误差
+        double fines = store.overdueFineTotal(now);
+        if (std::fabs(fines - expected.fines) > 1e-9 * std::max(1.0, expected.fines)) {
+            CHECK_EQ(fines, expected.fines);
+        }
+    }
+}
+
+int main() {
+#if defined(__AVX2__) && (defined(__GNUC__) || defined(__clang__))
+    if (!__builtin_cpu_supports("avx2")) {
+        std::printf("CPU 不支持 AVX2，跳过\n");
+        return 77;
+    }
+#endif
+    Owners owners;
+
+    test::run("各种长度的随机列（含不足 4 条的尾部）", [&] {
+        std::mt19937_64 rng(11);
+        RecordStore store;
+        for (size_t count : { 0, 1, 3, 4, 5, 7, 63, 64, 65, 129, 1000, 4099 }) {
+            fill(store, owners, count, rng);
+            checkKernels(store, kNow, kNow - 10 * kDay, kNow + 10 * kDay);
+            checkKernels(store, kNow + 12345, kNow - kDay + 1, kNow);
+        }
+    });
+
+    test::run("扫描时刻落在整天边界", [&] {
+        std::mt19937_64 rng(12);
+        RecordStore store;
+        fill(store, owners, 2003, rng);
+        for (std::time_t offset : { std::time_t(0), std::time_t(1), std::time_t(-1), kDay, kDay - 1, kDay + 1 }) {
+            checkKernels(store, kNow + offset, kNow + offset, kNow + offset + kDay);
+        }
+        // 空区间与覆盖全部记录的区间
+        checkKernels(store, kNow, kNow, kNow);
+        checkKernels(store, kNow, kNow - 1000 * kDay, kNow + 1000 * kDay);
+    });
+
+    test::run("删除记录压缩各列后（归还位图整体前移）", [&] {
+        std::mt19937_64 rng(13);
+        RecordStore store;
+        fill(store, owners, 1501, rng);
+        size_t index = 0;
+        store.eraseIf([&](const BorrowRecord&) { return index++ % 7 == 3; });
+        checkKernels(store, kNow, kNow - 5 * kDay, kNow + 5 * kDay);
+    });
+
+    test::run("罚款费率表更换后按新费率查表", [&] {
+        std::mt19937_64 rng(14);
+        RecordStore store;
+        fill(store, owners, 777, rng);
+        FineTable original = FinePolicy::table();
+        FineTable table = original;
+        for (size_t i = 0; i < static_cast<size_t>(BookCategory::Count); ++i) table.ratePerDay[i] = 0.25 * static_cast<double>(i + 3);
+        table.discount[static_cast<size_t>(MemberTier::VIP)] = 0.5;
+        FinePolicy::configure(table);
+        checkKernels(store, kNow, kNow, kNow + kDay);
+        FinePolicy::configure(original);
+    });
+    return test::finish();
+}
\ No newline at end of file
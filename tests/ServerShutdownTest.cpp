@@ -0,0 +1,124 @@
+// 服务器模式的正常退出：启动 library --serve，确认所有线程（包括启动时的罚款预估线程及其线程池）都屏蔽了 SIGINT / SIGTERM，
+// 发送 SIGTERM 后由 signalfd 接收，析构 Library（写出 metrics.txt、日志刷盘）并删除套接字文件
+#include "Library.h"
+#include "TestSupport.h"
+#include <csignal>
+#include <fstream>
+#include <set>
+#include <thread>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+    // /proc/<pid>/task/<tid>/status 中的 SigBlk 为十六进制位图，信号 n 对应第 n - 1 位。
+    // 返回 1 / 0 表示是否屏蔽了 SIGINT 和 SIGTERM，线程已退出、读不到时返回 -1
+    int blocksShutdownSignals(const std::filesystem::path& status) {
+        std::ifstream in(status);
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.rfind("SigBlk:", 0) != 0) continue;
+            unsigned long long mask = std::stoull(line.substr(7), nullptr, 16);
+            unsigned long long wanted = (1ull << (SIGINT - 1)) | (1ull << (SIGTERM - 1));
+            return (mask & wanted) == wanted ? 1 : 0;
+        }
+        return -1;
+    }
+
+    // 服务启动时的罚款预估要处理足够多的超期借阅，运行期间能被采样到：每位读者借一本，都已超期
+    void seedLoans(int count) {
+        FakeClock clock(DateUtils::getCurrentTime() - 100 * 24 * 60 * 60);
+        DateUtils::setClock(&clock);
+        {
+            JournalOptions options;
+            options.policy = FsyncPolicy::Timer;
+            Library library(1.0, options);
+            for (int i = 0; i < count; ++i) {
+                library.addBook(library.makeBook<Novel>("书" + std::to_string(i), "作者"));
+                library.addReader(library.makeReader<RegularMember>("读者" + std::to_string(i)));
+                library.borrowBook("书" + std::to_string(i), "读者" + std::to_string(i));
+            }
+            library.saveData();
+        }
+        DateUtils::setClock(nullptr);
+    }
+
+    std::string readFile(const std::string& path) {
+        std::ifstream in(path);
+        return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    }
+
+    // 最多等待 10 秒
+    template <typename Condition>
+    bool waitFor(Condition condition) {
+        for (int i = 0; i < 1000; ++i) {
+            if (condition()) return true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return condition();
+    }
+}
+
+int main() {
+    test::run("SIGTERM 经 signalfd 正常退出", [] {
+        test::ScratchDir dir("server_shutdown");
+        seedLoans(20000);
+        pid_t pid = ::fork();
+        if (pid == 0) {
+            int out = ::open("server.out", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            ::dup2(out, STDOUT_FILENO);
+            ::dup2(out, STDERR_FILENO);
+            ::execl(LIBRARY_BINARY, "library", "--serve", "test.sock", static_cast<char*>(nullptr));
+            ::_exit(127);
+        }
+        CHECK(pid > 0);
+        if (pid <= 0) return;
+        // 从启动起反复采样，罚款预估线程和线程池只在启动后短暂存在。
+        // 主线程在 main 开头才设置屏蔽字，启动过程中不检查，套接字出现后再检查
+        std::set<std::string> seen;
+        std::set<std::string> unblocked;
+        std::filesystem::path tasks = "/proc/" + std::to_string(pid) + "/task";
+        bool started = waitFor([&] {
+            std::error_code error;
+            for (const auto& task : std::filesystem::directory_iterator(tasks, error)) {
+                std::string tid = task.path().filename().string();
+                if (tid == std::to_string(pid)) continue;
+                int blocked = blocksShutdownSignals(task.path() / "status");
+                if (blocked >= 0) seen.insert(tid);
+                if (blocked == 0) unblocked.insert(tid);
+            }
+            return std::filesystem::exists("test.sock");
+        });
+        CHECK(started);
+        CHECK(!seen.empty());
+        CHECK(unblocked.empty());
+
+        size_t threads = 0;
+        size_t blocked = 0;
+        for (const auto& task : std::filesystem::directory_iterator(tasks)) {
+            ++threads;
+            blocked += blocksShutdownSignals(task.path() / "status") == 1;
+        }
+        // 至少有主线程和指标输出线程
+        CHECK(threads >= 2);
+        CHECK_EQ(blocked, threads);
+
+        ::kill(pid, SIGTERM);
+        int status = 0;
+        bool exited = waitFor([&] { return ::waitpid(pid, &status, WNOHANG) == pid; });
+        CHECK(exited);
+        if (!exited) {
+            ::kill(pid, SIGKILL);
+            ::waitpid(pid, &status, 0);
+            return;
+        }
+        CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+        std::string output = readFile("server.out");
+        CHECK(output.find("收到退出信号") != std::string::npos);
+        CHECK(std::filesystem::exists("metrics.txt"));
+        // 退出前等待罚款预估线程完成
+        CHECK(std::filesystem::exists("fine_report.txt"));
+        CHECK(!std::filesystem::exists("test.sock"));
+    });
+    return test::finish();
+}
\ No newline at end of file
@@ -0,0 +1,174 @@
+// 二进制快照各版本的读取兼容性、当前版本的往返，以及损坏文件的处理。
+// tests/data/snapshot_v1 ~ v6.snap 由引入各版本的提交中的 SnapshotWriter 写出，内容相同（见 checkFixture）：
+//   图书：数据结构（严蔚敏，教科书）、三体（刘慈欣，小说，两册）、读者（编辑部，杂志）；
+//         版本 6 以前三体的第二册是排在最后的同名条目，版本 3 以前没有类别字节
+//   读者：张三（普通会员）、李四（VIP 会员，欠款 2.5）、王五（学生会员）；版本 5 起累计借阅数为 7、1、1
+//   借阅：张三借 数据结构 和 三体（第一册）未还；李四借 数据结构 已还；王五借 读者 未还且已超期
+//   用户：admin（管理员）、zhangsan（绑定张三）；版本 2 起日志代号为 3
+#include "Library.h"
+#include "Snapshot.h"
+#include "TestSupport.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+
+namespace {
+    constexpr int64_t kStart = 1700000000;
+    constexpr int64_t kDay = 24 * 60 * 60;
+
+    void checkFixture(uint32_t version) {
+        SnapshotReader snapshot(test::fixture("snapshot_v" + std::to_string(version) + ".snap"));
+        CHECK(snapshot.isOpen());
+        CHECK_EQ(snapshot.version(), version);
+        CHECK_EQ(snapshot.journalGeneration(), uint64_t(version >= 2 ? 3 : 0));
+
+        CHECK_EQ(snapshot.bookCount(), size_t(version >= 6 ? 3 : 4));
+        const snapshot::BookEntry* books = snapshot.books();
+        CHECK(snapshot.string(books[0].title) == "数据结构" && snapshot.string(books[0].author) == "严蔚敏");
+        CHECK(snapshot.string(books[1].title) == "三体" && snapshot.string(books[2].type) == "杂志");
+        if (version >= 3) CHECK_EQ(int(books[0].category), int(BookCategory::Textbook));
+        if (version >= 6) CHECK_EQ(int(books[1].copies), 2);
+        if (version < 6) CHECK(snapshot.string(books[3].title) == "三体");
+
+        CHECK_EQ(snapshot.readerCount(), size_t(3));
+        const snapshot::ReaderEntry* readers = snapshot.readers();
+        CHECK(snapshot.string(readers[1].name) == "李四");
+        CHECK_EQ(int(readers[1].type), int(MemberTier::VIP));
+        CHECK_EQ(readers[1].fine, 2.5);
+        if (version >= 5) {
+            CHECK(snapshot.readerLoans() != nullptr && snapshot.readerLoans()[0] == 7);
+        } else {
+            CHECK(snapshot.readerLoans() == nullptr);
+        }
+
+        CHECK_EQ(snapshot.recordCount(), size_t(4));
+        std::vector<LoanRow> rows;
+        snapshot.forEachRecord([&](const LoanRow& row) { rows.push_back(row); });
+        std::sort(rows.begin(), rows.end(), [](const LoanRow& a, const LoanRow& b) { return a.borrowDate < b.borrowDate; });
+        CHECK_EQ(rows.size(), size_t(4));
+        if (rows.size() == 4) {
+            CHECK(rows[0].book == 0 && rows[0].reader == 1 && rows[0].returned && rows[0].returnDate == kStart - 20 * kDay);
+            CHECK(rows[1].book == 2 && rows[1].reader == 2 && !rows[1].returned && rows[1].dueDate == kStart - 3 * kDay);
+            CHECK(rows[3].book == 1 && rows[3].reader == 0 && rows[3].borrowDate == kStart - 3 * kDay && rows[3].copy == 0);
+        }
+
+        CHECK_EQ(snapshot.userCount(), size_t(2));
+        const snapshot::UserEntry* users = snapshot.users();
+        CHECK(snapshot.string(users[1].username) == "zhangsan" && users[1].reader == 0);
+        CHECK_EQ(snapshot.holdCount(), size_t(0));
+    }
+
+    // 经 Library 加载：早期版本的同名条目合并为副本，类别按类型名推断，在架状态由未还记录恢复
+    void checkLoaded(uint32_t version) {
+        test::ScratchDir dir("snapshot_load_v" + std::to_string(version));
+        std::filesystem::copy_file(test::fixture("snapshot_v" + std::to_string(version) + ".snap"), "library.snap");
+        Library library;
+        Book* textbook = library.findBook("数据结构");
+        Book* novel = library.findBook("三体");
+        Book* magazine = library.findBook("读者");
+        CHECK(textbook && novel && magazine);
+        if (!textbook || !novel || !magazine) return;
+        CHECK_EQ(library.countBooks(), 3);
+        CHECK_EQ(int(textbook->getCategory()), int(BookCategory::Textbook));
+        CHECK_EQ(int(magazine->getCategory()), int(BookCategory::Magazine));
+        CHECK_EQ(novel->getCopyCount(), 2u);
+        CHECK_EQ(novel->getAvailableCopies(), 1u);
+        CHECK_EQ(textbook->getAvailableCopies(), 0u);
+        CHECK_EQ(library.findReader("李四")->getFine(), 2.5);
+        AccountSummary account = library.readerAccount("张三");
+        CHECK_EQ(account.activeLoans, 2);
+        // 版本 5 以前没有累计借阅数，按驻留记录计数
+        CHECK_EQ(account.lifetimeLoans, uint64_t(version >= 5 ? 7 : 2));
+        CHECK_EQ(library.readerAccount("王五").overdueLoans, 1);
+        CHECK(library.findUser("zhangsan") != nullptr);
+    }
+}
+
+int main() {
+    for (uint32_t version = 1; version < snapshot::kVersion; ++version) {
+        test::run(("读取版本 " + std::to_string(version) + " 的快照").c_str(), [=] { checkFixture(version); });
+        test::run(("加载版本 " + std::to_string(version) + " 的快照").c_str(), [=] { checkLoaded(version); });
+    }
+
+    test::run("当前版本往返：副本编号和预约", [] {
+        test::ScratchDir dir("snapshot_current");
+        std::filesystem::copy_file(test::fixture("snapshot_v6.snap"), "library.snap");
+        {
+            Library library;
+            library.borrowBook("三体", "李四");
+            library.placeHold("三体", "王五");
+            library.saveData();
+        }
+        SnapshotReader snapshot("library.snap");
+        CHECK_EQ(snapshot.version(), snapshot::kVersion);
+        CHECK_EQ(snapshot.journalGeneration(), uint64_t(4));
+        CHECK_EQ(snapshot.holdCount(), size_t(1));
+        if (snapshot.holdCount() == 1) {
+            const snapshot::HoldEntry& hold = snapshot.holds()[0];
+            CHECK(snapshot.string(snapshot.books()[hold.book].title) == "三体");
+            CHECK(snapshot.string(snapshot.readers()[hold.reader].name) == "王五");
+            CHECK_EQ(hold.deadline, int64_t(0));
+        }
+        std::vector<uint32_t> copies;
+        snapshot.forEachRecord([&](const LoanRow& row) {
+            if (!row.returned && snapshot.string(snapshot.books()[row.book].title) == "三体") copies.push_back(row.copy);
+        });
+        std::sort(copies.begin(), copies.end());
+        CHECK(copies == std::vector<uint32_t>({ 0, 1 }));
+
+        Library library;
+        CHECK_EQ(library.findBook("三体")->getAvailableCopies(), 0u);
+        CHECK_THROWS(InvalidInputException, library.placeHold("三体", "王五"));
+        library.cancelHold("三体", "王五");
+    });
+
+    test::run("损坏的快照：截断、文件头、版本、区越界", [] {
+        test::ScratchDir dir("snapshot_corrupt");
+        std::ifstream in(test::fixture("snapshot_v6.snap"), std::ios::binary);
+        std::string original((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        auto write = [](const std::string& bytes) {
+            std::ofstream out("library.snap", std::ios::binary | std::ios::trunc);
+            out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        };
+        write(original.substr(0, 40));
+        CHECK_THROWS(DataFormatException, SnapshotReader("library.snap"));
+        write(original.substr(0, original.size() / 2));
+        CHECK_THROWS(DataFormatException, SnapshotReader("library.snap"));
+
+        std::string badMagic = original;
+        badMagic[0] = 'X';
+        write(badMagic);
+        CHECK_THROWS(DataFormatException, SnapshotReader("library.snap"));
+
+        std::string badVersion = original;
+        uint32_t future = snapshot::kVersion + 1;
+        std::memcpy(&badVersion[8], &future, sizeof(future));
+        write(badVersion);
+        CHECK_THROWS(DataFormatException, SnapshotReader("library.snap"));
+
+        // 字符串区的条数改大，越过文件末尾
+        std::string badSection = original;
+        uint64_t huge = 1ull << 40;
+        std::memcpy(&badSection[offsetof(snapshot::Header, strings) + sizeof(uint64_t)], &huge, sizeof(huge));
+        write(badSection);
+        CHECK_THROWS(DataFormatException, SnapshotReader("library.snap"));
+
+        CHECK(!SnapshotReader("missing.snap").isOpen());
+    });
+
+    test::run("快照损坏时从文本文件导入", [] {
+        test::ScratchDir dir("snapshot_fallback");
+        {
+            std::ofstream out("library.snap", std::ios::binary);
+            out << "LIBSNAP";
+        }
+        std::ofstream("books.txt") << "小说,三体,刘慈欣,0,2\n";
+        Library library;
+        Book* novel = library.findBook("三体");
+        CHECK(novel != nullptr && novel->getCopyCount() == 2);
+        // 导入后立即写出新的快照
+        CHECK_EQ(SnapshotReader("library.snap").version(), snapshot::kVersion);
+    });
+    return test::finish();
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+#pragma once
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <sstream>
+#include <string>
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) test::fail(__FILE__, __LINE__, #condition); \
+    } while (0)
+
+#define CHECK_EQ(actual, expected) test::checkEqual((actual), (expected), #actual " == " #expected, __FILE__, __LINE__)
+
+#define CHECK_THROWS(ExceptionType, expression) \
+    do { \
+        bool thrown = false; \
+        try { \
+            expression; \
+        } catch (const ExceptionType&) { \
+            thrown = true; \
+        } \
+        if (!thrown) test::fail(__FILE__, __LINE__, "未抛出 " #ExceptionType ": " #expression); \
+    } while (0)
+
+// 测试用的最小断言工具：断言失败时输出位置并计数，不中断当前用例；每个测试程序的 main 依次 run 各用例，
+// 最后 finish 返回退出码（有失败时为 1），由 ctest 判定
+namespace test {
+    inline int& failures() {
+        static int count = 0;
+        return count;
+    }
+
+    inline void fail(const char* file, int line, const std::string& what) {
+        std::fprintf(stderr, "%s:%d: 断言失败: %s\n", file, line, what.c_str());
+        ++failures();
+    }
+
+    template <typename A, typename B>
+    void checkEqual(const A& actual, const B& expected, const char* text, const char* file, int line) {
+        if (actual == expected) return;
+        std::ostringstream out;
+        out << text << "（实际 " << actual << "，期望 " << expected << "）";
+        fail(file, line, out.str());
+    }
+
+    // 用例中未捕获的异常计为失败，后面的用例照常运行
+    inline void run(const char* name, const std::function<void()>& body) {
+        int before = failures();
+        try {
+            body();
+        } catch (const std::exception& ex) {
+            std::fprintf(stderr, "%s: 未捕获的异常: %s\n", name, ex.what());
+            ++failures();
+        }
+        std::printf("%s %s\n", failures() == before ? "[通过]" : "[失败]", name);
+    }
+
+    inline int finish() {
+        if (failures() > 0) std::printf("共 %d 处断言失败\n", failures());
+        return failures() == 0 ? 0 : 1;
+    }
+
+    // 测试夹具文件（tests/data 下）的完整路径
+    inline std::string fixture(const std::string& name) {
+        return std::string(LIBRARY_TEST_DATA) + "/" + name;
+    }
+
+    // 在系统临时目录下新建一个空目录并切换过去，析构时切回原目录并删除。
+    // Library 的数据文件都在当前目录下，每个用例各用一个目录
+    class ScratchDir {
+    public:
+        explicit ScratchDir(const std::string& name) : previous(std::filesystem::current_path()) {
+            auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+            path = std::filesystem::temp_directory_path() / ("library_test_" + name + "_" + std::to_string(stamp));
+            std::filesystem::create_directories(path);
+            std::filesystem::current_path(path);
+        }
+        ~ScratchDir() {
+            std::error_code error;
+            std::filesystem::current_path(previous, error);
+            std::filesystem::remove_all(path, error);
+        }
+        ScratchDir(const ScratchDir&) = delete;
+        ScratchDir& operator=(const ScratchDir&) = delete;
+
+    private:
+        std::filesystem::path previous;
+        std::filesystem::path path;
+    };
+}
\ No newline at end of file
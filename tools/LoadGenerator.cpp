@@ -0,0 +1,200 @@
+// 服务器模式的压测客户端（仅 Linux），由 CMake 目标 load_generator 构建（见 README.md），不依赖 Library 核心。
+// 用法：
+//   load_generator <地址> [--connections N] [--requests N] [--pipeline N] [--idle N] [--commands 文件]
+// 地址为 Unix 套接字路径或 tcp:<端口>。命令文件每行一条请求（与服务器协议相同），循环使用；
+// 未指定时发送 ping。--idle 额外打开 N 个只连接不发请求的空闲连接。
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <fstream>
+#include <netinet/in.h>
+#include <string>
+#include <string_view>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Pending {
+        Clock::time_point sent;
+        bool report;  // overdue / duesoon：首行 OK,<行数> 之后还有若干行
+    };
+
+    struct Connection {
+        int fd = -1;
+        std::string input;
+        std::string output;
+        std::deque<Pending> pending;
+        size_t reportLinesLeft = 0;
+    };
+
+    int connectTo(const std::string& endpoint) {
+        int fd;
+        if (endpoint.rfind("tcp:", 0) == 0) {
+            fd = ::socket(AF_INET, SOCK_STREAM, 0);
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_port = htons(static_cast<uint16_t>(std::atoi(endpoint.c_str() + 4)));
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) return -1;
+        } else {
+            fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            sockaddr_un address{};
+            address.sun_family = AF_UNIX;
+            std::strncpy(address.sun_path, endpoint.c_str(), sizeof(address.sun_path) - 1);
+            if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) return -1;
+        }
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+        return fd;
+    }
+
+    bool isReport(std::string_view command) {
+        return command.rfind("overdue", 0) == 0 || command.rfind("duesoon", 0) == 0 || command.rfind("search", 0) == 0;
+    }
+
+    double percentile(const std::vector<double>& sorted, double p) {
+        if (sorted.empty()) return 0.0;
+        size_t index = static_cast<size_t>(p / 100.0 * (sorted.size() - 1) + 0.5);
+        return sorted[std::min(index, sorted.size() - 1)];
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::fprintf(stderr, "用法: %s <地址> [--connections N] [--requests N] [--pipeline N] [--idle N] [--commands 文件]\n", argv[0]);
+        return 1;
+    }
+    std::string endpoint = argv[1];
+    size_t connectionCount = 16, requestCount = 100000, pipeline = 8, idleCount = 0;
+    std::vector<std::string> commands;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        if (option == "--connections") connectionCount = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (option == "--requests") requestCount = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (option == "--pipeline") pipeline = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (option == "--idle") idleCount = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (option == "--commands") {
+            std::ifstream file(argv[i + 1]);
+            std::string line;
+            while (std::getline(file, line)) {
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                if (!line.empty() && line.front() != '#') commands.push_back(line);
+            }
+        }
+    }
+    if (commands.empty()) commands.push_back("ping");
+    connectionCount = std::max<size_t>(connectionCount, 1);
+    pipeline = std::max<size_t>(pipeline, 1);
+
+    rlimit limit{};
+    if (::getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+        limit.rlim_cur = limit.rlim_max;
+        ::setrlimit(RLIMIT_NOFILE, &limit);
+    }
+    std::vector<int> idle;
+    for (size_t i = 0; i < idleCount; ++i) {
+        int fd = connectTo(endpoint);
+        if (fd < 0) {
+            std::fprintf(stderr, "空闲连接 %zu 建立失败: %s\n", i, std::strerror(errno));
+            return 1;
+        }
+        idle.push_back(fd);
+    }
+
+    int epollFd = ::epoll_create1(0);
+    std::vector<Connection> connections(connectionCount);
+    for (size_t i = 0; i < connectionCount; ++i) {
+        connections[i].fd = connectTo(endpoint);
+        if (connections[i].fd < 0) {
+            std::fprintf(stderr, "连接 %s 失败: %s\n", endpoint.c_str(), std::strerror(errno));
+            return 1;
+        }
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLOUT;
+        event.data.u64 = i;
+        ::epoll_ctl(epollFd, EPOLL_CTL_ADD, connections[i].fd, &event);
+    }
+
+    size_t sent = 0, completed = 0, errors = 0, nextCommand = 0;
+    std::vector<double> latencies;
+    latencies.reserve(requestCount);
+    auto start = Clock::now();
+    std::vector<epoll_event> events(connectionCount);
+    while (completed < requestCount) {
+        int count = ::epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), 1000);
+        if (count < 0 && errno != EINTR) break;
+        for (int e = 0; e < count; ++e) {
+            Connection& connection = connections[events[e].data.u64];
+            if (events[e].events & (EPOLLHUP | EPOLLERR)) {
+                std::fprintf(stderr, "连接被服务器关闭\n");
+                return 1;
+            }
+            // 读取响应：每个请求一行，报表请求额外带若干行
+            char buffer[64 * 1024];
+            ssize_t bytes;
+            while ((bytes = ::recv(connection.fd, buffer, sizeof(buffer), 0)) > 0) connection.input.append(buffer, bytes);
+            if (bytes == 0) {
+                std::fprintf(stderr, "连接被服务器关闭\n");
+                return 1;
+            }
+            size_t consumed = 0, end;
+            while ((end = connection.input.find('\n', consumed)) != std::string::npos) {
+                std::string_view line(connection.input.data() + consumed, end - consumed);
+                consumed = end + 1;
+                if (connection.reportLinesLeft > 0) {
+                    if (--connection.reportLinesLeft > 0) continue;
+                } else {
+                    if (connection.pending.empty()) continue;
+                    if (line.rfind("ERR", 0) == 0) ++errors;
+                    else if (connection.pending.front().report) {
+                        connection.reportLinesLeft = std::strtoul(std::string(line.substr(3)).c_str(), nullptr, 10);
+                        if (connection.reportLinesLeft > 0) continue;
+                    }
+                }
+                auto elapsed = std::chrono::duration<double, std::micro>(Clock::now() - connection.pending.front().sent);
+                latencies.push_back(elapsed.count());
+                connection.pending.pop_front();
+                ++completed;
+            }
+            connection.input.erase(0, consumed);
+            // 补足流水线深度
+            while (connection.pending.size() < pipeline && sent < requestCount) {
+                const std::string& command = commands[nextCommand++ % commands.size()];
+                connection.output.append(command).push_back('\n');
+                connection.pending.push_back({ Clock::now(), isReport(command) });
+                ++sent;
+            }
+            while (!connection.output.empty()) {
+                bytes = ::send(connection.fd, connection.output.data(), connection.output.size(), MSG_NOSIGNAL);
+                if (bytes <= 0) break;
+                connection.output.erase(0, static_cast<size_t>(bytes));
+            }
+            epoll_event event{};
+            event.events = EPOLLIN | (connection.output.empty() ? 0u : static_cast<uint32_t>(EPOLLOUT));
+            event.data.u64 = events[e].data.u64;
+            ::epoll_ctl(epollFd, EPOLL_CTL_MOD, connection.fd, &event);
+        }
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::sort(latencies.begin(), latencies.end());
+    std::printf("连接 %zu (空闲 %zu)，流水线 %zu，请求 %zu，错误响应 %zu\n", connectionCount, idle.size(), pipeline, completed, errors);
+    std::printf("耗时 %.3f 秒，%.0f 请求/秒\n", seconds, completed / seconds);
+    std::printf("延迟(微秒) p50 %.1f  p90 %.1f  p99 %.1f  p99.9 %.1f  max %.1f\n", percentile(latencies, 50),
+        percentile(latencies, 90), percentile(latencies, 99), percentile(latencies, 99.9), latencies.empty() ? 0.0 : latencies.back());
+    for (auto& connection : connections) ::close(connection.fd);
+    for (int fd : idle) ::close(fd);
+    ::close(epollFd);
+    return 0;
+}
\ No newline at end of file
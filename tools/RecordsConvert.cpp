@@ -0,0 +1,157 @@
+// records.txt 与列式借阅历史文件（LoanArchive）之间的转换与扫描对比工具，由 CMake 目标 records_convert 构建（见 README.md）。
+// 用法：
+//   records_convert convert <records.txt> <records.lar>     转换并输出行数、两种文件大小和耗时
+//   records_convert scan <records.txt> <records.lar> [--days N]
+//       分别全量扫描两种文件，并按借阅时间读取最近 N 天（默认 30）的记录，输出耗时与条数
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include "LoanArchive.h"
+#include "MappedFile.h"
+#include "TextParsing.h"
+
+namespace {
+    using SteadyClock = std::chrono::steady_clock;
+
+    double millisecondsSince(SteadyClock::time_point start) {
+        return std::chrono::duration<double, std::milli>(SteadyClock::now() - start).count();
+    }
+
+    struct TextRecord {
+        std::string_view book;
+        std::string_view reader;
+        std::time_t borrowDate;
+        std::time_t dueDate;
+        std::time_t returnDate;
+        bool returned;
+        uint32_t copy;
+    };
+
+    // 逐行解析 records.txt，格式不对的行跳过，与 Library::importText 一致
+    template <typename Visit>
+    size_t forEachTextRecord(const MappedFile& file, Visit visit) {
+        size_t count = 0;
+        std::string_view text = file.view();
+        while (!text.empty()) {
+            std::string_view line = textparse::nextLine(text);
+            TextRecord record{};
+            record.book = textparse::nextField(line);
+            record.reader = textparse::nextField(line);
+            if (!textparse::parseNumber(textparse::nextField(line), record.borrowDate)
+                || !textparse::parseNumber(textparse::nextField(line), record.dueDate)
+                || !textparse::parseNumber(textparse::nextField(line), record.returnDate)) {
+                continue;
+            }
+            record.returned = textparse::nextField(line) == "1";
+            // 副本编号列是后加的，缺少时按第 0 册
+            if (!textparse::parseNumber(line, record.copy)) record.copy = 0;
+            visit(record);
+            ++count;
+        }
+        return count;
+    }
+
+    int convert(const std::string& textPath, const std::string& archivePath) {
+        MappedFile file(textPath);
+        if (!file.isOpen()) {
+            std::cerr << "无法打开 " << textPath << "\n";
+            return 1;
+        }
+        auto start = SteadyClock::now();
+        LoanArchiveWriter writer;
+        forEachTextRecord(file, [&](const TextRecord& record) {
+            writer.add(writer.addName(record.book), writer.addName(record.reader), record.borrowDate, record.dueDate,
+                record.returnDate, record.returned, record.copy);
+        });
+        writer.write(archivePath);
+        double elapsed = millisecondsSince(start);
+
+        LoanArchiveReader archive(archivePath);
+        std::printf("记录数      %zu\n", writer.size());
+        std::printf("文本大小    %zu 字节 (%.1f 字节/条)\n", file.size(),
+            writer.size() ? double(file.size()) / writer.size() : 0.0);
+        std::printf("归档大小    %zu 字节 (%.1f 字节/条, 名称 %zu 个, %zu 块)\n", archive.fileSize(),
+            writer.size() ? double(archive.fileSize()) / writer.size() : 0.0, archive.names().size(), archive.blocks().size());
+        std::printf("压缩比      %.1fx\n", archive.fileSize() ? double(file.size()) / archive.fileSize() : 0.0);
+        std::printf("转换耗时    %.1f ms\n", elapsed);
+        return 0;
+    }
+
+    int scan(const std::string& textPath, const std::string& archivePath, int days) {
+        MappedFile file(textPath);
+        LoanArchiveReader archive(archivePath);
+        if (!file.isOpen() || !archive.isOpen()) {
+            std::cerr << "无法打开 " << (file.isOpen() ? archivePath : textPath) << "\n";
+            return 1;
+        }
+        int64_t latest = 0;
+        for (const loanarchive::BlockInfo& block : archive.blocks()) latest = std::max(latest, block.maxBorrow);
+        int64_t from = latest - int64_t(days) * 24 * 60 * 60;
+        int64_t to = latest + 1;
+
+        // 每种扫描都统计逾期归还的条数，避免扫描被优化掉，也用来核对两种格式的结果一致
+        auto start = SteadyClock::now();
+        size_t textLate = 0;
+        size_t textRows = forEachTextRecord(file, [&](const TextRecord& record) {
+            textLate += record.returned && record.returnDate > record.dueDate;
+        });
+        double textFull = millisecondsSince(start);
+
+        start = SteadyClock::now();
+        size_t textRangeLate = 0;
+        size_t textRange = 0;
+        forEachTextRecord(file, [&](const TextRecord& record) {
+            if (record.borrowDate < from || record.borrowDate >= to) return;
+            ++textRange;
+            textRangeLate += record.returned && record.returnDate > record.dueDate;
+        });
+        double textRangeTime = millisecondsSince(start);
+
+        start = SteadyClock::now();
+        size_t archiveLate = 0;
+        size_t archiveRows = archive.forEach([&](const LoanRow& row) {
+            archiveLate += row.returned && row.returnDate > row.dueDate;
+        });
+        double archiveFull = millisecondsSince(start);
+
+        start = SteadyClock::now();
+        size_t archiveRangeLate = 0;
+        size_t archiveRange = archive.forEachBorrowedBetween(from, to, [&](const LoanRow& row) {
+            archiveRangeLate += row.returned && row.returnDate > row.dueDate;
+        });
+        double archiveRangeTime = millisecondsSince(start);
+
+        std::printf("%-10s %14s %12s %12s %14s %12s\n", "格式", "大小(字节)", "全量(ms)", "全量条数", "近期(ms)", "近期条数");
+        std::printf("%-10s %14zu %12.1f %12zu %14.1f %12zu\n", "text", file.size(), textFull, textRows, textRangeTime, textRange);
+        std::printf("%-10s %14zu %12.1f %12zu %14.1f %12zu\n", "archive", archive.fileSize(), archiveFull, archiveRows,
+            archiveRangeTime, archiveRange);
+        if (textRows != archiveRows || textLate != archiveLate || textRange != archiveRange || textRangeLate != archiveRangeLate) {
+            std::cerr << "两种格式的扫描结果不一致\n";
+            return 1;
+        }
+        return 0;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "";
+    try {
+        if (mode == "convert" && argc == 4) return convert(argv[2], argv[3]);
+        if (mode == "scan" && (argc == 4 || argc == 6)) {
+            int days = 30;
+            if (argc == 6 && std::string(argv[4]) == "--days") days = std::atoi(argv[5]);
+            return scan(argv[2], argv[3], days);
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << "\n";
+        return 1;
+    }
+    std::cerr << "用法: records_convert convert <records.txt> <records.lar>\n"
+              << "      records_convert scan <records.txt> <records.lar> [--days N]\n";
+    return 2;
+}
\ No newline at end of file